@@ -27,33 +27,34 @@
 #include "./block.h"
 
 #include <QDebug>
+#include <QPixmapCache>
+
+#include "./lattice.h"
+#include "./telemetry.h"
 
 Block::Block(const quint16 nID, QPolygonF shape, QBrush bgcolor, QPen border,
-             quint16 nGrid, QList<Block *> *pListBlocks,
-             Settings *pSettings, QPointF posTopLeft, const bool bBarrier)
+             quint16 nGrid, QList<Block *> *pListBlocks, CellMap *pCellMap,
+             Settings *pSettings, QPointF posTopLeft)
   : m_nID(nID),
     m_PolyShape(shape),
     m_bgBrush(bgcolor),
     m_borderPen(border),
     m_nGrid(nGrid),
     m_pListBlocks(pListBlocks),
+    m_pCellMap(pCellMap),
     m_pSettings(pSettings),
     m_bActive(false) {
   if (!m_PolyShape.isClosed()) {
     qWarning() << "Shape" << m_nID << "is not closed";
   }
 
-  if (!bBarrier) {
-    // qDebug() << "Creating BLOCK" << m_nID <<
-    //             "\tPosition:" << posTopLeft * m_nGrid;
-    this->setFlag(ItemIsMovable);
+  // qDebug() << "Creating BLOCK" << m_nID <<
+  //             "\tPosition:" << posTopLeft * m_nGrid;
+  this->setFlag(ItemIsMovable);
+  // Decode texture only once for all blocks and boards
+  if (!QPixmapCache::find("collision_texture", &m_CollTexture)) {
     m_CollTexture.load(":/images/collision_texture.png");
-  } else {
-    // qDebug() << "Creating BARRIER" << m_nID <<
-    //             "\tPosition:" << posTopLeft * m_nGrid;
-    this->setAcceptedMouseButtons(0);
-    this->setAcceptTouchEvents(false);
-    this->setEnabled(false);
+    QPixmapCache::insert("collision_texture", m_CollTexture);
   }
 
   m_pTransform = new QTransform();
@@ -62,6 +63,7 @@ Block::Block(const quint16 nID, QPolygonF shape, QBrush bgcolor, QPen border,
   this->setScale(m_nGrid);
   // Move to start position
   this->moveBlockGrid(posTopLeft);
+  this->updateCells(true);
 }
 
 // ---------------------------------------------------------------------------
@@ -88,7 +90,7 @@ void Block::paint(QPainter *painter,
 
   m_borderPen.setWidth(1/m_nGrid);
 
-  if (m_bActive) {  // Barries are ignored (not enabled)
+  if (m_bActive) {
     painter->setOpacity(0.4);
   } else {
     painter->setOpacity(1);
@@ -115,26 +117,27 @@ void Block::paint(QPainter *painter,
 void Block::mousePressEvent(QGraphicsSceneMouseEvent *p_Event) {
   this->resetBrushStyle();
 
-  qint8 nIndex(m_pSettings->getMouseControls().indexOf(p_Event->button()));
-  if (nIndex >= 0) {
-    switch (nIndex) {
-      case 0:
+  qint8 nControl(m_pSettings->getMouseControl(quint8(p_Event->button())));
+  if (nControl >= 0) {
+    switch (nControl) {
+      case Settings::ControlMove:
         m_posMouseSelected = p_Event->pos();
         m_posMouseSelected = QPointF(m_posMouseSelected.x() * m_nGrid,
                                      m_posMouseSelected.y() * m_nGrid);
+        m_posDrag = this->pos();
         this->moveBlock();
         update();
         break;
-      case 1:
+      case Settings::ControlRotate:
         this->rotateBlock();
         update();
         break;
-      case 2:
+      case Settings::ControlFlip:
         this->flipBlock();
         update();
         break;
       default:
-        qWarning() << "Unexpected mouse press control:" << nIndex;
+        qWarning() << "Unexpected mouse press control:" << nControl;
     }
   }
 
@@ -145,17 +148,30 @@ void Block::mousePressEvent(QGraphicsSceneMouseEvent *p_Event) {
 // ---------------------------------------------------------------------------
 
 void Block::mouseMoveEvent(QGraphicsSceneMouseEvent *p_Event) {
-  if (0 == m_pSettings->getMouseControls().indexOf(p_Event->buttons())) {
-    this->setPos(p_Event->scenePos() - m_posMouseSelected);
+  if (Settings::ControlMove ==
+      m_pSettings->getMouseControl(quint8(p_Event->buttons()))) {
+    // The board applies the latest position once per display frame
+    m_posDrag = p_Event->scenePos() - m_posMouseSelected;
+    emit dragged(this);
+  }
+}
+
+bool Block::applyDragPosition() {
+  if (m_bActive && this->pos() != m_posDrag) {
+    this->setPos(m_posDrag);
     update();
+    return true;
   }
+  return false;
 }
 
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
 void Block::mouseReleaseEvent(QGraphicsSceneMouseEvent *p_Event) {
-  if (0 == m_pSettings->getMouseControls().indexOf(p_Event->button())) {
+  if (Settings::ControlMove ==
+      m_pSettings->getMouseControl(quint8(p_Event->button()))) {
+    this->applyDragPosition();  // Pending position of the last frame
     this->moveBlock(true);
     update();
   }
@@ -169,22 +185,64 @@ void Block::mouseReleaseEvent(QGraphicsSceneMouseEvent *p_Event) {
 void Block::wheelEvent(QGraphicsSceneWheelEvent *p_Event) {
   this->resetBrushStyle();
 
-  qint8 nIndex(m_pSettings->getMouseControls().indexOf(
-                 (quint8(p_Event->orientation()) | m_pSettings->getShift())));
-  if (nIndex >= 0) {
-    switch (nIndex) {
-      case 1:
+  qint8 nControl(m_pSettings->getMouseControl(
+                   quint8(p_Event->orientation()) | m_pSettings->getShift()));
+  if (nControl >= 0) {
+    switch (nControl) {
+      case Settings::ControlRotate:
         this->rotateBlock(p_Event->delta());
         update();
         break;
-      case 2:
+      case Settings::ControlFlip:
         this->flipBlock();
         update();
         break;
       default:
-        qWarning() << "Unexpected mouse wheel control:" << nIndex;
+        qWarning() << "Unexpected mouse wheel control:" << nControl;
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void Block::keyControl(const qint8 nControl) {
+  this->resetBrushStyle();
+
+  switch (nControl) {
+    case Settings::ControlMove:  // Select block
+      this->moveBlock();
+      break;
+    case Settings::ControlRotate:
+      this->rotateBlock();
+      break;
+    case Settings::ControlFlip:
+      this->flipBlock();
+      break;
+    case Settings::ControlLeft:
+    case Settings::ControlRight:
+    case Settings::ControlUp:
+    case Settings::ControlDown: {
+      if (!m_bActive) {
+        this->moveBlock();
+      }
+      QPoint delta(0, 0);
+      if (Settings::ControlLeft == nControl) delta.setX(-1);
+      if (Settings::ControlRight == nControl) delta.setX(1);
+      if (Settings::ControlUp == nControl) delta.setY(-1);
+      if (Settings::ControlDown == nControl) delta.setY(1);
+      this->moveBlockCell(Lattice::arrowStep(delta));
+      break;
     }
+    case Settings::ControlDrop:
+      if (m_bActive) {
+        this->moveBlock(true);
+      }
+      break;
+    default:
+      qWarning() << "Unexpected key control:" << nControl;
   }
+  update();
 }
 
 // ---------------------------------------------------------------------------
@@ -194,11 +252,7 @@ void Block::moveBlock(const bool bRelease) {
   if (!bRelease) {
     m_bActive = true;
 
-    // Bring current block to foreground and update Z values
-    for (int i = 0; i < m_pListBlocks->size(); i++) {
-      (*m_pListBlocks)[i]->setNewZValue(-1);
-    }
-    this->setZValue(m_pListBlocks->size() + 2);
+    this->bringToFront();
 
     m_posBlockSelected = this->pos();  // Save last position
   } else {
@@ -206,17 +260,17 @@ void Block::moveBlock(const bool bRelease) {
 
     this->prepareGeometryChange();
     this->setPos(this->snapToGrid(this->pos()));
-
-    QPainterPath thisPath = this->shape();
-    thisPath.translate(QPointF(this->pos().x() / m_nGrid,
-                               this->pos().y() / m_nGrid));
+    this->updateCells();
 
     emit incrementMoves();
-    if (this->checkCollision(thisPath)) {
+    if (this->checkCollision()) {
+      emit recordEvent(Telemetry::EventRejected, m_nID, m_cellPos);
       // Reset position
       this->setPos(this->snapToGrid(m_posBlockSelected));
+      this->updateCells();
       this->checkBlockIntersection();
     } else {
+      emit recordEvent(Telemetry::EventMove, m_nID, m_cellPos);
       // Check if puzzle is solved
       emit checkPuzzleSolved();
     }
@@ -227,28 +281,19 @@ void Block::moveBlock(const bool bRelease) {
 // ---------------------------------------------------------------------------
 
 void Block::rotateBlock(const int nDelta) {
-  qint8 nAngle(0);
-  qint32 nTranslateX(0);
-  qint32 nTranslateY(0);
-
-  if (nDelta < 0) {
-    nAngle = 90;
-    nTranslateX = this->boundingRect().height();
-    nTranslateY = 0;
-  } else {
-    nAngle = -90;
-    nTranslateX = 0;
-    nTranslateY = this->boundingRect().width();
-  }
+  const qreal dAngle(360.0 / Lattice::ROTATIONS);
+
   this->prepareGeometryChange();
-  // qDebug() << "Before rot.:" << m_nID << nAngle << "\n" << m_PolyShape;
+  // qDebug() << "Before rot.:" << m_nID << dAngle << "\n" << m_PolyShape;
   m_pTransform->reset();
-  m_pTransform->rotate(nAngle);
+  m_pTransform->rotate(nDelta < 0 ? dAngle : -dAngle);
   m_PolyShape = m_pTransform->map(m_PolyShape);  // Rotate
-  m_PolyShape.translate(nTranslateX, nTranslateY);  // Move back
+  this->alignShape();  // Move back
   // qDebug() << "After rot.:" << m_PolyShape;
 
+  this->updateCells(true);
   this->checkBlockIntersection();
+  emit recordEvent(Telemetry::EventRotate, m_nID, m_cellPos);
 }
 
 // ---------------------------------------------------------------------------
@@ -259,27 +304,36 @@ void Block::flipBlock() {
   // qDebug() << "Before flip" << m_nID << "-" << m_PolyShape;
   QTransform transform = QTransform::fromScale(-1, 1);
   m_PolyShape = transform.map(m_PolyShape);  // Flip
-  m_PolyShape.translate(this->boundingRect().width(), 0);  // Move back
+  this->alignShape();  // Move back
   // qDebug() << "After flip:" << m_PolyShape;
 
+  this->updateCells(true);
   this->checkBlockIntersection();
+  emit recordEvent(Telemetry::EventFlip, m_nID, m_cellPos);
 }
 
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
-void Block::checkBlockIntersection() {
-  QPainterPath thisPath = this->shape();
-  thisPath.translate(QPointF(this->pos().x() / m_nGrid,
-                             this->pos().y() / m_nGrid));
+void Block::alignShape() {
+  // Move top left back to origin by a lattice translation, snapping all
+  // points removes rounding errors of non right angles
+  const QPointF offset(Lattice::toPlane(
+                         Lattice::snap(m_PolyShape.boundingRect().topLeft())));
+  for (int i = 0; i < m_PolyShape.size(); i++) {
+    const QPointF p(Lattice::fromPlane(m_PolyShape[i] - offset));
+    m_PolyShape[i] = Lattice::toPlane(QPointF(qRound(p.x()), qRound(p.y())));
+  }
+}
 
-  if (this->checkCollision(thisPath)) {
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void Block::checkBlockIntersection() {
+  if (this->checkCollision()) {
     m_bgBrush.setTexture(m_CollTexture);
     m_bgBrush.setStyle(Qt::TexturePattern);
-    for (int i = 0; i < m_pListBlocks->size(); i++) {
-      (*m_pListBlocks)[i]->setNewZValue(-1);
-    }
-    this->setZValue(m_pListBlocks->size() + 2);
+    this->bringToFront();
   }
 }
 
@@ -299,53 +353,65 @@ void Block::setBrushStyle(Qt::BrushStyle style) {
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
-bool Block::checkCollision(const QPainterPath &thisPath) {
-  QPainterPath collidingPath;
-  QPainterPath intersectedPath;
-  foreach (Block *block, *m_pListBlocks) {
-    if (block->getIndex() != m_nID
-        && this->collidesWithItem(block)) {
-      collidingPath = block->shape();
-      collidingPath.translate(QPointF(block->pos().x() / m_nGrid,
-                                      block->pos().y() / m_nGrid));
-      intersectedPath = thisPath.intersected(collidingPath);
-
-      // Path has to be simplified
-      // Otherwise paths with area = 0 might be found
-      intersectedPath = intersectedPath.simplified();
-
-      if (!intersectedPath.boundingRect().size().isEmpty()) {
-        /*
-        qDebug() << "SHAPE 1:" << thisPath << "SHAPE 2:" << collidingPath;
-        qDebug() << "Col" << m_nID << "with" << block->getIndex()
-                 << "Size" << intersectedPath.boundingRect().size();
-        qDebug() << "Intersection:" << intersectedPath;
-        */
-        return true;
-      }
-    }
+bool Block::checkCollision() const {
+  return !m_pCellMap->isFree(m_listCells, m_cellPos, m_nID);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void Block::updateCells(const bool bShapeChanged) {
+  m_pCellMap->removeCells(m_listCells, m_cellPos, m_nID);
+  if (bShapeChanged) {
+    m_listCells = Lattice::cells(m_PolyShape);
   }
-  return false;
+  m_cellPos = Lattice::keyOffset(Lattice::snap(this->pos() / m_nGrid));
+  m_pCellMap->addCells(m_listCells, m_cellPos, m_nID);
 }
 
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
 QPointF Block::snapToGrid(const QPointF point) const {
-  return QPointF(qRound(point.x() / m_nGrid) * m_nGrid,   // x
-                 qRound(point.y() / m_nGrid) * m_nGrid);  // y
+  return Lattice::toPlane(Lattice::snap(point / m_nGrid)) * m_nGrid;
 }
 
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
 void Block::moveBlockGrid(const QPointF pos) {
-  this->setPos(pos * m_nGrid);
+  this->setPos(Lattice::toPlane(pos) * m_nGrid);
+}
+
+void Block::moveTo(const QPointF &pos) {
+  this->prepareGeometryChange();
+  this->moveBlockGrid(pos);
+  this->updateCells();
+  this->setBrushStyle(Qt::SolidPattern);
+  this->checkBlockIntersection();
+}
+
+bool Block::moveBlockCell(const QPoint delta) {
+  // Only the cells of this block are looked up -> constant time
+  if (!m_pCellMap->isFree(m_listCells, m_cellPos + Lattice::keyOffset(delta),
+                          m_nID)) {
+    return false;
+  }
+  this->setPos(this->pos() + Lattice::toPlane(delta) * m_nGrid);
+  this->updateCells();
+  return true;
 }
 
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
+void Block::bringToFront() {
+  // Increasing Z value instead of lowering all other blocks
+  static qreal dTopZ(1);
+  dTopZ++;
+  this->setZValue(dTopZ);
+}
+
 void Block::setNewZValue(const qint16 nZ) {
   if (nZ < 0) {
     if (this->zValue() > 1) {
@@ -392,3 +458,11 @@ QPointF Block::getPosition() const {
 QPolygonF Block::getPolygon() const {
   return this->m_PolyShape;
 }
+
+QList<QPoint> Block::getCells() const {
+  QList<QPoint> listCells;
+  foreach (const QPoint &cell, m_listCells) {
+    listCells << cell + m_cellPos;
+  }
+  return listCells;
+}
@@ -32,6 +32,7 @@
 #include <QGraphicsSceneWheelEvent>
 #include <QPainter>
 
+#include "./cellmap.h"
 #include "./settings.h"
 
 /**
@@ -43,8 +44,8 @@ class Block : public QGraphicsObject {
 
  public:
     Block(const quint16 nID, QPolygonF shape, QBrush bgcolor, QPen border,
-          quint16 nGrid, QList<Block *> *pListBlocks, Settings *pSettings,
-          QPointF posTopLeft = QPoint(0, 0), const bool bBarrier = false);
+          quint16 nGrid, QList<Block *> *pListBlocks, CellMap *pCellMap,
+          Settings *pSettings, QPointF posTopLeft = QPoint(0, 0));
 
     QRectF boundingRect() const;
     QPainterPath shape() const;
@@ -54,14 +55,20 @@ class Block : public QGraphicsObject {
     void setBrushStyle(Qt::BrushStyle style);
 
     QPolygonF getPolygon() const;
+    QList<QPoint> getCells() const;
     void setNewZValue(const qint16 nZ);
     void rescaleBlock(const quint16 nNewScale);
+    void moveTo(const QPointF &pos);  // Lattice position
     quint16 getIndex() const;
+    void keyControl(const qint8 nControl);
+    bool applyDragPosition();
     enum { Type = UserType + 1 };
 
  signals:
     void incrementMoves();
     void checkPuzzleSolved();
+    void recordEvent(const int nEvent, const quint16 nID, const QPoint &cell);
+    void dragged(Block *pBlock);  // New drag position, see Board
 
  protected:
     void mousePressEvent(QGraphicsSceneMouseEvent *p_Event);
@@ -72,10 +79,14 @@ class Block : public QGraphicsObject {
 
  private:
     void moveBlockGrid(const QPointF pos);
-    bool checkCollision(const QPainterPath &thisPath);
+    bool moveBlockCell(const QPoint delta);  // Lattice translation
+    void updateCells(const bool bShapeChanged = false);
+    bool checkCollision() const;
     void checkBlockIntersection();
     QPointF snapToGrid(const QPointF point) const;
     void resetBrushStyle() const;
+    void bringToFront();
+    void alignShape();
 
     void moveBlock(const bool bRelease = false);
     void rotateBlock(const int nDelta = -1);
@@ -87,6 +98,9 @@ class Block : public QGraphicsObject {
     QPen m_borderPen;
     quint16 m_nGrid;
     QList<Block *> *m_pListBlocks;
+    CellMap *m_pCellMap;
+    QList<QPoint> m_listCells;  // Relative to block position
+    QPoint m_cellPos;  // Position registered in cell map
     Settings *m_pSettings;
     bool m_bActive;
     QPixmap m_CollTexture;
@@ -94,6 +108,7 @@ class Block : public QGraphicsObject {
     QTransform *m_pTransform;
     QPointF m_posBlockSelected;
     QPointF m_posMouseSelected;
+    QPointF m_posDrag;  // Latest pointer position, applied once per frame
     QGraphicsSimpleTextItem m_ItemNumberText;
 };
 
@@ -30,27 +30,52 @@
 #include <QCoreApplication>
 #include <QDebug>
 #include <QFile>
+#include <QGraphicsSceneMouseEvent>
+#include <QGuiApplication>
 #include <QMessageBox>
-
-Board::Board(QGraphicsView *pGraphView, const QString &sBoardFile,
-             Settings *pSettings, const quint16 nGridSize,
-             const QString &sSavedGame)
+#include <QPainter>
+#include <QScreen>
+#include <QScrollBar>
+#include <QSet>
+#include <QSettings>
+#include <qmath.h>
+
+#include "./lattice.h"
+#include "./piecelayout.h"
+
+Board::Board(QGraphicsView *pGraphView, const BoardDescriptor &descriptor,
+             Settings *pSettings, const quint16 nGridSize)
   : m_pGraphView(pGraphView),
-    m_sBoardFile(sBoardFile),
+    m_Descriptor(descriptor),
+    m_sBoardFile(descriptor.sBoardFile),
     m_pSettings(pSettings),
-    m_bSavedGame(false),
-    m_nGridSize(nGridSize) {
+    m_bSavedGame(!descriptor.sSavedGame.isEmpty()),
+    m_nNumOfBlocks(0),
+    m_nSelectedBlock(-1),
+    m_nGridSize(nGridSize),
+    m_bNotAllPiecesNeeded(descriptor.bNotAllPiecesNeeded),
+    m_bFreestyle(descriptor.bFreestyle),
+    m_pHintTimer(new QTimer(this)),
+    m_pFrameTimer(new QTimer(this)) {
   this->setBackgroundBrush(QBrush(QColor(238, 238, 238)));
-
-  m_pBoardConf = new QSettings(m_sBoardFile, QSettings::IniFormat);
-  if (!sSavedGame.isEmpty()) {
-    m_bSavedGame = true;
+  m_pHintTimer->setSingleShot(true);
+  connect(m_pHintTimer, SIGNAL(timeout()), this, SLOT(clearHint()));
+
+  // Drag moves of all blocks are coalesced to one update per display frame.
+  // The timer only matches the refresh rate of the primary screen (60 Hz if
+  // unknown), it isn't synchronized to the vblank of the display.
+  qreal dRefreshRate(60);
+  if (NULL != QGuiApplication::primaryScreen() &&
+      QGuiApplication::primaryScreen()->refreshRate() > 0) {
+    dRefreshRate = QGuiApplication::primaryScreen()->refreshRate();
   }
-  m_pSavedConf = new QSettings(sSavedGame, QSettings::IniFormat);
+  m_pFrameTimer->setSingleShot(true);
+  m_pFrameTimer->setInterval(qMax(1, qRound(1000 / dRefreshRate)));
+  connect(m_pFrameTimer, SIGNAL(timeout()), this, SLOT(applyDrags()));
 
   this->setBackgroundBrush(QBrush(this->readColor("BGColor")));
   if (0 == m_nGridSize) {
-    m_nGridSize = m_pBoardConf->value("GridSize", 0).toUInt();
+    m_nGridSize = m_Descriptor.nGridSize;
   }
   if (0 == m_nGridSize || m_nGridSize > 255) {
     qWarning() << "INVALID GRID SIZE:" << m_nGridSize;
@@ -65,28 +90,53 @@ Board::Board(QGraphicsView *pGraphView, const QString &sBoardFile,
 
 bool Board::setupBoard() {
   qDebug() << Q_FUNC_INFO;
-  m_bFreestyle = m_pBoardConf->value("Freestyle", false).toBool();
+  m_bFreestyle = m_Descriptor.bFreestyle;
+
+  if (m_Descriptor.sLattice != Lattice::name()) {
+    qWarning() << "Lattice not supported by this build:" <<
+                  m_Descriptor.sLattice;
+    // The grid is fixed at compile time (see iqpuzzle.pro)
+    const QString sConfig("square" == m_Descriptor.sLattice ?
+                            QString("qmake") :
+                            "qmake CONFIG+=lattice_" + m_Descriptor.sLattice);
+    QMessageBox::warning(0, tr("Warning"),
+                         tr("Board grid not supported by this build:") +
+                         " " + m_Descriptor.sLattice + "\n" +
+                         tr("Build with \"%1\" to play this board.")
+                         .arg(sConfig));
+    return false;
+  }
 
-  m_BoardPoly.clear();
-  m_BoardPoly = this->readPolygon(m_pBoardConf, "Board/Polygon", true);
+  m_BoardPoly = QTransform::fromScale(m_nGridSize, m_nGridSize).map(
+                  QPolygonF(planePolygon(m_Descriptor.boardPoly)));
   if (m_BoardPoly.isEmpty()) {
     qWarning() << "BOARD POLYGON IS EMPTY!";
     QMessageBox::warning(0, tr("Warning"), tr("Board polygon not valid."));
     return false;
   }
 
+  // Freestyle zooms the view, a following board starts unscaled
+  m_pGraphView->resetTransform();
   if (!m_bFreestyle) {
     this->drawBoard();
     this->drawGrid();
     m_pGraphView->setDragMode(QGraphicsView::NoDrag);
     m_pGraphView->setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
     m_pGraphView->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    m_pGraphView->setCacheMode(QGraphicsView::CacheNone);
   } else {
     m_pGraphView->setDragMode(QGraphicsView::ScrollHandDrag);
     m_pGraphView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     m_pGraphView->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    m_pGraphView->setSceneRect(QRect(-1000, -1000, 3000, 3000));
+    m_pGraphView->setCacheMode(QGraphicsView::CacheBackground);
+    m_pGraphView->setSceneRect(m_BoardPoly.boundingRect().adjusted(
+                                 -1000, -1000, 1000, 1000));
+    connect(m_pGraphView->horizontalScrollBar(), SIGNAL(valueChanged(int)),
+            this, SLOT(extendCanvas()), Qt::UniqueConnection);
+    connect(m_pGraphView->verticalScrollBar(), SIGNAL(valueChanged(int)),
+            this, SLOT(extendCanvas()), Qt::UniqueConnection);
   }
+  this->drawBarriers();
 
   // Set main window size
   const QSize WinSize(m_BoardPoly.boundingRect().width() * 2.5,
@@ -112,6 +162,14 @@ void Board::drawGrid() {
   QLineF lineGrid;
   QPen pen(this->readColor("Board/GridColor"));
 
+  if (!Lattice::IS_SQUARE) {  // Outline of each cell
+    const QTransform scale(QTransform::fromScale(m_nGridSize, m_nGridSize));
+    foreach (const QPoint &cell, latticeCells(m_Descriptor.boardPoly)) {
+      this->addPolygon(scale.map(QPolygonF(Lattice::cellPolygon(cell))), pen);
+    }
+    return;
+  }
+
   // Horizontal
   for (int i = 1; i < m_BoardPoly.boundingRect().height()/m_nGridSize; i++) {
     lineGrid.setLine(1, i*m_nGridSize,
@@ -129,10 +187,36 @@ void Board::drawGrid() {
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
+void Board::drawBarriers() {
+  // Barriers are no blocks, only static polygons on top of the board
+  const QTransform scale(QTransform::fromScale(m_nGridSize, m_nGridSize));
+  for (int i = 0; i < m_Descriptor.listBarriers.size(); i++) {
+    const QString sPrefix("Barrier" + QString::number(i + 1));
+    const BoardDescriptor::Piece &barrier = m_Descriptor.listBarriers.at(i);
+    QPolygonF poly(planePolygon(barrier.polygon));
+    poly.translate(Lattice::toPlane(barrier.startPos));
+    this->addPolygon(scale.map(poly),
+                     QPen(this->readColor(sPrefix + "/BorderColor")),
+                     QBrush(this->readColor(sPrefix + "/Color")));
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
 bool Board::setupBlocks() {
   qDebug() << Q_FUNC_INFO;
   m_nNumOfBlocks = 0;
+  m_nSelectedBlock = -1;
   m_listBlocks.clear();
+  m_listDragged.clear();
+  m_CellMap.clear();
+
+  foreach (const QString &sKey, m_Descriptor.sListInvalidStartPos) {
+    QMessageBox::warning(0, tr("Warning"),
+                         tr("Invalid start position - using fallback:") +
+                         "\n" + sKey);
+  }
 
   if (this->createBlocks() &&
       this->createBarriers()) {
@@ -141,8 +225,7 @@ bool Board::setupBlocks() {
       this->addItem(pB);
     }
 
-    m_bNotAllPiecesNeeded = m_pBoardConf->value("NotAllPiecesNeeded",
-                                                false).toBool();
+    m_bNotAllPiecesNeeded = m_Descriptor.bNotAllPiecesNeeded;
     if (m_bNotAllPiecesNeeded) {
       QMessageBox::information(
             0, tr("Hint"), tr("Not all pieces are needed for a solution!"));
@@ -157,40 +240,39 @@ bool Board::setupBlocks() {
 // ---------------------------------------------------------------------------
 
 bool Board::createBlocks() {
-  const unsigned char nMaxNumOfBlocks(250);
-  QSettings *tmpSet = m_pBoardConf;
-  if (m_bSavedGame) {
-    tmpSet = m_pSavedConf;
+  if (m_Descriptor.sInvalidPolygon.startsWith("Block")) {
+    this->clear();  // Clear all objects
+    m_listDragged.clear();
+    QMessageBox::warning(0, tr("Warning"),
+                         tr("Polygon not valid:") + "\n" +
+                         m_Descriptor.sInvalidPolygon);
+    return false;
   }
 
-  for (unsigned int i = 1; i <= nMaxNumOfBlocks; i++) {
-    QString sPrefix = "Block" + QString::number(i);
-    if (!tmpSet->contains(sPrefix + "/Polygon")) {
-      break;
-    }
+  foreach (const BoardDescriptor::Piece &piece, m_Descriptor.listBlocks) {
     m_nNumOfBlocks++;
-
-    QPolygonF polygon = this->readPolygon(tmpSet, sPrefix + "/Polygon");
-    if (polygon.isEmpty()) {
-      this->clear();  // Clear all objects
-      qWarning() << "POLYGON IS EMPTY FOR BLOCK" << i;
-      QMessageBox::warning(0, tr("Warning"),
-                           tr("Polygon not valid:") + "\n" + sPrefix);
-      return false;
-    }
+    QString sPrefix = "Block" + QString::number(m_nNumOfBlocks);
 
     // Create new block
     m_listBlocks.append(new Block(
-                          i, polygon, this->readColor(sPrefix + "/Color"),
+                          m_nNumOfBlocks,
+                          QPolygonF(planePolygon(piece.polygon)),
+                          this->readColor(sPrefix + "/Color"),
                           this->readColor(sPrefix + "/BorderColor"),
-                          m_nGridSize, &m_listBlocks, m_pSettings,
-                          this->readStartPosition(
-                            tmpSet, sPrefix + "/StartPos")));
+                          m_nGridSize, &m_listBlocks, &m_CellMap,
+                          m_pSettings, piece.startPos));
+    connect(m_listBlocks.last(), SIGNAL(dragged(Block*)),
+            this, SLOT(queueDrag(Block*)));
     if (!m_bFreestyle) {
       connect(m_listBlocks.last(), SIGNAL(checkPuzzleSolved()),
               this, SLOT(checkPuzzleSolved()));
       connect(m_listBlocks.last(), SIGNAL(incrementMoves()),
               this, SIGNAL(incrementMoves()));
+      connect(m_listBlocks.last(), SIGNAL(recordEvent(int, quint16, QPoint)),
+              this, SIGNAL(recordEvent(int, quint16, QPoint)));
+    } else {
+      connect(m_listBlocks.last(), SIGNAL(checkPuzzleSolved()),
+              this, SLOT(checkFreestyleShape()));
     }
   }
 
@@ -207,32 +289,28 @@ bool Board::createBlocks() {
 // ---------------------------------------------------------------------------
 
 bool Board::createBarriers() {
-  const unsigned char nMaxNumOfBlocks(250);
-
-  for (unsigned int i = 1; i <= nMaxNumOfBlocks; i++) {
-    QString sPrefix = "Barrier" + QString::number(i);
-    if (!m_pBoardConf->contains(sPrefix + "/Polygon")) {
-      break;
-    }
-
-    QPolygonF polygon = this->readPolygon(m_pBoardConf, sPrefix + "/Polygon");
-    if (polygon.isEmpty()) {
-      this->clear();  // Clear all objects
-      qWarning() << "POLYGON IS EMPTY FOR BARRIER" << i;
-      QMessageBox::warning(0, tr("Warning"),
-                           tr("Polygon not valid:") + "\n" + sPrefix);
-      return false;
-    }
+  if (m_Descriptor.sInvalidPolygon.startsWith("Barrier")) {
+    this->clear();  // Clear all objects
+    m_listDragged.clear();
+    QMessageBox::warning(0, tr("Warning"),
+                         tr("Polygon not valid:") + "\n" +
+                         m_Descriptor.sInvalidPolygon);
+    return false;
+  }
 
-    // Create new barrier
-    m_listBlocks.append(new Block(
-                          m_nNumOfBlocks + i, polygon,
-                          this->readColor(sPrefix + "/Color"),
-                          this->readColor(sPrefix + "/BorderColor"),
-                          m_nGridSize, &m_listBlocks, m_pSettings,
-                          this->readStartPosition(m_pBoardConf,
-                                                  sPrefix + "/StartPos"),
-                          true));
+  // Barrier cells are masked in the cell map once (IDs after the pieces),
+  // so that collision checks and moves only deal with movable pieces
+  m_BarrierPath = QPainterPath();
+  for (int i = 0; i < m_Descriptor.listBarriers.size(); i++) {
+    const BoardDescriptor::Piece &barrier = m_Descriptor.listBarriers.at(i);
+    m_CellMap.addCells(latticeCells(barrier.polygon),
+                       Lattice::keyOffset(Lattice::snap(
+                                            Lattice::toPlane(
+                                              barrier.startPos))),
+                       m_nNumOfBlocks + i + 1);
+    QPolygonF poly(planePolygon(barrier.polygon));
+    poly.translate(Lattice::toPlane(barrier.startPos));
+    m_BarrierPath.addPolygon(poly);
   }
 
   return true;
@@ -242,7 +320,7 @@ bool Board::createBarriers() {
 // ---------------------------------------------------------------------------
 
 QColor Board::readColor(const QString &sKey) const {
-  QString sValue = m_pBoardConf->value(sKey, "").toString();
+  QString sValue = m_Descriptor.hashColors.value(sKey, "");
   QColor color(255, 0, 255);
 
   if (sValue.isEmpty()) {
@@ -266,112 +344,6 @@ QColor Board::readColor(const QString &sKey) const {
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
-QPolygonF Board::readPolygon(const QSettings *tmpSet, const QString &sKey,
-                             const bool bScale) {
-  QStringList sList;
-  QStringList sListPoint;
-  QPolygonF polygon;
-  QString sValue(tmpSet->value(sKey, "").toString());
-  quint16 nScale(1);
-  if (bScale) {
-    nScale = m_nGridSize;
-  }
-
-  this->checkOrthogonality(QPointF(-99999, -99999));
-  sList << sValue.split("|");
-  foreach (QString s, sList) {
-    sListPoint.clear();
-    sListPoint << s.split(",");
-    if (2 == sListPoint.size()) {
-      polygon << QPointF(sListPoint[0].trimmed().toShort() * nScale,
-          sListPoint[1].trimmed().toShort() * nScale);
-
-      if (!this->checkOrthogonality(polygon.last())) {
-        qWarning() << "Polygon not orthogonal" << sKey;
-        polygon.clear();
-        break;
-      }
-    } else {
-      qWarning() << "Found invalid polygon point for" << sKey;
-      polygon.clear();
-      break;
-    }
-  }
-
-  if (!polygon.isClosed()) {
-    qWarning() << "Polygon not closed:" << sKey;
-    polygon.clear();
-  }
-  return polygon;
-}
-
-// ---------------------------------------------------------------------------
-// ---------------------------------------------------------------------------
-
-bool Board::checkOrthogonality(QPointF point) const {
-  static QVector<QPointF> listPoints;
-  static quint16 nCnt;
-
-  if (QPointF(-99999, -99999) == point) {  // Reset
-    listPoints.clear();
-    nCnt = 0;
-    return true;
-  } else {
-    nCnt++;
-    listPoints.push_back(point);
-    if (listPoints.size() > 2) {
-      if ((listPoints[0].x() == listPoints[1].x() &&
-          listPoints[1].y() == listPoints[2].y()) ||
-          (listPoints[0].y() == listPoints[1].y() &&
-           listPoints[1].x() == listPoints[2].x())) {
-        listPoints.removeFirst();
-        return true;
-      }
-    } else {  // If size <= 2
-      return true;
-    }
-  }
-
-  qWarning() << "Wrong point #" << nCnt;
-  return false;
-}
-
-// ---------------------------------------------------------------------------
-// ---------------------------------------------------------------------------
-
-QPointF Board::readStartPosition(const QSettings *tmpSet,
-                                 const QString &sKey) const {
-  QStringList sList;
-  QPointF point(1, -1);
-  QString sValue = tmpSet->value(sKey, "").toString();
-  bool bOk1(true);
-  bool bOk2(true);
-
-  if (sValue.count(',') != 1) {
-    sValue = "-1,-1";
-    bOk1 = false;
-  }
-
-  sList << sValue.split(",");
-  if (2 == sList.size() && bOk1) {
-    point.setX(sList[0].trimmed().toInt(&bOk1, 10));
-    point.setY(sList[1].trimmed().toInt(&bOk2, 10));
-  } else {
-    bOk1 = false;
-  }
-
-  if (!bOk1 || !bOk2) {
-    qWarning() << "Found invalid start point for key" << sKey;
-    QMessageBox::warning(0, tr("Warning"),
-                         tr("Invalid start position - using fallback:") +
-                         "\n" + sKey);
-  }
-  return point;
-}
-
-// ---------------------------------------------------------------------------
-// ---------------------------------------------------------------------------
-
 void Board::checkPuzzleSolved() {
   QPainterPath boardPath;
   QTransform transform;
@@ -380,7 +352,7 @@ void Board::checkPuzzleSolved() {
   resizedPoly = transform.map(m_BoardPoly);
   boardPath.addPolygon(resizedPoly);
 
-  QPainterPath unitedBlocks;
+  QPainterPath unitedBlocks(m_BarrierPath);
   QPainterPath tempPath;
   QPainterPath tempPath2;
 
@@ -429,7 +401,53 @@ void Board::checkPuzzleSolved() {
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
+void Board::checkFreestyleShape() {
+  Block *pBlock = qobject_cast<Block *>(this->sender());
+  if (NULL == pBlock) {
+    return;
+  }
+
+  // Flood fill of all covered cells connected with the dropped block
+  QList<QPoint> listShape;
+  QList<QPoint> listQueue(pBlock->getCells());
+  QSet<qint64> setVisited;
+  QSet<quint16> setBlocks;
+
+  foreach (const QPoint &cell, listQueue) {
+    setVisited << ((qint64(cell.x()) << 32) | quint32(cell.y()));
+  }
+  while (!listQueue.isEmpty()) {
+    const QPoint cell(listQueue.takeLast());
+    listShape << cell;
+    setBlocks << m_CellMap.getOwner(cell);
+
+    foreach (const QPoint &next, Lattice::neighbours(cell)) {
+      const qint64 nKey((qint64(next.x()) << 32) | quint32(next.y()));
+      if (m_CellMap.getCount(next) > 0 && !setVisited.contains(nKey)) {
+        setVisited << nKey;
+        listQueue << next;
+      }
+    }
+  }
+
+  // A single block is no construction
+  setBlocks.remove(0);
+  if (setBlocks.size() > 1) {
+    emit builtShape(listShape, setBlocks.size());
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
 void Board::zoomIn() {
+  if (m_bFreestyle) {  // Scale view only, blocks keep their grid
+    if (m_pGraphView->transform().m11() < 4) {
+      m_pGraphView->scale(1.25, 1.25);
+    }
+    return;
+  }
+
   if (m_nGridSize <= 250) {
     m_nGridSize += 5;
   } else {
@@ -439,6 +457,14 @@ void Board::zoomIn() {
 }
 
 void Board::zoomOut() {
+  if (m_bFreestyle) {
+    if (m_pGraphView->transform().m11() > 0.1) {
+      m_pGraphView->scale(0.8, 0.8);
+      this->extendCanvas();
+    }
+    return;
+  }
+
   if (m_nGridSize > 9) {
     m_nGridSize -= 5;
   } else {
@@ -452,6 +478,9 @@ void Board::zoomOut() {
 
 void Board::doZoom() {
   qDebug() << Q_FUNC_INFO << "Grid: " << m_nGridSize;
+  this->clearHint();
+  qDeleteAll(m_listForcedItems);
+  m_listForcedItems.clear();
 
   // Get all QGraphicItems in scene
   QList<QGraphicsItem *> objList = this->items();
@@ -470,6 +499,176 @@ void Board::doZoom() {
   foreach (Block *pB, m_listBlocks) {
     pB->rescaleBlock(m_nGridSize);
   }
+  this->drawForcedMoves();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void Board::extendCanvas() {
+  // Freestyle canvas is unbounded: Keep at least one viewport of scene
+  // around the visible area, so that panning never reaches the border.
+  if (!m_bFreestyle) {
+    return;
+  }
+  QRectF visible(m_pGraphView->mapToScene(
+                   m_pGraphView->viewport()->rect()).boundingRect());
+  QRectF needed(visible.adjusted(-visible.width(), -visible.height(),
+                                 visible.width(), visible.height()));
+  if (!m_pGraphView->sceneRect().contains(needed)) {
+    m_pGraphView->setSceneRect(m_pGraphView->sceneRect().united(needed));
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void Board::drawBackground(QPainter *painter, const QRectF &rect) {
+  QGraphicsScene::drawBackground(painter, rect);
+  if (!m_bFreestyle || !Lattice::IS_SQUARE ||
+      painter->worldTransform().m11() * m_nGridSize < 4) {  // Too dense
+    return;
+  }
+
+  // Only the grid of the exposed area is drawn
+  QVector<QLineF> lines;
+  const qreal dLeft(qFloor(rect.left() / m_nGridSize) * m_nGridSize);
+  const qreal dTop(qFloor(rect.top() / m_nGridSize) * m_nGridSize);
+  for (qreal x = dLeft; x < rect.right(); x += m_nGridSize) {
+    lines << QLineF(x, rect.top(), x, rect.bottom());
+  }
+  for (qreal y = dTop; y < rect.bottom(); y += m_nGridSize) {
+    lines << QLineF(rect.left(), y, rect.right(), y);
+  }
+  painter->setPen(QPen(this->backgroundBrush().color().darker(110), 0));
+  painter->drawLines(lines);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void Board::keyPressEvent(QKeyEvent *p_Event) {
+  qint8 nControl(m_pSettings->getKeyControl(p_Event->key()));
+  if (Settings::ControlNone == nControl || 0 == m_nNumOfBlocks ||
+      !m_pGraphView->isEnabled()) {
+    QGraphicsScene::keyPressEvent(p_Event);
+    return;
+  }
+
+  switch (nControl) {
+    case Settings::ControlSelectNext:
+      this->selectBlock(1);
+      break;
+    case Settings::ControlSelectPrevious:
+      this->selectBlock(-1);
+      break;
+    default:
+      if (m_nSelectedBlock < 0) {
+        this->selectBlock(1);
+      }
+      m_listBlocks[m_nSelectedBlock]->keyControl(nControl);
+  }
+  p_Event->accept();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void Board::mousePressEvent(QGraphicsSceneMouseEvent *p_Event) {
+  // Resolve the block by the cell map instead of the shapes of all items
+  // under the cursor. The block grabs the mouse like an implicit grab.
+  Block *pBlock(NULL);
+  if (NULL == this->mouseGrabberItem()) {
+    pBlock = this->blockAt(p_Event->scenePos());
+  }
+  if (NULL == pBlock) {
+    QGraphicsScene::mousePressEvent(p_Event);
+    return;
+  }
+
+  p_Event->setPos(pBlock->mapFromScene(p_Event->scenePos()));
+  p_Event->setButtonDownPos(p_Event->button(), p_Event->pos());
+  pBlock->grabMouse();
+  this->sendEvent(pBlock, p_Event);
+}
+
+void Board::mouseReleaseEvent(QGraphicsSceneMouseEvent *p_Event) {
+  QGraphicsScene::mouseReleaseEvent(p_Event);
+  // Explicit grab (see mousePressEvent) isn't released by the scene
+  if (Qt::NoButton == p_Event->buttons() && NULL != this->mouseGrabberItem()) {
+    this->mouseGrabberItem()->ungrabMouse();
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+// First drag move of a frame is applied at once (no added lag), further
+// ones only keep the latest position until the frame timer fires
+void Board::queueDrag(Block *pBlock) {
+  if (!m_pFrameTimer->isActive()) {
+    if (pBlock->applyDragPosition()) {
+      m_pFrameTimer->start();
+    }
+  } else if (!m_listDragged.contains(pBlock)) {
+    m_listDragged << pBlock;
+  }
+}
+
+void Board::applyDrags() {
+  bool bMoved(false);
+  foreach (Block *pBlock, m_listDragged) {
+    bMoved |= pBlock->applyDragPosition();
+  }
+  m_listDragged.clear();
+  if (bMoved) {
+    m_pFrameTimer->start();
+  }
+}
+
+Block *Board::blockAt(const QPointF &scenePos) const {
+  const QPoint cell(Lattice::cellAt(scenePos / m_nGridSize));
+  const quint8 nCount(m_CellMap.getCount(cell));
+  if (0 == nCount) {
+    return NULL;
+  }
+
+  // IDs 1..m_nNumOfBlocks are pieces, barriers follow
+  const quint16 nOwner(m_CellMap.getOwner(cell));
+  if (1 == nCount) {
+    if (nOwner > 0 && nOwner <= m_nNumOfBlocks &&
+        nOwner <= m_listBlocks.size()) {
+      return m_listBlocks.at(nOwner - 1);
+    }
+    return NULL;
+  }
+
+  // Overlapping blocks: topmost one covering the cell
+  Block *pTop(NULL);
+  for (int i = 0; i < m_nNumOfBlocks && i < m_listBlocks.size(); i++) {
+    Block *pB = m_listBlocks.at(i);
+    if ((NULL == pTop || pB->zValue() > pTop->zValue()) &&
+        pB->getCells().contains(cell)) {
+      pTop = pB;
+    }
+  }
+  return pTop;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void Board::selectBlock(const int nStep) {
+  if (m_nSelectedBlock >= 0) {
+    m_listBlocks[m_nSelectedBlock]->keyControl(Settings::ControlDrop);
+    if (!m_pGraphView->isEnabled()) {  // Puzzle solved
+      return;
+    }
+    m_nSelectedBlock = (m_nSelectedBlock + nStep + m_nNumOfBlocks) %
+                       m_nNumOfBlocks;
+  } else {
+    m_nSelectedBlock = (nStep > 0) ? 0 : m_nNumOfBlocks - 1;
+  }
+  m_listBlocks[m_nSelectedBlock]->keyControl(Settings::ControlMove);
 }
 
 // ---------------------------------------------------------------------------
@@ -482,6 +681,149 @@ quint16 Board::getGridSize() const {
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
+QList<QList<QPoint> > Board::getPieceCells() const {
+  QList<QList<QPoint> > listPieces;
+  for (int i = 0; i < m_nNumOfBlocks && i < m_listBlocks.size(); i++) {
+    listPieces << m_listBlocks.at(i)->getCells();
+  }
+  return listPieces;
+}
+
+const BoardDescriptor &Board::getDescriptor() const {
+  return m_Descriptor;
+}
+
+// ---------------------------------------------------------------------------
+
+void Board::showHint(const int nPiece, const QList<QPoint> &listCells) {
+  this->clearHint();
+  if (nPiece < 0 || nPiece >= m_nNumOfBlocks) {
+    return;
+  }
+
+  // Target cells in the color of the piece, above all blocks
+  const QString sPrefix("Block" + QString::number(nPiece + 1));
+  QPen pen(this->readColor(sPrefix + "/BorderColor"));
+  pen.setStyle(Qt::DashLine);
+  QBrush brush(this->readColor(sPrefix + "/Color"), Qt::Dense4Pattern);
+  qreal dTopZ(0);
+  foreach (Block *pB, m_listBlocks) {
+    dTopZ = qMax(dTopZ, pB->zValue());
+  }
+  const QTransform scale(QTransform::fromScale(m_nGridSize, m_nGridSize));
+  foreach (const QPoint &cell, listCells) {
+    QGraphicsItem *pItem = this->addPolygon(
+                             scale.map(QPolygonF(Lattice::cellPolygon(cell))),
+                             pen, brush);
+    pItem->setZValue(dTopZ + 1);
+    m_listHintItems << pItem;
+  }
+  m_pHintTimer->start(3000);
+}
+
+void Board::clearHint() {
+  m_pHintTimer->stop();
+  qDeleteAll(m_listHintItems);
+  m_listHintItems.clear();
+}
+
+// ---------------------------------------------------------------------------
+
+void Board::showForcedMoves(const QList<int> &listPieces,
+                            const QList<QList<QPoint> > &listCells,
+                            const QList<QPoint> &listMarked,
+                            const QStringList &sListReasons) {
+  m_listForcedPieces = listPieces;
+  m_listForcedCells = listCells;
+  m_listForcedMarked = listMarked;
+  m_sListForcedReasons = sListReasons;
+  this->drawForcedMoves();
+}
+
+void Board::drawForcedMoves() {
+  // Outlined target cells (kept until the next move), reason as tool tip.
+  // Piece -1 is a conflict.
+  qDeleteAll(m_listForcedItems);
+  m_listForcedItems.clear();
+  qreal dTopZ(0);
+  foreach (Block *pB, m_listBlocks) {
+    dTopZ = qMax(dTopZ, pB->zValue());
+  }
+  const QTransform scale(QTransform::fromScale(m_nGridSize, m_nGridSize));
+  for (int i = 0; i < m_listForcedPieces.size(); i++) {
+    QColor color(Qt::red);
+    if (m_listForcedPieces.at(i) >= 0) {
+      color = this->readColor(
+                "Block" + QString::number(m_listForcedPieces.at(i) + 1) +
+                "/Color");
+    }
+    QPen pen(color);
+    pen.setWidth(2);
+    pen.setStyle(Qt::DotLine);
+    foreach (const QPoint &cell, m_listForcedCells.at(i)) {
+      QBrush brush(Qt::NoBrush);
+      if (cell == m_listForcedMarked.value(i)) {
+        brush = QBrush(color, Qt::Dense5Pattern);
+      }
+      QGraphicsItem *pItem = this->addPolygon(
+                               scale.map(QPolygonF(
+                                           Lattice::cellPolygon(cell))),
+                               pen, brush);
+      pItem->setZValue(dTopZ + 1);
+      pItem->setToolTip(m_sListForcedReasons.value(i));
+      pItem->setAcceptedMouseButtons(Qt::NoButton);
+      m_listForcedItems << pItem;
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void Board::tidyUpPieces() {
+  // Pieces which are not completely on the board are arranged around it
+  QSet<qint64> setBoard;
+  foreach (const QPoint &cell, latticeCells(m_Descriptor.boardPoly)) {
+    setBoard << ((qint64(cell.x()) << 32) | quint32(cell.y()));
+  }
+  QList<Block *> listMoved;
+  QList<QVector<QPointF> > listPolygons;
+  for (int i = 0; i < m_nNumOfBlocks && i < m_listBlocks.size(); i++) {
+    Block *pB = m_listBlocks.at(i);
+    bool bOnBoard(true);
+    foreach (const QPoint &cell, pB->getCells()) {
+      bOnBoard &= setBoard.contains((qint64(cell.x()) << 32) |
+                                    quint32(cell.y()));
+    }
+    if (bOnBoard) {
+      continue;
+    }
+    QVector<QPointF> polygon;
+    foreach (const QPointF &point, pB->getPolygon()) {
+      const QPointF p(Lattice::fromPlane(point));
+      polygon << QPointF(qRound(p.x()), qRound(p.y()));
+    }
+    listMoved << pB;
+    listPolygons << polygon;
+  }
+  if (listMoved.isEmpty()) {
+    return;
+  }
+
+  const QSize size(m_pGraphView->viewport()->size());
+  const QList<QPoint> listPos(PieceLayout::arrange(
+                                m_Descriptor.boardPoly, listPolygons,
+                                size.height() > 0 ?
+                                  qreal(size.width()) / size.height() : 1));
+  for (int i = 0; i < listMoved.size(); i++) {
+    listMoved.at(i)->moveTo(listPos.at(i));
+  }
+  this->update();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
 void Board::saveGame(const QString &sSaveFile, const QString &sTime,
                      const QString &sMoves) {
   QSettings saveConf(sSaveFile, QSettings::IniFormat);
@@ -501,22 +843,24 @@ void Board::saveGame(const QString &sSaveFile, const QString &sTime,
     QPolygonF poly = m_listBlocks.at(i)->getPolygon();
     QString sPoly("");
     foreach (QPointF point, poly) {
-      sPoly += QString::number(point.x()) + "," +
-               QString::number(point.y()) + " | ";
+      point = Lattice::fromPlane(point);
+      sPoly += QString::number(qRound(point.x())) + "," +
+               QString::number(qRound(point.y())) + " | ";
     }
     sPoly.remove(sPoly.length() - 3, sPoly.length());
 
     saveConf.setValue(sPrefix + "/Polygon", sPoly);
-    QPointF pos = m_listBlocks.at(i)->getPosition();
+    QPointF pos = Lattice::fromPlane(m_listBlocks.at(i)->getPosition() /
+                                     m_nGridSize);
     saveConf.setValue(sPrefix + "/StartPos",
-                      QString::number(pos.x() / m_nGridSize) + "," +
-                      QString::number(pos.y() / m_nGridSize));
+                      QString::number(qRound(pos.x())) + "," +
+                      QString::number(qRound(pos.y())));
 
     if (sSaveFile.endsWith("S0LV3D.debug")) {
       sDebug += "[" + sPrefix + "]\n";
       sDebug += "Polygon=\"" + sPoly + "\"\n";
-      sDebug += "StartPos=\"" + QString::number(pos.x() / m_nGridSize) +
-                "," + QString::number(pos.y() / m_nGridSize) + "\"\n";
+      sDebug += "StartPos=\"" + QString::number(qRound(pos.x())) +
+                "," + QString::number(qRound(pos.y())) + "\"\n";
     }
   }
 
@@ -31,10 +31,15 @@
 #include <QGraphicsSceneMouseEvent>
 #include <QGraphicsSceneWheelEvent>
 #include <QGraphicsView>
+#include <QKeyEvent>
+#include <QPainterPath>
 #include <QPolygonF>
-#include <QSettings>
+#include <QStringList>
+#include <QTimer>
 
 #include "./block.h"
+#include "./boarddescriptor.h"
+#include "./cellmap.h"
 
 /**
  * \class Board
@@ -44,51 +49,83 @@ class Board : public QGraphicsScene {
   Q_OBJECT
 
  public:
-    Board(QGraphicsView *pGraphView, const QString &sBoardFile,
-          Settings *pSettings, const quint16 nGridSize = 0,
-          const QString &sSavedGame = "");
+    Board(QGraphicsView *pGraphView, const BoardDescriptor &descriptor,
+          Settings *pSettings, const quint16 nGridSize = 0);
 
     bool setupBoard();
     bool setupBlocks();
     void saveGame(const QString &sSaveFile, const QString &sTime,
                   const QString &sMoves);
     quint16 getGridSize() const;
+    QList<QList<QPoint> > getPieceCells() const;
+    const BoardDescriptor &getDescriptor() const;
+    void showHint(const int nPiece, const QList<QPoint> &listCells);
+    void showForcedMoves(const QList<int> &listPieces,
+                         const QList<QList<QPoint> > &listCells,
+                         const QList<QPoint> &listMarked,
+                         const QStringList &sListReasons);
 
  signals:
     void setWindowSize(const QSize size, const bool bFreestyle);
     void incrementMoves();
     void solvedPuzzle();
+    void builtShape(const QList<QPoint> &listCells, const quint16 nBlocks);
+    void recordEvent(const int nEvent, const quint16 nID, const QPoint &cell);
 
  public slots:
     void zoomIn();
     void zoomOut();
     void checkPuzzleSolved();
+    void tidyUpPieces();
+
+ protected:
+    void keyPressEvent(QKeyEvent *p_Event);
+    void mousePressEvent(QGraphicsSceneMouseEvent *p_Event);
+    void mouseReleaseEvent(QGraphicsSceneMouseEvent *p_Event);
+    void drawBackground(QPainter *painter, const QRectF &rect);
+
+ private slots:
+    void extendCanvas();
+    void checkFreestyleShape();
+    void clearHint();
+    void queueDrag(Block *pBlock);
+    void applyDrags();
 
  private:
     void drawBoard();
     void drawGrid();
+    void drawBarriers();
     bool createBlocks();
     bool createBarriers();
     QColor readColor(const QString &sKey) const;
-    QPolygonF readPolygon(const QSettings *tmpSet, const QString &sKey,
-                          const bool bScale = false);
-    bool checkOrthogonality(QPointF point) const;
-    QPointF readStartPosition(const QSettings *tmpSet,
-                              const QString &sKey) const;
     void doZoom();
+    void selectBlock(const int nStep);
+    Block *blockAt(const QPointF &scenePos) const;
+    void drawForcedMoves();
 
     QGraphicsView *m_pGraphView;
-    QSettings *m_pBoardConf;
-    QSettings *m_pSavedConf;
+    const BoardDescriptor m_Descriptor;
     QString m_sBoardFile;
     Settings *m_pSettings;
     bool m_bSavedGame;
     QPolygonF m_BoardPoly;
-    QList<Block *> m_listBlocks;
-    unsigned char m_nNumOfBlocks;
+    QList<Block *> m_listBlocks;  // Movable pieces only
+    QPainterPath m_BarrierPath;  // Grid units, static part of the board
+    CellMap m_CellMap;
+    quint16 m_nNumOfBlocks;
+    int m_nSelectedBlock;
     quint16 m_nGridSize;
     bool m_bNotAllPiecesNeeded;
     bool m_bFreestyle;
+    QList<QGraphicsItem *> m_listHintItems;
+    QTimer *m_pHintTimer;
+    QTimer *m_pFrameTimer;  // Drag positions, once per display frame
+    QList<Block *> m_listDragged;  // Moved since the last frame
+    QList<int> m_listForcedPieces;
+    QList<QList<QPoint> > m_listForcedCells;
+    QList<QPoint> m_listForcedMarked;  // Cell the reason refers to
+    QStringList m_sListForcedReasons;  // Tool tips
+    QList<QGraphicsItem *> m_listForcedItems;
 };
 
 #endif  // BOARD_H_
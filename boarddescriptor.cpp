@@ -0,0 +1,270 @@
+/**
+ * \file boarddescriptor.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Parsing of board files and saved games (thread-safe, no GUI calls).
+ */
+
+#include "./boarddescriptor.h"
+
+#include <QDebug>
+#include <QSettings>
+
+#include "./lattice.h"
+#include "./piecelayout.h"
+
+BoardDescriptor::BoardDescriptor()
+  : nGridSize(0),
+    bFreestyle(false),
+    bNotAllPiecesNeeded(false),
+    sLattice(SquareLattice::name()),
+    nLayers(1),
+    bMirroring(false) {
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+BoardDescriptor BoardDescriptor::load(const QString &sBoardFile,
+                                      const QString &sSavedGame) {
+  BoardDescriptor desc;
+  QSettings boardConf(sBoardFile, QSettings::IniFormat);
+
+  desc.sBoardFile = sBoardFile;
+  desc.sSavedGame = sSavedGame;
+  desc.nGridSize = boardConf.value("GridSize", 0).toUInt();
+  desc.bFreestyle = boardConf.value("Freestyle", false).toBool();
+  desc.bNotAllPiecesNeeded = boardConf.value("NotAllPiecesNeeded",
+                                             false).toBool();
+
+  // Colors are always taken from board file (also for saved games)
+  foreach (const QString &sKey, boardConf.allKeys()) {
+    if (sKey.endsWith("Color")) {
+      desc.hashColors[sKey] = boardConf.value(sKey, "").toString();
+    }
+  }
+
+  desc.sLattice = boardConf.value("Lattice",
+                                  SquareLattice::name()).toString();
+  desc.nLayers = qMax(1u, boardConf.value("Layers", 1).toUInt());
+  desc.bMirroring = boardConf.value("Mirroring", false).toBool();
+
+  desc.boardPoly = BoardDescriptor::readPolygon(&boardConf, "Board/Polygon");
+  desc.listLayerPolys << desc.boardPoly;
+  for (quint16 i = 2; i <= desc.nLayers; i++) {
+    // Layers without own polygon are equal to the one below (box)
+    QString sKey("Board/PolygonLayer" + QString::number(i));
+    if (boardConf.contains(sKey)) {
+      desc.listLayerPolys << BoardDescriptor::readPolygon(&boardConf, sKey);
+      if (desc.listLayerPolys.last().isEmpty()) {
+        qWarning() << "INVALID POLYGON FOR" << sKey;
+        desc.sInvalidPolygon = sKey;
+      }
+    } else {
+      desc.listLayerPolys << desc.listLayerPolys.last();
+    }
+  }
+  // A layer polygon above the top layer is a typo in Layers or the key
+  const QString sAboveTop("Board/PolygonLayer" +
+                          QString::number(desc.nLayers + 1));
+  if (desc.sInvalidPolygon.isEmpty() && boardConf.contains(sAboveTop)) {
+    qWarning() << "Layer polygon above top layer:" << sAboveTop <<
+                  "Layers =" << desc.nLayers;
+    desc.sInvalidPolygon = sAboveTop;
+  }
+
+  if (sSavedGame.isEmpty()) {
+    desc.readPieces(&boardConf, "Block", &desc.listBlocks);
+  } else {
+    QSettings savedConf(sSavedGame, QSettings::IniFormat);
+    desc.readPieces(&savedConf, "Block", &desc.listBlocks);
+  }
+  if (desc.sInvalidPolygon.isEmpty()) {
+    desc.readPieces(&boardConf, "Barrier", &desc.listBarriers);
+  }
+
+  // Arrange pieces around the board if requested or start positions missing
+  if (sSavedGame.isEmpty() && desc.sInvalidPolygon.isEmpty() &&
+      !desc.boardPoly.isEmpty()) {
+    bool bAutoLayout(boardConf.value("AutoLayout", false).toBool());
+    foreach (const QString &sKey, desc.sListInvalidStartPos) {
+      bAutoLayout |= sKey.startsWith("Block");
+    }
+    if (bAutoLayout) {
+      desc.arrangeBlocks();
+    }
+  }
+
+  return desc;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void BoardDescriptor::arrangeBlocks() {
+  QList<QVector<QPointF> > listPolygons;
+  foreach (const Piece &block, listBlocks) {
+    listPolygons << block.polygon;
+  }
+
+  // Same proportion as the initial window (board size * 2.5 x 2.6)
+  QPointF min(boardPoly.first());
+  QPointF max(boardPoly.first());
+  foreach (const QPointF &point, boardPoly) {
+    min.setX(qMin(min.x(), point.x()));
+    min.setY(qMin(min.y(), point.y()));
+    max.setX(qMax(max.x(), point.x()));
+    max.setY(qMax(max.y(), point.y()));
+  }
+  const qreal dAspectRatio(max.y() > min.y() ?
+                             (max.x() - min.x()) * 2.5 /
+                             ((max.y() - min.y()) * 2.6) : 1);
+
+  const QList<QPoint> listPos(PieceLayout::arrange(boardPoly, listPolygons,
+                                                   dAspectRatio));
+  for (int i = 0; i < listBlocks.size(); i++) {
+    listBlocks[i].startPos = listPos.at(i);
+  }
+
+  // Missing start positions of blocks have been replaced
+  QStringList sListInvalid;
+  foreach (const QString &sKey, sListInvalidStartPos) {
+    if (!sKey.startsWith("Block")) {
+      sListInvalid << sKey;
+    }
+  }
+  sListInvalidStartPos = sListInvalid;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool BoardDescriptor::readPieces(const QSettings *pConf,
+                                 const QString &sGroup,
+                                 QList<Piece> *pList) {
+  const quint16 nMaxNumOfBlocks(9999);
+
+  for (unsigned int i = 1; i <= nMaxNumOfBlocks; i++) {
+    QString sPrefix = sGroup + QString::number(i);
+    if (!pConf->contains(sPrefix + "/Polygon")) {
+      break;
+    }
+
+    Piece piece;
+    piece.polygon = BoardDescriptor::readPolygon(pConf, sPrefix + "/Polygon");
+    if (piece.polygon.isEmpty()) {
+      qWarning() << "POLYGON IS EMPTY FOR" << sPrefix;
+      sInvalidPolygon = sPrefix;
+      return false;
+    }
+    piece.startPos = this->readStartPosition(pConf, sPrefix + "/StartPos");
+    pList->append(piece);
+  }
+
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+QVector<QPointF> BoardDescriptor::readPolygon(const QSettings *pConf,
+                                              const QString &sKey) {
+  QStringList sListPoint;
+  QVector<QPointF> polygon;
+  QVector<QPointF> listPoints;  // Sliding window for orthogonality check
+  QString sValue(pConf->value(sKey, "").toString());
+
+  foreach (const QString &s, sValue.split("|")) {
+    sListPoint = s.split(",");
+    if (2 == sListPoint.size()) {
+      polygon << QPointF(sListPoint[0].trimmed().toShort(),
+                         sListPoint[1].trimmed().toShort());
+
+      if (!BoardDescriptor::checkOrthogonality(&listPoints, polygon.last())) {
+        qWarning() << "Wrong point #" << polygon.size();
+        qWarning() << "Polygon not orthogonal" << sKey;
+        polygon.clear();
+        break;
+      }
+    } else {
+      qWarning() << "Found invalid polygon point for" << sKey;
+      polygon.clear();
+      break;
+    }
+  }
+
+  if (polygon.isEmpty() || polygon.first() != polygon.last()) {
+    qWarning() << "Polygon not closed:" << sKey;
+    polygon.clear();
+  }
+  return polygon;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool BoardDescriptor::checkOrthogonality(QVector<QPointF> *pListPoints,
+                                         const QPointF &point) {
+  pListPoints->push_back(point);
+  if (pListPoints->size() <= 2) {
+    return true;
+  }
+
+  // Edges have to follow the grid lines of the lattice
+  const QVector<QPointF> &p = *pListPoints;
+  if (Lattice::checkCorner(p[0], p[1], p[2])) {
+    pListPoints->remove(0);
+    return true;
+  }
+  return false;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+QPointF BoardDescriptor::readStartPosition(const QSettings *pConf,
+                                           const QString &sKey) {
+  QStringList sList;
+  QPointF point(1, -1);
+  QString sValue = pConf->value(sKey, "").toString();
+  bool bOk1(true);
+  bool bOk2(true);
+
+  if (sValue.count(',') != 1) {
+    sValue = "-1,-1";
+    bOk1 = false;
+  }
+
+  sList << sValue.split(",");
+  if (2 == sList.size() && bOk1) {
+    point.setX(sList[0].trimmed().toInt(&bOk1, 10));
+    point.setY(sList[1].trimmed().toInt(&bOk2, 10));
+  } else {
+    bOk1 = false;
+  }
+
+  if (!bOk1 || !bOk2) {
+    qWarning() << "Found invalid start point for key" << sKey;
+    sListInvalidStartPos << sKey;
+  }
+  return point;
+}
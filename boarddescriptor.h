@@ -0,0 +1,83 @@
+/**
+ * \file boarddescriptor.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for a parsed board file.
+ */
+
+#ifndef BOARDDESCRIPTOR_H_
+#define BOARDDESCRIPTOR_H_
+
+#include <QHash>
+#include <QList>
+#include <QPointF>
+#include <QStringList>
+#include <QVector>
+
+class QSettings;
+
+/**
+ * \class BoardDescriptor
+ * \brief Board, block and barrier data read from a board file.
+ *
+ * Uses QtCore only, so that a board can be parsed on a worker thread.
+ * Messages for the user are collected and shown by Board afterwards.
+ */
+class BoardDescriptor {
+ public:
+    struct Piece {
+      QVector<QPointF> polygon;  // In grid units
+      QPointF startPos;
+    };
+
+    BoardDescriptor();
+    static BoardDescriptor load(const QString &sBoardFile,
+                                const QString &sSavedGame = "");
+
+    QString sBoardFile;
+    QString sSavedGame;
+    quint16 nGridSize;
+    bool bFreestyle;
+    bool bNotAllPiecesNeeded;
+    QString sLattice;  // Grid geometry, see lattice.h
+    quint16 nLayers;  // > 1 for 3D boxes
+    bool bMirroring;  // 3D only: 48 instead of 24 orientations
+    QVector<QPointF> boardPoly;  // In grid units, empty if invalid
+    QList<QVector<QPointF> > listLayerPolys;  // Bottom to top, first=boardPoly
+    QList<Piece> listBlocks;
+    QList<Piece> listBarriers;
+    QHash<QString, QString> hashColors;
+    QString sInvalidPolygon;  // Key/prefix of first invalid layer/block/barrier
+    QStringList sListInvalidStartPos;
+
+ private:
+    void arrangeBlocks();
+    bool readPieces(const QSettings *pConf, const QString &sGroup,
+                    QList<Piece> *pList);
+    static QVector<QPointF> readPolygon(const QSettings *pConf,
+                                        const QString &sKey);
+    static bool checkOrthogonality(QVector<QPointF> *pListPoints,
+                                   const QPointF &point);
+    QPointF readStartPosition(const QSettings *pConf, const QString &sKey);
+};
+
+#endif  // BOARDDESCRIPTOR_H_
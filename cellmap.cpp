@@ -0,0 +1,206 @@
+/**
+ * \file cellmap.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Cell occupancy map used for collision checks.
+ */
+
+#include "./cellmap.h"
+
+#include <qmath.h>
+
+CellMap::CellMap()
+  : m_nLastKey(0),
+    m_pLastTile(NULL) {
+}
+
+CellMap::~CellMap() {
+  this->clear();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void CellMap::clear() {
+  qDeleteAll(m_hashTiles);
+  m_hashTiles.clear();
+  m_pLastTile = NULL;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void CellMap::addCells(const QList<QPoint> &listCells, const QPoint &offset,
+                       const quint16 nOwner) {
+  foreach (const QPoint &cell, listCells) {
+    const QPoint pos(cell + offset);
+    Tile *&pTile = m_hashTiles[CellMap::tileKey(pos)];
+    if (NULL == pTile) {
+      pTile = new Tile();  // Zero initialized
+    }
+    const int nIndex(CellMap::cellIndex(pos));
+    if (0 == pTile->nCount[nIndex]) {
+      pTile->nUsedCells++;
+    }
+    pTile->nCount[nIndex]++;
+    pTile->nOwners[nIndex] ^= nOwner;
+  }
+}
+
+void CellMap::removeCells(const QList<QPoint> &listCells,
+                          const QPoint &offset, const quint16 nOwner) {
+  foreach (const QPoint &cell, listCells) {
+    const QPoint pos(cell + offset);
+    QHash<quint32, Tile *>::iterator it = m_hashTiles.find(
+                                            CellMap::tileKey(pos));
+    if (it == m_hashTiles.end()) {
+      continue;
+    }
+    Tile *pTile = it.value();
+    const int nIndex(CellMap::cellIndex(pos));
+    if (0 == pTile->nCount[nIndex]) {
+      continue;
+    }
+    pTile->nCount[nIndex]--;
+    pTile->nOwners[nIndex] ^= nOwner;
+    if (0 == pTile->nCount[nIndex]) {
+      pTile->nUsedCells--;
+      if (0 == pTile->nUsedCells) {  // Free unused tile
+        if (m_pLastTile == pTile) {
+          m_pLastTile = NULL;
+        }
+        delete pTile;
+        m_hashTiles.erase(it);
+      }
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool CellMap::isFree(const QList<QPoint> &listCells, const QPoint &offset,
+                     const quint16 nOwner) const {
+  foreach (const QPoint &cell, listCells) {
+    const QPoint pos(cell + offset);
+    const Tile *pTile = this->findTile(pos);
+    if (NULL != pTile) {
+      const int nIndex(CellMap::cellIndex(pos));
+      // Cell may only be covered by the block itself
+      if (pTile->nCount[nIndex] > 1 ||
+          (1 == pTile->nCount[nIndex] && pTile->nOwners[nIndex] != nOwner)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+quint8 CellMap::getCount(const QPoint &cell) const {
+  const Tile *pTile = this->findTile(cell);
+  if (NULL == pTile) {
+    return 0;
+  }
+  return pTile->nCount[CellMap::cellIndex(cell)];
+}
+
+quint16 CellMap::getOwner(const QPoint &cell) const {
+  const Tile *pTile = this->findTile(cell);
+  if (NULL != pTile && 1 == pTile->nCount[CellMap::cellIndex(cell)]) {
+    return pTile->nOwners[CellMap::cellIndex(cell)];
+  }
+  return 0;  // Empty or ambiguous
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+QList<QPoint> CellMap::rasterize(const QVector<QPointF> &polygon) {
+  QList<QPoint> listCells;
+  if (polygon.size() < 3) {
+    return listCells;
+  }
+
+  qreal dMinX(polygon.first().x());
+  qreal dMaxX(dMinX);
+  qreal dMinY(polygon.first().y());
+  qreal dMaxY(dMinY);
+  foreach (const QPointF &p, polygon) {
+    dMinX = qMin(dMinX, p.x());
+    dMaxX = qMax(dMaxX, p.x());
+    dMinY = qMin(dMinY, p.y());
+    dMaxY = qMax(dMaxY, p.y());
+  }
+
+  // Test of every cell center
+  for (int y = qFloor(dMinY); y < qCeil(dMaxY); y++) {
+    for (int x = qFloor(dMinX); x < qCeil(dMaxX); x++) {
+      if (CellMap::containsPoint(polygon, QPointF(x + 0.5, y + 0.5))) {
+        listCells << QPoint(x, y);
+      }
+    }
+  }
+  return listCells;
+}
+
+bool CellMap::containsPoint(const QVector<QPointF> &polygon,
+                            const QPointF &point) {
+  // Even-odd rule
+  const int nSize(polygon.size());
+  bool bInside(false);
+  for (int i = 0, j = nSize - 1; i < nSize; j = i++) {
+    const QPointF &pi = polygon.at(i);
+    const QPointF &pj = polygon.at(j);
+    if ((pi.y() > point.y()) != (pj.y() > point.y()) &&
+        point.x() < (pj.x() - pi.x()) * (point.y() - pi.y()) /
+        (pj.y() - pi.y()) + pi.x()) {
+      bInside = !bInside;
+    }
+  }
+  return bInside;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+const CellMap::Tile *CellMap::findTile(const QPoint &cell) const {
+  const quint32 nKey(CellMap::tileKey(cell));
+  if (NULL == m_pLastTile || nKey != m_nLastKey) {
+    m_pLastTile = m_hashTiles.value(nKey, NULL);
+    m_nLastKey = nKey;
+  }
+  return m_pLastTile;
+}
+
+quint32 CellMap::tileKey(const QPoint &cell) {
+  // Arithmetic shift -> negative cells map to negative tiles
+  return (quint32(quint16(cell.x() >> TILESHIFT)) << 16) |
+      quint16(cell.y() >> TILESHIFT);
+}
+
+int CellMap::cellIndex(const QPoint &cell) {
+  return ((cell.y() & (TILESIZE - 1)) << TILESHIFT) |
+      (cell.x() & (TILESIZE - 1));
+}
@@ -0,0 +1,85 @@
+/**
+ * \file cellmap.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the cell occupancy map.
+ */
+
+#ifndef CELLMAP_H_
+#define CELLMAP_H_
+
+#include <QHash>
+#include <QList>
+#include <QPoint>
+#include <QPointF>
+#include <QVector>
+
+/**
+ * \class CellMap
+ * \brief Occupancy of all grid cells (on and off the board).
+ *
+ * Each cell stores the number of blocks covering it and the XOR of their
+ * IDs, so the owner of a cell covered by exactly one block is known
+ * without searching the block list. Cells are stored in sparse tiles of
+ * 16x16 cells, tiles without any covered cell are freed.
+ */
+class CellMap {
+ public:
+    CellMap();
+    ~CellMap();
+
+    void clear();
+    void addCells(const QList<QPoint> &listCells, const QPoint &offset,
+                  const quint16 nOwner);
+    void removeCells(const QList<QPoint> &listCells, const QPoint &offset,
+                     const quint16 nOwner);
+    bool isFree(const QList<QPoint> &listCells, const QPoint &offset,
+                const quint16 nOwner) const;
+    quint8 getCount(const QPoint &cell) const;
+    quint16 getOwner(const QPoint &cell) const;
+
+    static QList<QPoint> rasterize(const QVector<QPointF> &polygon);
+    static bool containsPoint(const QVector<QPointF> &polygon,
+                              const QPointF &point);
+
+ private:
+    Q_DISABLE_COPY(CellMap)
+
+    static const int TILESHIFT = 4;
+    static const int TILESIZE = 1 << TILESHIFT;
+
+    struct Tile {
+      quint8 nCount[TILESIZE * TILESIZE];
+      quint16 nOwners[TILESIZE * TILESIZE];  // XOR of all IDs of a cell
+      quint16 nUsedCells;
+    };
+
+    static quint32 tileKey(const QPoint &cell);
+    static int cellIndex(const QPoint &cell);
+    const Tile *findTile(const QPoint &cell) const;
+
+    QHash<quint32, Tile *> m_hashTiles;
+    mutable quint32 m_nLastKey;  // Most blocks are within one tile
+    mutable const Tile *m_pLastTile;
+};
+
+#endif  // CELLMAP_H_
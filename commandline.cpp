@@ -0,0 +1,864 @@
+/**
+ * \file commandline.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Headless command line tools.
+ */
+
+#include "./commandline.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHostAddress>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QTime>
+#if defined(SCRIPT_SUPPORT)
+#include <QJSEngine>
+#include <QQmlEngine>
+#endif
+
+#include "./highscore.h"
+#include "./lattice.h"
+#include "./loadgenerator.h"
+#include "./movelog.h"
+#include "./profilecounter.h"
+#include "./puzzleserver.h"
+#if defined(SCRIPT_SUPPORT)
+#include "./scriptboard.h"
+#endif
+#include "./solvercache.h"
+#include "./solverdaemon.h"
+#include "./telemetry.h"
+
+const CommandLine::Command CommandLine::COMMANDS[] = {
+  {"--solve", &CommandLine::solveBoard},
+  {"--count", &CommandLine::solveBoard},
+  {"--rank", &CommandLine::rankBoards},
+  {"--benchmark", &CommandLine::benchmarkBoards},
+  {"--daemon", &CommandLine::runDaemon},
+  {"--server", &CommandLine::runServer},
+  {"--loadgen", &CommandLine::runLoadGenerator},
+  {"--verify-scores", &CommandLine::verifyHighscores},
+  {"--telemetry", &CommandLine::analyzeTelemetry},
+  {"--script", &CommandLine::runScript},
+  {NULL, NULL}
+};
+
+// Handler of the first argument, which is a command, NULL for the GUI
+CommandLine::Handler CommandLine::findHandler(int argc, char *argv[]) {
+  for (int i = 1; i < argc; i++) {
+    for (int j = 0; NULL != COMMANDS[j].sFlag; j++) {
+      if (0 == qstrcmp(argv[i], COMMANDS[j].sFlag)) {
+        return COMMANDS[j].handler;
+      }
+    }
+  }
+  return NULL;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+QString CommandLine::getSharePath() {
+  const QString sAppDir(QCoreApplication::applicationDirPath());
+  // Default share data path (Windows and debugging)
+  QString sSharePath(sAppDir);
+  // Standard installation path (Linux)
+  const QString sInstallPath(sAppDir + "/../share/"
+                             + QCoreApplication::applicationName().toLower());
+  if (!QCoreApplication::arguments().contains("--debug") &&
+      QDir(sInstallPath).exists()) {
+    sSharePath = sInstallPath;
+  }
+#if defined(Q_OS_OSX)
+  sSharePath = sAppDir + "/../Resources/";
+#endif
+  return sSharePath;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+int CommandLine::solveBoard(const QStringList &sListArgs) {
+  QTextStream console(stdout);
+  const bool bCount(sListArgs.contains("--count"));
+  const int nIndex(sListArgs.indexOf(bCount ? "--count" : "--solve"));
+  if (nIndex + 1 >= sListArgs.size()) {
+    console << "Usage: " << sListArgs.at(0)
+            << " --solve|--count <board.conf> [--threads <n>]"
+               " [--table <MB>] [--parity] [--dp|--check|--zdd] [--random]\n";
+    return 1;
+  }
+
+  const QString sBoardFile(sListArgs.at(nIndex + 1));
+  if (!QFile::exists(sBoardFile)) {
+    qWarning() << "Board file not found:" << sBoardFile;
+    return 1;
+  }
+  int nThreads(0);  // Ideal thread count
+  const int nThreadIndex(sListArgs.indexOf("--threads"));
+  if (nThreadIndex > 0 && nThreadIndex + 1 < sListArgs.size()) {
+    nThreads = sListArgs.at(nThreadIndex + 1).toInt();
+  }
+  int nTableSize(64);  // MB for the transposition table, 0 = off
+  const int nTableIndex(sListArgs.indexOf("--table"));
+  if (nTableIndex > 0 && nTableIndex + 1 < sListArgs.size()) {
+    nTableSize = sListArgs.at(nTableIndex + 1).toInt();
+  }
+
+  BoardDescriptor descriptor(BoardDescriptor::load(sBoardFile));
+  if (descriptor.boardPoly.isEmpty() ||
+      !descriptor.sInvalidPolygon.isEmpty()) {
+    qWarning() << "Invalid board:" << sBoardFile;
+    return 1;
+  }
+  if (descriptor.sLattice != Lattice::name()) {
+    qWarning() << "Lattice not supported by this build:" <<
+                  descriptor.sLattice;
+    return 1;
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+  // Transfer matrix counter instead of / in addition to exact cover
+  const bool bCheck(bCount && sListArgs.contains("--check"));
+  if (bCount && (bCheck || sListArgs.contains("--dp"))) {
+    ProfileCounter counter(descriptor);
+    if (!counter.isValid()) {
+      qWarning() << "Board not supported by transfer matrix counter.";
+      return 1;
+    }
+    const quint64 nSolutions(counter.countSolutions());
+    console << "Solutions (transfer matrix): " << nSolutions << " ("
+            << counter.getMaxStates() << " states, " << timer.elapsed()
+            << " ms)\n";
+    if (!bCheck) {
+      return 0;
+    }
+    console.flush();
+
+    Solver solver(descriptor);
+    solver.setTableSize(nTableSize);
+    timer.restart();
+    const quint64 nExpected(solver.countSolutions(nThreads));
+    console << "Solutions (exact cover): " << nExpected << " ("
+            << solver.getNodes() << " nodes, " << timer.elapsed() << " ms)\n";
+    if (nSolutions != nExpected) {
+      qWarning() << "Solution counts differ!";
+      return 3;
+    }
+    return 0;
+  }
+
+  Solver solver(descriptor);
+  // Diagram of all solutions: counted in one pass, sampled uniformly
+  if ((bCount && sListArgs.contains("--zdd")) ||
+      (!bCount && sListArgs.contains("--random"))) {
+    Zdd zdd;
+    if (!solver.buildZdd(&zdd)) {
+      qWarning() << "Too many subproblems for solution diagram.";
+      return 1;
+    }
+    if (bCount) {
+      console << "Solutions: " << zdd.count() << " (ZDD with "
+              << zdd.getNumOfNodes() << " nodes, " << timer.elapsed()
+              << " ms)\n";
+      return 0;
+    }
+    if (0 == zdd.count()) {
+      console << "No solution found (" << timer.elapsed() << " ms)\n";
+      return 2;
+    }
+    qsrand(QTime::currentTime().msecsSinceStartOfDay());
+    QList<Solver::Placement> listSolution;
+    foreach (int nRow, zdd.sample()) {
+      listSolution << solver.getPlacements().at(nRow);
+    }
+    printSolution(solver, listSolution, &console);
+    console << "Random solution of " << zdd.count() << " (" << timer.elapsed()
+            << " ms)\n";
+    return 0;
+  }
+
+  if (bCount) {
+    solver.setTableSize(nTableSize);
+    solver.setParityPruning(sListArgs.contains("--parity"));
+    const quint64 nSolutions(solver.countSolutions(nThreads));
+    console << "Solutions: " << nSolutions << " (" << solver.getNodes()
+            << " nodes, " << timer.elapsed() << " ms)\n";
+  } else {
+    QList<Solver::Placement> listSolution;
+    if (!solver.findSolution(&listSolution)) {
+      console << "No solution found (" << timer.elapsed() << " ms)\n";
+      return 2;
+    }
+    printSolution(solver, listSolution, &console);
+    console << "Found in " << timer.elapsed() << " ms\n";
+  }
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+int CommandLine::rankBoards(const QStringList &sListArgs) {
+  QTextStream console(stdout);
+  const int nIndex(sListArgs.indexOf("--rank"));
+  if (nIndex + 1 >= sListArgs.size()) {
+    console << "Usage: " << sListArgs.at(0) << " --rank <board.conf|folder>\n";
+    return 1;
+  }
+
+  QStringList sListBoards;
+  const QString sPath(sListArgs.at(nIndex + 1));
+  if (QFileInfo(sPath).isDir()) {
+    QDirIterator it(sPath, QStringList() << "*.conf",
+                    QDir::NoDotAndDotDot | QDir::Files,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+      sListBoards << it.next();
+    }
+  } else if (QFile::exists(sPath)) {
+    sListBoards << sPath;
+  }
+  sListBoards.sort();
+
+  // Frequency maps are built with the solution cache on first use
+  QMultiMap<qreal, QString> mapRanking;
+  const QString sCacheDir(SolverCache::defaultCacheDir());
+  foreach (const QString &sBoard, sListBoards) {
+    if (QSettings(sBoard, QSettings::IniFormat).value(
+          "Freestyle", false).toBool()) {
+      continue;
+    }
+    SolverCache cache(sBoard, sCacheDir);
+    if (!cache.isValid()) {
+      continue;
+    }
+    const qreal dConstraint(cache.constraint());
+    if (dConstraint < 0) {
+      console << "  -     " << QFileInfo(sBoard).baseName()
+              << " (too many solutions)\n";
+    } else {
+      mapRanking.insert(dConstraint, QFileInfo(sBoard).baseName() + " (" +
+                        QString::number(cache.getNumOfSolutions()) +
+                        " solutions)");
+    }
+    console.flush();
+  }
+
+  // Most constrained board first
+  QMapIterator<qreal, QString> it(mapRanking);
+  it.toBack();
+  while (it.hasPrevious()) {
+    it.previous();
+    console << QString::number(it.key(), 'f', 3) << "  " << it.value() << "\n";
+  }
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+int CommandLine::benchmarkBoards(const QStringList &sListArgs) {
+  QTextStream console(stdout);
+  const int nIndex(sListArgs.indexOf("--benchmark"));
+  if (nIndex + 1 >= sListArgs.size()) {
+    console << "Usage: " << sListArgs.at(0)
+            << " --benchmark <board.conf|folder>\n";
+    return 1;
+  }
+
+  QStringList sListBoards;
+  const QString sPath(sListArgs.at(nIndex + 1));
+  if (QFileInfo(sPath).isDir()) {
+    QDirIterator it(sPath, QStringList() << "*.conf",
+                    QDir::NoDotAndDotDot | QDir::Files,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+      sListBoards << it.next();
+    }
+  } else if (QFile::exists(sPath)) {
+    sListBoards << sPath;
+  }
+  sListBoards.sort();
+
+  // Same search single threaded without and with parity pruning
+  quint64 nTotalNodes[2] = {0, 0};
+  qint64 nTotalTime[2] = {0, 0};
+  QElapsedTimer timer;
+  foreach (const QString &sBoard, sListBoards) {
+    BoardDescriptor descriptor(BoardDescriptor::load(sBoard));
+    if (descriptor.bFreestyle || descriptor.boardPoly.isEmpty() ||
+        !descriptor.sInvalidPolygon.isEmpty() ||
+        descriptor.sLattice != Lattice::name()) {
+      continue;
+    }
+    Solver solver(descriptor);
+    quint64 nSolutions[2] = {0, 0};
+    quint64 nNodes[2] = {0, 0};
+    qint64 nTime[2] = {0, 0};
+    for (int i = 0; i < 2; i++) {
+      solver.setParityPruning(1 == i);
+      timer.start();
+      nSolutions[i] = solver.countSolutions(1);
+      nTime[i] = timer.elapsed();
+      nNodes[i] = solver.getNodes();
+      nTotalNodes[i] += nNodes[i];
+      nTotalTime[i] += nTime[i];
+    }
+    if (nSolutions[0] != nSolutions[1]) {
+      qWarning() << "Solution counts differ:" << sBoard;
+      return 3;
+    }
+
+    const qreal dLess(100.0 - 100.0 * nNodes[1] / qMax(nNodes[0],
+                                                        quint64(1)));
+    console << QFileInfo(sBoard).baseName() << ": " << nSolutions[0]
+            << " solutions, nodes " << nNodes[0] << " -> " << nNodes[1]
+            << " (-" << QString::number(dLess, 'f', 1) << " %), time "
+            << nTime[0] << " -> " << nTime[1] << " ms\n";
+    console.flush();
+  }
+
+  const qreal dLess(100.0 - 100.0 * nTotalNodes[1] /
+                    qMax(nTotalNodes[0], quint64(1)));
+  console << "Total: nodes " << nTotalNodes[0] << " -> " << nTotalNodes[1]
+          << " (-" << QString::number(dLess, 'f', 1) << " %), time "
+          << nTotalTime[0] << " -> " << nTotalTime[1] << " ms\n";
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+int CommandLine::runDaemon(const QStringList &sListArgs) {
+  // Memory: one shared search table and the solvers of the kept boards
+  int nTableSize(64);
+  int nMaxBoards(16);
+  bool bOk(true);
+  for (int i = sListArgs.indexOf("--daemon") + 1;
+       bOk && i + 1 < sListArgs.size(); i += 2) {
+    if ("--table" == sListArgs.at(i)) {
+      nTableSize = sListArgs.at(i + 1).toInt(&bOk);
+    } else if ("--max-boards" == sListArgs.at(i)) {
+      nMaxBoards = sListArgs.at(i + 1).toInt(&bOk);
+    } else {
+      bOk = false;
+    }
+  }
+  if (!bOk || nTableSize < 0 || nMaxBoards < 1) {
+    QTextStream(stdout) << "Usage: " << sListArgs.at(0)
+                        << " --daemon [--table <MB>] [--max-boards <n>]\n";
+    return 1;
+  }
+
+  SolverCache::setSearchTableSize(nTableSize);
+  SolverDaemon daemon(SolverCache::defaultCacheDir(), nMaxBoards);
+  if (!daemon.listen()) {
+    return 1;
+  }
+  return QCoreApplication::exec();
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+int CommandLine::runServer(const QStringList &sListArgs) {
+  quint16 nPort(PuzzleServer::DEFAULT_PORT);
+  QHostAddress address(QHostAddress::LocalHost);
+  int nThreads(0);  // Ideal thread count
+  int nMaxSessions(10000);
+  QString sBoardsDir(getSharePath() + "/boards");
+
+  for (int i = sListArgs.indexOf("--server") + 1;
+       i + 1 < sListArgs.size(); i += 2) {
+    const QString sOption(sListArgs.at(i));
+    const QString sValue(sListArgs.at(i + 1));
+    if ("--port" == sOption) {
+      nPort = sValue.toUShort();
+    } else if ("--bind" == sOption) {
+      address = ("any" == sValue) ? QHostAddress(QHostAddress::Any) :
+                                    QHostAddress(sValue);
+    } else if ("--threads" == sOption) {
+      nThreads = sValue.toInt();
+    } else if ("--sessions" == sOption) {
+      nMaxSessions = sValue.toInt();
+    } else if ("--boards" == sOption) {
+      sBoardsDir = sValue;
+    } else {
+      break;
+    }
+  }
+  if (0 == nPort || address.isNull() || nMaxSessions <= 0 ||
+      !QDir(sBoardsDir).exists()) {
+    QTextStream(stdout) << "Usage: " << sListArgs.at(0)
+                        << " --server [--port <n>] [--bind <address|any>]"
+                           " [--threads <n>] [--sessions <n>]"
+                           " [--boards <folder>]\n";
+    return 1;
+  }
+
+  PuzzleServer server(sBoardsDir, nThreads, nMaxSessions);
+  if (!server.listen(address, nPort)) {
+    qWarning() << "Couldn't start puzzle server:" << server.errorString();
+    return 1;
+  }
+  qDebug() << "Puzzle server listening on" << address.toString() << nPort
+           << "- boards:" << sBoardsDir;
+  return QCoreApplication::exec();
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+int CommandLine::runLoadGenerator(const QStringList &sListArgs) {
+  LoadGenerator::Options options;
+  options.sBoardsDir = getSharePath() + "/boards";
+  bool bOk(true);
+
+  for (int i = sListArgs.indexOf("--loadgen") + 1;
+       bOk && i + 1 < sListArgs.size(); i += 2) {
+    const QString sOption(sListArgs.at(i));
+    const QString sValue(sListArgs.at(i + 1));
+    if ("--players" == sOption) {
+      options.nPlayers = sValue.toInt(&bOk);
+    } else if ("--moves" == sOption) {
+      options.nMoves = sValue.toInt(&bOk);
+    } else if ("--threads" == sOption) {
+      options.nThreads = sValue.toInt(&bOk);
+    } else if ("--boards" == sOption) {
+      options.sBoardsDir = sValue;
+    } else if ("--board-count" == sOption) {
+      options.nBoards = sValue.toInt(&bOk);
+    } else if ("--seed" == sOption) {
+      options.nSeed = sValue.toUInt(&bOk);
+    } else if ("--server" == sOption) {
+      // host[:port]
+      options.sHost = sValue.section(':', 0, 0);
+      if (sValue.contains(':')) {
+        options.nPort = sValue.section(':', 1).toUShort(&bOk);
+      }
+    } else if ("--record" == sOption) {
+      options.sRecordFile = sValue;
+    } else if ("--replay" == sOption) {
+      options.sReplayFile = sValue;
+    } else {
+      bOk = false;
+    }
+  }
+  if (!bOk || options.nPlayers <= 0 || options.nMoves < 0 ||
+      options.nBoards <= 0 || !QDir(options.sBoardsDir).exists()) {
+    QTextStream(stdout) << "Usage: " << sListArgs.at(0)
+                        << " --loadgen [--players <n>] [--moves <n>]"
+                           " [--threads <n>] [--server <host[:port]>]"
+                           " [--boards <folder>] [--board-count <n>]"
+                           " [--seed <n>] [--record|--replay <file>]\n";
+    return 1;
+  }
+
+  QTextStream console(stdout);
+  LoadGenerator generator(options);
+  return generator.run(&console) ? 0 : 1;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+int CommandLine::verifyHighscores(const QStringList &sListArgs) {
+  QTextStream console(stdout);
+  QString sBoardsDir(getSharePath() + "/boards");
+  const int nIndex(sListArgs.indexOf("--verify-scores"));
+  if (nIndex + 1 < sListArgs.size()) {
+    sBoardsDir = sListArgs.at(nIndex + 1);
+  }
+
+  // Highscores are stored by board name without folder
+  QHash<QString, QString> hashBoardFiles;
+  QDirIterator it(sBoardsDir, QStringList() << "*.conf",
+                  QDir::NoDotAndDotDot | QDir::Files,
+                  QDirIterator::Subdirectories);
+  while (it.hasNext()) {
+    it.next();
+    hashBoardFiles.insert(it.fileInfo().baseName(), it.filePath());
+  }
+
+  Highscore highscore;
+  int nVerified(0);
+  int nValid(0);
+  qint64 nElapsed(0);
+  QElapsedTimer timer;
+  foreach (const QString &sBoard, highscore.getBoards()) {
+    // One solver per board, replaying an entry takes microseconds
+    QScopedPointer<Solver> pSolver;
+    const BoardDescriptor descriptor(BoardDescriptor::load(
+                                       hashBoardFiles.value(sBoard)));
+    if (!descriptor.boardPoly.isEmpty() &&
+        descriptor.sInvalidPolygon.isEmpty() &&
+        descriptor.sLattice == Lattice::name()) {
+      pSolver.reset(new Solver(descriptor));
+    }
+
+    for (int i = 1; i <= highscore.getMaxPosition(); i++) {
+      const QStringList sListEntry(highscore.readHighscore(
+                                     sBoard, "Position" + QString::number(i)));
+      if (sListEntry.size() < 3 || "-" == sListEntry.at(2)) {
+        continue;  // Empty position
+      }
+      QString sResult("no move log");
+      if (pSolver.isNull()) {
+        sResult = "board not found";
+      } else if (4 == sListEntry.size()) {
+        const quint32 nSeconds(QTime(0, 0, 0).secsTo(
+                                 QTime::fromString(sListEntry.at(1),
+                                                   "hh:mm:ss")));
+        const QByteArray log(QByteArray::fromBase64(
+                               sListEntry.at(3).toLatin1()));
+        timer.start();
+        const MoveLog::Result result(
+              MoveLog::verify(*pSolver, log, sListEntry.at(2).toUInt(),
+                              nSeconds));
+        nElapsed += timer.nsecsElapsed();
+        nVerified++;
+        if (MoveLog::Valid == result) {
+          nValid++;
+        }
+        sResult = MoveLog::resultName(result);
+      }
+      console << sBoard << " #" << i << " " << sListEntry.at(0) << " "
+              << sListEntry.at(1) << " " << sListEntry.at(2) << ": "
+              << sResult << "\n";
+    }
+  }
+
+  console << "Verified: " << nVerified << ", valid: " << nValid;
+  if (nVerified > 0) {
+    console << " (" << QString::number(nElapsed / 1000.0 / nVerified, 'f', 1)
+            << " us per entry)";
+  }
+  console << "\n";
+  return (nValid == nVerified) ? 0 : 2;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+int CommandLine::analyzeTelemetry(const QStringList &sListArgs) {
+  QString sDir;
+  QString sBoardFilter;
+  int nDays(0);  // 0 = all
+  bool bOk(true);
+  for (int i = sListArgs.indexOf("--telemetry") + 1;
+       bOk && i < sListArgs.size(); i++) {
+    if ("--days" == sListArgs.at(i) && i + 1 < sListArgs.size()) {
+      nDays = sListArgs.at(++i).toInt(&bOk);
+    } else if ("--board" == sListArgs.at(i) && i + 1 < sListArgs.size()) {
+      sBoardFilter = sListArgs.at(++i);
+    } else if (sDir.isEmpty() && !sListArgs.at(i).startsWith("--")) {
+      sDir = sListArgs.at(i);
+    } else {
+      bOk = false;
+    }
+  }
+  if (sDir.isEmpty()) {
+    const QStringList sListPaths(QStandardPaths::standardLocations(
+                                   QStandardPaths::DataLocation));
+    if (!sListPaths.isEmpty()) {
+      sDir = sListPaths.first().toLower() + "/telemetry";
+    }
+  }
+  if (!bOk || nDays < 0 || !QDir(sDir).exists()) {
+    QTextStream(stdout) << "Usage: " << sListArgs.at(0)
+                        << " --telemetry [<folder>] [--days <n>]"
+                           " [--board <name>]\n";
+    return 1;
+  }
+
+  struct Stats {
+    Stats() : nGames(0), nSolved(0), nSolveSeconds(0), nMaxGaps(0) {
+      memset(nEvents, 0, sizeof(nEvents));
+    }
+    quint32 nGames;
+    quint32 nSolved;
+    quint64 nSolveSeconds;
+    quint64 nMaxGaps;  // Sum of the longest pause between two actions
+    quint32 nEvents[Telemetry::EventSolved + 1];
+    QHash<int, QVector<quint32> > hashPieces;  // Piece -> events
+  };
+  struct Game {
+    Game() : bRunning(false), nLastSeconds(0), nMaxGap(0) {}
+    bool bRunning;
+    quint32 nLastSeconds;
+    quint32 nMaxGap;
+  };
+
+  // Days in order, a day may have a compressed and a plain file
+  QList<QDate> listDays;
+  foreach (const QString &sFile,
+           QDir(sDir).entryList(QStringList() << "*.iqtl" << "*.iqtl.z",
+                                QDir::Files, QDir::Name)) {
+    const QDate day(QDate::fromString(sFile.left(10), "yyyy-MM-dd"));
+    if (day.isValid() && !listDays.contains(day)) {
+      listDays << day;
+    }
+  }
+  const QDate firstDay(QDate::currentDate().addDays(1 - nDays));
+  QHash<QString, Stats> hashStats;
+  QHash<QString, Game> hashGames;
+  quint64 nRecords(0);
+  int nFiles(0);
+  QElapsedTimer timer;
+  timer.start();
+  foreach (const QDate &day, listDays) {
+    if (nDays > 0 && day < firstDay) {
+      continue;
+    }
+    QStringList sListBoards;
+    QVector<Telemetry::Record> listRecords;
+    if (!Telemetry::readDay(sDir, day, &sListBoards, &listRecords)) {
+      continue;
+    }
+    nFiles++;
+    nRecords += listRecords.size();
+
+    foreach (const Telemetry::Record &record, listRecords) {
+      const QString sBoard(sListBoards.value(record.nBoard));
+      if (record.nEvent > Telemetry::EventSolved ||
+          (!sBoardFilter.isEmpty() && !sBoard.contains(sBoardFilter))) {
+        continue;
+      }
+      Stats &stats = hashStats[sBoard];
+      Game &game = hashGames[sBoard];
+      stats.nEvents[record.nEvent]++;
+      if (record.nPiece > 0) {
+        QVector<quint32> &listEvents = stats.hashPieces[record.nPiece];
+        if (listEvents.isEmpty()) {
+          listEvents.fill(0, Telemetry::EventSolved + 1);
+        }
+        listEvents[record.nEvent]++;
+      }
+
+      if (Telemetry::EventStart == record.nEvent) {
+        if (game.bRunning) {
+          stats.nMaxGaps += game.nMaxGap;  // Abandoned
+        }
+        stats.nGames++;
+        game = Game();
+        game.bRunning = true;
+        game.nLastSeconds = record.nGameSeconds;
+        continue;
+      }
+      if (!game.bRunning) {
+        continue;  // Started before the first day read
+      }
+      // Game time doesn't run while paused
+      if (record.nGameSeconds > game.nLastSeconds) {
+        game.nMaxGap = qMax(game.nMaxGap,
+                            record.nGameSeconds - game.nLastSeconds);
+      }
+      game.nLastSeconds = record.nGameSeconds;
+      if (Telemetry::EventSolved == record.nEvent) {
+        stats.nSolved++;
+        stats.nSolveSeconds += record.nGameSeconds;
+        stats.nMaxGaps += game.nMaxGap;
+        game.bRunning = false;
+      }
+    }
+  }
+  foreach (const QString &sBoard, hashGames.keys()) {
+    if (hashGames.value(sBoard).bRunning) {
+      hashStats[sBoard].nMaxGaps += hashGames.value(sBoard).nMaxGap;
+    }
+  }
+  const qint64 nReadMsecs(timer.elapsed());
+
+  // Boards where players get stuck longest first
+  QList<QPair<double, QString> > listOrder;
+  foreach (const QString &sBoard, hashStats.keys()) {
+    const Stats &stats = hashStats[sBoard];
+    listOrder << qMakePair(-double(stats.nMaxGaps) / qMax(1u, stats.nGames),
+                           sBoard);
+  }
+  qSort(listOrder);
+
+  QTextStream console(stdout);
+  console << QString("Board").leftJustified(34) << " games" << " solved"
+          << "  avg.time" << "  moves" << " rejected" << "  turns" << "  hints"
+          << " pauses" << "  max.idle\n";
+  for (int i = 0; i < listOrder.size(); i++) {
+    const QString &sBoard(listOrder.at(i).second);
+    const Stats &stats = hashStats[sBoard];
+    const quint32 nGames(qMax(1u, stats.nGames));
+    console << sBoard.leftJustified(34, ' ', true)
+            << QString::number(stats.nGames).rightJustified(6)
+            << QString::number(stats.nSolved).rightJustified(7)
+            << QString::number(stats.nSolved > 0 ?
+                                 stats.nSolveSeconds / stats.nSolved : 0)
+               .rightJustified(9) << "s"
+            << QString::number(double(stats.nEvents[Telemetry::EventMove] +
+                                      stats.nEvents[Telemetry::EventRejected]) /
+                               nGames, 'f', 1).rightJustified(7)
+            << QString::number(stats.nEvents[Telemetry::EventRejected])
+               .rightJustified(9)
+            << QString::number(stats.nEvents[Telemetry::EventRotate] +
+                               stats.nEvents[Telemetry::EventFlip])
+               .rightJustified(7)
+            << QString::number(stats.nEvents[Telemetry::EventHint])
+               .rightJustified(7)
+            << QString::number(stats.nEvents[Telemetry::EventPause])
+               .rightJustified(7)
+            << QString::number(double(stats.nMaxGaps) / nGames, 'f', 0)
+               .rightJustified(9) << "s\n";
+
+    // Pieces of a single board
+    if (!sBoardFilter.isEmpty()) {
+      QList<int> listPieces(stats.hashPieces.keys());
+      qSort(listPieces);
+      foreach (int nPiece, listPieces) {
+        const QVector<quint32> &listEvents = stats.hashPieces[nPiece];
+        console << "  Block " << QString::number(nPiece).leftJustified(4)
+                << " moves " << listEvents.at(Telemetry::EventMove)
+                << ", rejected " << listEvents.at(Telemetry::EventRejected)
+                << ", rotated " << listEvents.at(Telemetry::EventRotate)
+                << ", flipped " << listEvents.at(Telemetry::EventFlip)
+                << ", hints " << listEvents.at(Telemetry::EventHint) << "\n";
+      }
+    }
+  }
+  console << nRecords << " records of " << nFiles << " days read in "
+          << nReadMsecs << " ms\n";
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+int CommandLine::runScript(const QStringList &sListArgs) {
+#if !defined(SCRIPT_SUPPORT)
+  Q_UNUSED(sListArgs);
+  qWarning() << "Scripts need a build with the QtQml module.";
+  return 1;
+#else
+  const int nIndex(sListArgs.indexOf("--script"));
+  if (nIndex + 1 >= sListArgs.size()) {
+    QTextStream(stdout) << "Usage: " << sListArgs.at(0)
+                        << " --script <file.js> [--board <board.conf>]"
+                           " [arguments]\n";
+    return 1;
+  }
+  QFile scriptFile(sListArgs.at(nIndex + 1));
+  if (!scriptFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    qWarning() << "Couldn't open script:" << scriptFile.fileName();
+    return 1;
+  }
+  const QString sScript(QString::fromUtf8(scriptFile.readAll()));
+  scriptFile.close();
+
+  // Declared before the engine, which must not delete it
+  ScriptBoard board;
+  QJSEngine engine;
+  QQmlEngine::setObjectOwnership(&board, QQmlEngine::CppOwnership);
+#if QT_VERSION >= 0x050600
+  engine.installExtensions(QJSEngine::ConsoleExtension);  // print, console
+#endif
+
+  QStringList sListScriptArgs;
+  for (int i = nIndex + 2; i < sListArgs.size(); i++) {
+    if ("--board" == sListArgs.at(i) && i + 1 < sListArgs.size()) {
+      if (!board.load(sListArgs.at(++i))) {
+        return 1;
+      }
+    } else {
+      sListScriptArgs << sListArgs.at(i);
+    }
+  }
+  QJSValue args(engine.newArray(sListScriptArgs.size()));
+  for (int i = 0; i < sListScriptArgs.size(); i++) {
+    args.setProperty(i, sListScriptArgs.at(i));
+  }
+  engine.globalObject().setProperty("board", engine.newQObject(&board));
+  engine.globalObject().setProperty("args", args);
+
+  QElapsedTimer timer;
+  timer.start();
+  const QJSValue result(engine.evaluate(sScript, scriptFile.fileName()));
+  const qint64 nElapsed(qMax(Q_INT64_C(1), timer.elapsed()));
+  if (result.isError()) {
+    qWarning() << scriptFile.fileName() + ":" +
+                  result.property("lineNumber").toString() + ":"
+               << result.toString();
+    return 2;
+  }
+  QTextStream(stdout) << board.getCalls() << " board calls in " << nElapsed
+                      << " ms (" << board.getCalls() * 1000 / nElapsed
+                      << " per second)\n";
+  return 0;
+#endif  // SCRIPT_SUPPORT
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+void CommandLine::printSolution(const Solver &solver,
+                                const QList<Solver::Placement> &listSolution,
+                                QTextStream *pOut) {
+  const QString sChars("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz");
+  QHash<Voxel, QChar> hashCells;
+  if (solver.getCells().isEmpty()) {
+    return;
+  }
+  Voxel minimum(solver.getCells().first());
+  Voxel maximum(minimum);
+
+  foreach (const Voxel &v, solver.getCells()) {
+    hashCells[v] = '.';
+    minimum = Voxel(qMin(minimum.x, v.x), qMin(minimum.y, v.y),
+                    qMin(minimum.z, v.z));
+    maximum = Voxel(qMax(maximum.x, v.x), qMax(maximum.y, v.y),
+                    qMax(maximum.z, v.z));
+  }
+  foreach (const Solver::Placement &placement, listSolution) {
+    const QChar c(sChars.at(placement.nPiece % sChars.size()));
+    foreach (const Voxel &v, placement.listCells) {
+      hashCells[v] = c;
+    }
+  }
+
+  // One grid per layer, bottom layer first
+  for (int z = minimum.z; z <= maximum.z; z++) {
+    if (solver.is3D()) {
+      *pOut << "Layer " << (z + 1) << ":\n";
+    }
+    for (int y = minimum.y; y <= maximum.y; y++) {
+      for (int x = minimum.x; x <= maximum.x; x++) {
+        *pOut << hashCells.value(Voxel(x, y, z), ' ');
+      }
+      *pOut << "\n";
+    }
+  }
+}
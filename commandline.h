@@ -0,0 +1,74 @@
+/**
+ * \file commandline.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the headless command line tools.
+ */
+
+#ifndef COMMANDLINE_H_
+#define COMMANDLINE_H_
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "./solver.h"
+
+class QTextStream;
+
+/**
+ * \class CommandLine
+ * \brief Headless command line tools (--solve, --rank, --daemon, ...).
+ *
+ * Each tool is one {flag, handler} entry of a table. main() looks up the
+ * flag before any GUI is created and runs the handler with a
+ * QCoreApplication, so the tools work without a display.
+ */
+class CommandLine {
+ public:
+    typedef int (*Handler)(const QStringList &sListArgs);
+
+    static Handler findHandler(int argc, char *argv[]);
+    static QString getSharePath();
+
+ private:
+    struct Command {
+      const char *sFlag;
+      Handler handler;
+    };
+    static const Command COMMANDS[];
+
+    static int solveBoard(const QStringList &sListArgs);
+    static int rankBoards(const QStringList &sListArgs);
+    static int benchmarkBoards(const QStringList &sListArgs);
+    static int runDaemon(const QStringList &sListArgs);
+    static int runServer(const QStringList &sListArgs);
+    static int runLoadGenerator(const QStringList &sListArgs);
+    static int verifyHighscores(const QStringList &sListArgs);
+    static int analyzeTelemetry(const QStringList &sListArgs);
+    static int runScript(const QStringList &sListArgs);
+    static void printSolution(const Solver &solver,
+                              const QList<Solver::Placement> &listSolution,
+                              QTextStream *pOut);
+};
+
+#endif  // COMMANDLINE_H_
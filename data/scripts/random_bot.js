@@ -0,0 +1,46 @@
+// Random bot for iqpuzzle --script, e.g.
+//   iqpuzzle --script data/scripts/random_bot.js --board <board.conf> [games]
+// Places a random fitting placement of a random piece, takes the last
+// piece back if a piece doesn't fit anywhere. Gives up a game after a
+// fixed number of steps.
+
+var nGames = args.length > 0 ? parseInt(args[0], 10) : 100;
+var nMaxSteps = 10000;
+var nPieces = board.pieceCount();
+var nSolved = 0;
+var nSteps = 0;
+
+function randomInt(n) {
+  return Math.floor(Math.random() * n);
+}
+
+for (var game = 0; game < nGames; game++) {
+  board.reset();
+  var listPlaced = [];
+  for (var step = 0; step < nMaxSteps && !board.isSolved(); step++) {
+    nSteps++;
+    var listFree = [];
+    for (var i = 0; i < nPieces; i++) {
+      if (board.row(i) < 0) {
+        listFree.push(i);
+      }
+    }
+    if (listFree.length === 0) {
+      break;  // All placed, but not solved (NotAllPiecesNeeded)
+    }
+    var nPiece = listFree[randomInt(listFree.length)];
+    var listRows = board.legalPlacements(nPiece);
+    if (listRows.length > 0) {
+      board.place(nPiece, listRows[randomInt(listRows.length)]);
+      listPlaced.push(nPiece);
+    } else if (listPlaced.length > 0) {
+      board.remove(listPlaced.pop());
+    }
+  }
+  if (board.isSolved()) {
+    nSolved++;
+  }
+}
+
+console.log(nSolved + " of " + nGames + " games solved, " + nSteps +
+            " steps");
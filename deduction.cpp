@@ -0,0 +1,319 @@
+/**
+ * \file deduction.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Logical deduction of forced moves.
+ */
+
+#include "./deduction.h"
+
+#include "./lattice.h"
+
+Deduction::Deduction(const BoardDescriptor &descriptor)
+  : m_Solver(descriptor),
+    m_bAllPiecesNeeded(m_Solver.isAllPiecesNeeded()),
+    m_bConflict(false) {
+  const QVector<Voxel> &listCells = m_Solver.getCells();
+  const QList<Solver::Placement> &listPlacements = m_Solver.getPlacements();
+  const int nCells(listCells.size());
+  const int nPieces(m_Solver.getNumOfPieces());
+
+  m_listCellRows.resize(nCells);
+  m_listPieceRows.resize(nPieces);
+  m_listPieceSize.fill(0, nPieces);
+  for (int nRow = 0; nRow < listPlacements.size(); nRow++) {
+    foreach (int nCell, m_Solver.getRowCells(nRow)) {
+      m_listCellRows[nCell] << nRow;
+    }
+    const Solver::Placement &placement = listPlacements.at(nRow);
+    m_listPieceRows[placement.nPiece] << nRow;
+    m_listPieceSize[placement.nPiece] = placement.listCells.size();
+  }
+
+  m_listNeighbours.resize(nCells);
+  for (int c = 0; c < nCells; c++) {
+    const Voxel &v = listCells.at(c);
+    QList<Voxel> listAdjacent;
+    foreach (const QPoint &p, Lattice::neighbours(QPoint(v.x, v.y))) {
+      listAdjacent << Voxel(p.x(), p.y(), v.z);
+    }
+    if (m_Solver.is3D()) {
+      listAdjacent << Voxel(v.x, v.y, v.z - 1) << Voxel(v.x, v.y, v.z + 1);
+    }
+    foreach (const Voxel &adjacent, listAdjacent) {
+      const int nCell(m_Solver.getCellIndex(adjacent));
+      if (nCell >= 0) {
+        m_listNeighbours[c] << nCell;
+      }
+    }
+  }
+
+  // Empty board: all placements possible
+  m_listBlockers.fill(0, listPlacements.size());
+  m_listCellLive.resize(nCells);
+  for (int c = 0; c < nCells; c++) {
+    m_listCellLive[c] = m_listCellRows.at(c).size();
+  }
+  m_listPieceLive.resize(nPieces);
+  for (int p = 0; p < nPieces; p++) {
+    m_listPieceLive[p] = m_listPieceRows.at(p).size();
+  }
+  m_listCellUsed.fill(0, nCells);
+  m_listPieceUsed.fill(0, nPieces);
+
+  m_Conflict.nRow = -1;
+  m_Conflict.reason = OnlyPlacementOfCell;
+  m_Conflict.nCell = -1;
+  m_Conflict.nPiece = -1;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool Deduction::update(const QList<Solver::Placement> &listPlaced) {
+  // Pieces which are not completely on the board are ignored
+  QList<int> listRows;
+  foreach (const Solver::Placement &placement, listPlaced) {
+    const int nRow(m_Solver.findPlacement(placement.nPiece,
+                                          placement.listCells));
+    if (nRow >= 0) {
+      listRows << nRow;
+    }
+  }
+  foreach (int nRow, m_listPlaced) {
+    if (!listRows.contains(nRow)) {
+      this->place(nRow, -1);
+    }
+  }
+  foreach (int nRow, listRows) {
+    if (!m_listPlaced.contains(nRow)) {
+      this->place(nRow, 1);
+    }
+  }
+  m_listPlaced = listRows;
+
+  // Forced moves are assumed until no rule applies (each uses a piece)
+  m_listForced.clear();
+  m_bConflict = false;
+  m_Conflict.nRow = -1;
+  m_Conflict.nCell = -1;
+  m_Conflict.nPiece = -1;
+  while (this->deduceStep()) {
+    // Rules apply again with the assumed move
+  }
+  for (int i = m_listAssumed.size() - 1; i >= 0; i--) {
+    this->place(m_listAssumed.at(i), -1);
+  }
+  m_listAssumed.clear();
+  return !m_bConflict;
+}
+
+const QList<Deduction::Move> &Deduction::getForcedMoves() const {
+  return m_listForced;
+}
+
+const Deduction::Move &Deduction::getConflict() const {
+  return m_Conflict;
+}
+
+const Solver &Deduction::getSolver() const {
+  return m_Solver;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void Deduction::place(const int nRow, const int nDelta) {
+  // A piece on the board blocks all placements sharing a cell or the piece
+  foreach (int nCell, m_Solver.getRowCells(nRow)) {
+    m_listCellUsed[nCell] += nDelta;
+    foreach (int nBlocked, m_listCellRows.at(nCell)) {
+      this->block(nBlocked, nDelta);
+    }
+  }
+  const int nPiece(m_Solver.getPlacements().at(nRow).nPiece);
+  m_listPieceUsed[nPiece] += nDelta;
+  foreach (int nBlocked, m_listPieceRows.at(nPiece)) {
+    this->block(nBlocked, nDelta);
+  }
+}
+
+void Deduction::block(const int nRow, const int nDelta) {
+  const int nBefore(m_listBlockers.at(nRow));
+  m_listBlockers[nRow] += nDelta;
+  if (0 != nBefore && 0 != m_listBlockers.at(nRow)) {
+    return;  // Still blocked
+  }
+  const int nLive((0 == nBefore) ? -1 : 1);
+  foreach (int nCell, m_Solver.getRowCells(nRow)) {
+    m_listCellLive[nCell] += nLive;
+  }
+  m_listPieceLive[m_Solver.getPlacements().at(nRow).nPiece] += nLive;
+}
+
+int Deduction::liveRow(const QVector<int> &listRows) const {
+  foreach (int nRow, listRows) {
+    if (0 == m_listBlockers.at(nRow)) {
+      return nRow;
+    }
+  }
+  return -1;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool Deduction::deduceStep() {
+  // Conflicts are searched first, then the first forced move is assumed.
+  // Returns true, if a move was assumed.
+  Move forced;
+  forced.nRow = -1;
+  for (int c = 0; c < m_listCellLive.size(); c++) {
+    if (m_listCellUsed.at(c) > 0) {
+      continue;
+    }
+    if (0 == m_listCellLive.at(c)) {
+      this->setConflict(OnlyPlacementOfCell, c, -1);
+      return false;
+    }
+    if (1 == m_listCellLive.at(c) && forced.nRow < 0) {
+      forced.nRow = this->liveRow(m_listCellRows.at(c));
+      forced.reason = OnlyPlacementOfCell;
+      forced.nCell = c;
+    }
+  }
+
+  if (m_bAllPiecesNeeded) {
+    for (int p = 0; p < m_listPieceLive.size(); p++) {
+      if (m_listPieceUsed.at(p) > 0) {
+        continue;
+      }
+      if (0 == m_listPieceLive.at(p)) {
+        this->setConflict(OnlyPlacementOfPiece, -1, p);
+        return false;
+      }
+      if (1 == m_listPieceLive.at(p) && forced.nRow < 0) {
+        forced.nRow = this->liveRow(m_listPieceRows.at(p));
+        forced.reason = OnlyPlacementOfPiece;
+        forced.nCell = -1;
+      }
+    }
+  }
+
+  if (!this->checkPockets(&forced)) {
+    return false;
+  }
+  if (forced.nRow < 0) {
+    return false;
+  }
+  forced.nPiece = m_Solver.getPlacements().at(forced.nRow).nPiece;
+  m_listForced << forced;
+  this->place(forced.nRow, 1);
+  m_listAssumed << forced.nRow;
+  return true;
+}
+
+bool Deduction::checkPockets(Move *pForced) {
+  // Pieces are connected, so placements covering a cell of a pocket (area
+  // of connected free cells) lie completely inside of it
+  int nMinSize(m_listCellLive.size() + 1);
+  for (int p = 0; p < m_listPieceLive.size(); p++) {
+    if (0 == m_listPieceUsed.at(p) && m_listPieceLive.at(p) > 0) {
+      nMinSize = qMin(nMinSize, m_listPieceSize.at(p));
+    }
+  }
+
+  QVector<bool> bVisited(m_listCellLive.size(), false);
+  for (int nStart = 0; nStart < m_listCellLive.size(); nStart++) {
+    if (m_listCellUsed.at(nStart) > 0 || bVisited.at(nStart)) {
+      continue;
+    }
+    QList<int> listPocket;
+    listPocket << nStart;
+    bVisited[nStart] = true;
+    for (int i = 0; i < listPocket.size(); i++) {
+      foreach (int nCell, m_listNeighbours.at(listPocket.at(i))) {
+        if (0 == m_listCellUsed.at(nCell) && !bVisited.at(nCell)) {
+          bVisited[nCell] = true;
+          listPocket << nCell;
+        }
+      }
+    }
+
+    if (!this->isSumOfSizes(listPocket.size())) {
+      this->setConflict(OnlyPlacementOfPocket, nStart, -1);
+      return false;
+    }
+    // Smaller than two pieces: exactly one placement has to fill it
+    if (listPocket.size() < 2 * nMinSize) {
+      int nFill(-1);
+      int nCount(0);
+      foreach (int nRow, m_listCellRows.at(nStart)) {
+        if (0 == m_listBlockers.at(nRow) &&
+            m_Solver.getRowCells(nRow).size() == listPocket.size()) {
+          nFill = nRow;
+          nCount++;
+        }
+      }
+      if (0 == nCount) {
+        this->setConflict(OnlyPlacementOfPocket, nStart, -1);
+        return false;
+      }
+      if (1 == nCount && pForced->nRow < 0) {
+        pForced->nRow = nFill;
+        pForced->reason = OnlyPlacementOfPocket;
+        pForced->nCell = nStart;
+      }
+    }
+  }
+  return true;
+}
+
+bool Deduction::isSumOfSizes(const int nArea) const {
+  // Subset sum of the remaining pieces
+  QVector<bool> bReachable(nArea + 1, false);
+  bReachable[0] = true;
+  for (int p = 0; p < m_listPieceSize.size(); p++) {
+    const int nSize(m_listPieceSize.at(p));
+    if (m_listPieceUsed.at(p) > 0 || 0 == m_listPieceLive.at(p) ||
+        nSize <= 0) {
+      continue;
+    }
+    for (int n = nArea; n >= nSize; n--) {
+      if (bReachable.at(n - nSize)) {
+        bReachable[n] = true;
+      }
+    }
+  }
+  return bReachable.at(nArea);
+}
+
+// ---------------------------------------------------------------------------
+
+void Deduction::setConflict(const Reason reason, const int nCell,
+                            const int nPiece) {
+  m_bConflict = true;
+  m_Conflict.nRow = -1;
+  m_Conflict.reason = reason;
+  m_Conflict.nCell = nCell;
+  m_Conflict.nPiece = nPiece;
+}
@@ -0,0 +1,98 @@
+/**
+ * \file deduction.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the logical deduction of forced moves.
+ */
+
+#ifndef DEDUCTION_H_
+#define DEDUCTION_H_
+
+#include <QList>
+#include <QVector>
+
+#include "./boarddescriptor.h"
+#include "./solver.h"
+
+/**
+ * \class Deduction
+ * \brief Forced moves of a game state, found by simple propagation rules.
+ *
+ * Explains hints without search: a free cell covered by only one possible
+ * placement, a piece with only one legal placement left, or a pocket of
+ * free cells which only one placement fills, forces that placement. Each
+ * forced move is assumed and the rules run again until nothing changes.
+ * A free cell, piece or pocket without any possibility is a conflict.
+ *
+ * Possible placements are tracked incrementally by counting what blocks
+ * them, so an update after moving one piece only touches its placements.
+ */
+class Deduction {
+ public:
+    enum Reason {
+      OnlyPlacementOfCell,  // nCell is covered by this placement only
+      OnlyPlacementOfPiece,  // Piece fits nowhere else
+      OnlyPlacementOfPocket  // Pocket of nCell fits exactly this placement
+    };
+
+    struct Move {
+      int nRow;  // Placement of the solver, -1 for a conflict
+      Reason reason;
+      int nCell;  // Cell of the solver, -1 if the reason is the piece
+      int nPiece;
+    };
+
+    explicit Deduction(const BoardDescriptor &descriptor);
+
+    bool update(const QList<Solver::Placement> &listPlaced);
+    const QList<Move> &getForcedMoves() const;
+    const Move &getConflict() const;
+    const Solver &getSolver() const;
+
+ private:
+    void place(const int nRow, const int nDelta);
+    void block(const int nRow, const int nDelta);
+    int liveRow(const QVector<int> &listRows) const;
+    bool deduceStep();
+    bool checkPockets(Move *pForced);
+    bool isSumOfSizes(const int nArea) const;
+    void setConflict(const Reason reason, const int nCell, const int nPiece);
+
+    const Solver m_Solver;
+    const bool m_bAllPiecesNeeded;
+    QVector<QVector<int> > m_listCellRows;  // Placements covering a cell
+    QVector<QVector<int> > m_listPieceRows;
+    QVector<QVector<int> > m_listNeighbours;  // Adjacent cells
+    QVector<int> m_listPieceSize;
+    QVector<int> m_listBlockers;  // Per row: occupied cells + used piece
+    QVector<int> m_listCellLive;  // Possible placements per cell
+    QVector<int> m_listPieceLive;
+    QVector<int> m_listCellUsed;  // Pieces covering a cell
+    QVector<int> m_listPieceUsed;
+    QList<int> m_listPlaced;  // Rows of the pieces on the board
+    QList<int> m_listAssumed;  // Forced rows during the deduction
+    QList<Move> m_listForced;
+    Move m_Conflict;
+    bool m_bConflict;
+};
+
+#endif  // DEDUCTION_H_
@@ -0,0 +1,753 @@
+/**
+ * \file exactcover.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Exact cover solver (dancing links), shared by 2D and 3D boards.
+ */
+
+#include "./exactcover.h"
+
+#include <limits.h>
+
+#include <QDebug>
+#include <QFuture>
+#include <QThread>
+#include <QThreadPool>
+#include <QtAlgorithms>
+#include <QtConcurrentRun>
+
+ExactCover::ExactCover(const int nPrimary, const int nSecondary)
+  : m_nPrimary(nPrimary),
+    m_nColumns(nPrimary + nSecondary),
+    m_nRows(0),
+    m_nNodes(0),
+    m_nKey(TranspositionTable::matrixKey()),
+    m_bNoSolution(false),
+    m_nColourings(0),
+    m_nFirstGroup(0),
+    m_nReachOffset(0),
+    m_bParity(false) {
+  m_Nodes.resize(m_nColumns + 1);
+  m_nColSize.fill(0, m_nColumns + 1);
+  m_listColumnKeys.reserve(m_nColumns + 1);
+
+  for (int c = 0; c <= m_nColumns; c++) {
+    Node &node = m_Nodes[c];
+    node.nUp = c;
+    node.nDown = c;
+    node.nColumn = c;
+    node.nRow = -1;
+    m_listColumnKeys << TranspositionTable::columnKey(c);
+    if (c <= m_nPrimary) {  // Root and primary columns are linked
+      node.nLeft = (0 == c) ? m_nPrimary : c - 1;
+      node.nRight = (m_nPrimary == c) ? 0 : c + 1;
+    } else {  // Secondary columns are never chosen
+      node.nLeft = c;
+      node.nRight = c;
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+int ExactCover::addRow(const QVector<int> &listColumns) {
+  // New rows are only linked correctly into an uncovered matrix
+  this->fixRows(QList<int>());
+  m_listLastSolution.clear();
+  m_bNoSolution = false;
+  int nFirst(-1);
+
+  foreach (int nCol, listColumns) {
+    if (nCol < 0 || nCol >= m_nColumns) {
+      qWarning() << "Exact cover column out of range:" << nCol;
+      continue;
+    }
+    const int nHeader(nCol + 1);
+    const int n(m_Nodes.size());
+    Node node;
+    node.nColumn = nHeader;
+    node.nRow = m_nRows;
+    node.nDown = nHeader;
+    node.nUp = m_Nodes[nHeader].nUp;
+    if (nFirst < 0) {
+      nFirst = n;
+      node.nLeft = n;
+      node.nRight = n;
+    } else {
+      node.nRight = nFirst;
+      node.nLeft = m_Nodes[nFirst].nLeft;
+    }
+    m_Nodes.append(node);
+
+    m_Nodes[node.nUp].nDown = n;
+    m_Nodes[nHeader].nUp = n;
+    if (nFirst != n) {
+      m_Nodes[node.nLeft].nRight = n;
+      m_Nodes[nFirst].nLeft = n;
+    }
+    m_nColSize[nHeader]++;
+  }
+
+  m_nRowNode << nFirst;
+  return m_nRows++;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void ExactCover::cover(const int nCol) {
+  Node *p = m_Nodes.data();
+  m_nKey ^= m_listColumnKeys[nCol];
+  p[p[nCol].nRight].nLeft = p[nCol].nLeft;
+  p[p[nCol].nLeft].nRight = p[nCol].nRight;
+  for (int i = p[nCol].nDown; i != nCol; i = p[i].nDown) {
+    for (int j = p[i].nRight; j != i; j = p[j].nRight) {
+      p[p[j].nDown].nUp = p[j].nUp;
+      p[p[j].nUp].nDown = p[j].nDown;
+      m_nColSize[p[j].nColumn]--;
+    }
+  }
+}
+
+void ExactCover::uncover(const int nCol) {
+  Node *p = m_Nodes.data();
+  for (int i = p[nCol].nUp; i != nCol; i = p[i].nUp) {
+    for (int j = p[i].nLeft; j != i; j = p[j].nLeft) {
+      m_nColSize[p[j].nColumn]++;
+      p[p[j].nDown].nUp = j;
+      p[p[j].nUp].nDown = j;
+    }
+  }
+  p[p[nCol].nRight].nLeft = nCol;
+  p[p[nCol].nLeft].nRight = nCol;
+  m_nKey ^= m_listColumnKeys[nCol];
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+int ExactCover::chooseColumn() const {
+  // Minimum remaining values: column with fewest rows, 0 if all covered
+  int nBest(0);
+  int nMin(INT_MAX);
+  for (int c = m_Nodes[0].nRight; c != 0; c = m_Nodes[c].nRight) {
+    if (m_nColSize[c] < nMin) {
+      nMin = m_nColSize[c];
+      nBest = c;
+      if (0 == nMin) {
+        break;
+      }
+    }
+  }
+  return nBest;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void ExactCover::setColourings(const QList<QVector<int> > &listWeights,
+                               const int nFirstGroup) {
+  // Has to be called after all rows were added
+  const int nHeaders(m_nColumns + 1);
+  m_nFirstGroup = nFirstGroup + 1;
+  m_nColourings = 0;
+  m_listColumnWeights.clear();
+  m_listRowBits.clear();
+  int nMaxRange(0);
+
+  foreach (const QVector<int> &listColumnWeights, listWeights) {
+    QVector<int> listHeaderWeights(nHeaders, 0);
+    for (int c = 0; c < m_nColumns && c < listColumnWeights.size(); c++) {
+      listHeaderWeights[c + 1] = listColumnWeights.at(c);
+    }
+
+    // Weight of each row without its group column, at most one group
+    QVector<int> listBits(m_nRows, 0);
+    QVector<int> listMaxAbs(nHeaders, 0);
+    for (int nRow = 0; nRow < m_nRows; nRow++) {
+      const int nFirst(m_nRowNode[nRow]);
+      if (nFirst < 0) {
+        continue;
+      }
+      int nWeight(0);
+      int nGroup(0);
+      int j(nFirst);
+      do {
+        if (m_Nodes[j].nColumn < m_nFirstGroup) {
+          nWeight += listHeaderWeights[m_Nodes[j].nColumn];
+        } else if (0 == nGroup) {
+          nGroup = m_Nodes[j].nColumn;
+        } else {
+          qWarning() << "Exact cover row in two groups, no parity pruning.";
+          return;
+        }
+        j = m_Nodes[j].nRight;
+      } while (j != nFirst);
+      if (0 == nGroup) {
+        qWarning() << "Exact cover row without group, no parity pruning.";
+        return;
+      }
+      if (nWeight < -32 || nWeight >= 32) {
+        qWarning() << "Exact cover row weight out of range:" << nWeight;
+        return;
+      }
+      listBits[nRow] = nWeight + 32;
+      listMaxAbs[nGroup] = qMax(listMaxAbs.at(nGroup), qAbs(nWeight));
+    }
+
+    // Sums of all groups are within +-range
+    int nRange(0);
+    foreach (int nMaxAbs, listMaxAbs) {
+      nRange += nMaxAbs;
+    }
+    nMaxRange = qMax(nMaxRange, nRange);
+    m_listColumnWeights += listHeaderWeights;
+    m_listRowBits += listBits;
+  }
+
+  m_nColourings = listWeights.size();
+  m_nReachOffset = nMaxRange;
+  m_listReach.fill(0, (2 * nMaxRange + 1 + 63) / 64);
+  m_listNext = m_listReach;
+}
+
+void ExactCover::setParityPruning(const bool bEnabled) {
+  m_bParity = bEnabled;
+}
+
+// ---------------------------------------------------------------------------
+
+bool ExactCover::isFeasible() {
+  // Weight of the free cells has to be a sum of one row weight per group
+  if (!m_bParity || 0 == m_nColourings) {
+    return true;
+  }
+  const Node *p = m_Nodes.constData();
+  const int nHeaders(m_nColumns + 1);
+  for (int k = 0; k < m_nColourings; k++) {
+    const int *pWeights = m_listColumnWeights.constData() + k * nHeaders;
+    const int *pBits = m_listRowBits.constData() + k * m_nRows;
+    m_listReach.fill(0);
+    m_listReach[m_nReachOffset >> 6] = Q_UINT64_C(1) << (m_nReachOffset & 63);
+
+    int nSum(0);
+    for (int c = p[0].nRight; c != 0; c = p[c].nRight) {
+      if (c < m_nFirstGroup) {
+        nSum += pWeights[c];
+      } else {
+        this->addGroup(this->signature(c, pBits), false);
+      }
+    }
+    // Secondary groups (pieces not needed) may be used or not. Rows of a
+    // covered column are unlinked from their other columns.
+    for (int c = qMax(m_nFirstGroup, m_nPrimary + 1); c <= m_nColumns; c++) {
+      const int i(p[c].nDown);
+      const int j(p[i].nRight);
+      if (i != c && p[p[j].nUp].nDown == j) {
+        this->addGroup(this->signature(c, pBits), true);
+      }
+    }
+
+    const int nBit(nSum + m_nReachOffset);
+    if (nBit < 0 || nBit >= m_listReach.size() * 64 ||
+        0 == (m_listReach.at(nBit >> 6) & (Q_UINT64_C(1) << (nBit & 63)))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+quint64 ExactCover::signature(const int nCol, const int *pBits) const {
+  // Weights of the rows still in the column
+  const Node *p = m_Nodes.constData();
+  quint64 nSignature(0);
+  for (int i = p[nCol].nDown; i != nCol; i = p[i].nDown) {
+    nSignature |= Q_UINT64_C(1) << pBits[p[i].nRow];
+  }
+  return nSignature;
+}
+
+void ExactCover::addGroup(const quint64 nSignature, const bool bOptional) {
+  // Reachable sums shifted by each row weight of the group
+  const int nWords(m_listReach.size());
+  const quint64 *pReach = m_listReach.constData();
+  quint64 *pNext = m_listNext.data();
+  for (int i = 0; i < nWords; i++) {
+    pNext[i] = bOptional ? pReach[i] : 0;
+  }
+  for (int b = 0; b < 64; b++) {
+    if (0 == (nSignature & (Q_UINT64_C(1) << b))) {
+      continue;
+    }
+    const int nShift(b - 32);
+    const int nWordShift(nShift >= 0 ? nShift / 64 : -((63 - nShift) / 64));
+    const int nBitShift(nShift - nWordShift * 64);
+    for (int i = 0; i < nWords; i++) {
+      const int nSrc(i - nWordShift);
+      if (nSrc >= 0 && nSrc < nWords) {
+        pNext[i] |= pReach[nSrc] << nBitShift;
+      }
+      if (nBitShift > 0 && nSrc >= 1 && nSrc - 1 < nWords) {
+        pNext[i] |= pReach[nSrc - 1] >> (64 - nBitShift);
+      }
+    }
+  }
+  m_listReach.swap(m_listNext);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+quint64 ExactCover::search() {
+  m_nNodes++;
+  const int nCol(this->chooseColumn());
+  if (0 == nCol) {
+    return 1;
+  }
+  if (0 == m_nColSize[nCol]) {
+    return 0;
+  }
+
+  // Same covered columns: same free cells and remaining pieces
+  quint64 nCount(0);
+  if (!m_pTable.isNull() && m_pTable->lookup(m_nKey, &nCount)) {
+    return nCount;
+  }
+  if (!this->isFeasible()) {
+    return 0;
+  }
+  const quint64 nKey(m_nKey);
+  this->cover(nCol);
+  for (int r = m_Nodes[nCol].nDown; r != nCol; r = m_Nodes[r].nDown) {
+    for (int j = m_Nodes[r].nRight; j != r; j = m_Nodes[j].nRight) {
+      this->cover(m_Nodes[j].nColumn);
+    }
+    nCount += this->search();
+    for (int j = m_Nodes[r].nLeft; j != r; j = m_Nodes[j].nLeft) {
+      this->uncover(m_Nodes[j].nColumn);
+    }
+  }
+  this->uncover(nCol);
+  if (!m_pTable.isNull()) {
+    m_pTable->store(nKey, nCount);
+  }
+  return nCount;
+}
+
+// ---------------------------------------------------------------------------
+
+bool ExactCover::searchFirst(QList<int> *pListRows) {
+  m_nNodes++;
+  const int nCol(this->chooseColumn());
+  if (0 == nCol) {
+    return true;
+  }
+  if (0 == m_nColSize[nCol] || !this->isFeasible()) {
+    return false;
+  }
+
+  bool bFound(false);
+  this->cover(nCol);
+  for (int r = m_Nodes[nCol].nDown; r != nCol && !bFound;
+       r = m_Nodes[r].nDown) {
+    pListRows->append(m_Nodes[r].nRow);
+    for (int j = m_Nodes[r].nRight; j != r; j = m_Nodes[j].nRight) {
+      this->cover(m_Nodes[j].nColumn);
+    }
+    bFound = this->searchFirst(pListRows);
+    for (int j = m_Nodes[r].nLeft; j != r; j = m_Nodes[j].nLeft) {
+      this->uncover(m_Nodes[j].nColumn);
+    }
+    if (!bFound) {
+      pListRows->removeLast();
+    }
+  }
+  this->uncover(nCol);
+  return bFound;
+}
+
+// ---------------------------------------------------------------------------
+
+void ExactCover::searchAll(QVector<int> *pStack, QVector<int> *pListRows,
+                           quint64 *pFound, const quint64 nLimit) {
+  m_nNodes++;
+  const int nCol(this->chooseColumn());
+  if (0 == nCol) {
+    (*pFound)++;
+    if (*pFound <= nLimit) {
+      *pListRows += *pStack;
+      pListRows->append(-1);
+    }
+    return;
+  }
+  if (0 == m_nColSize[nCol] || !this->isFeasible()) {
+    return;
+  }
+
+  this->cover(nCol);
+  for (int r = m_Nodes[nCol].nDown; r != nCol && *pFound <= nLimit;
+       r = m_Nodes[r].nDown) {
+    pStack->append(m_Nodes[r].nRow);
+    for (int j = m_Nodes[r].nRight; j != r; j = m_Nodes[j].nRight) {
+      this->cover(m_Nodes[j].nColumn);
+    }
+    this->searchAll(pStack, pListRows, pFound, nLimit);
+    for (int j = m_Nodes[r].nLeft; j != r; j = m_Nodes[j].nLeft) {
+      this->uncover(m_Nodes[j].nColumn);
+    }
+    pStack->removeLast();
+  }
+  this->uncover(nCol);
+}
+
+// ---------------------------------------------------------------------------
+
+int ExactCover::searchZdd(Zdd *pZdd, QByteArray *pCovered,
+                          QHash<QByteArray, int> *pMemo,
+                          const int nMaxNodes) {
+  // First uncovered column (not the smallest one), so rows of deeper
+  // levels always start at a later column: the diagram stays ordered
+  m_nNodes++;
+  const int nCol(m_Nodes[0].nRight);
+  if (0 == nCol) {
+    return Zdd::BASE;
+  }
+  if (0 == m_nColSize[nCol] || !this->isFeasible()) {
+    return Zdd::EMPTY;
+  }
+  const QByteArray key(*pCovered);
+  const int nKnown(pMemo->value(key, -1));
+  if (nKnown >= 0) {
+    return nKnown;
+  }
+
+  // Bottom up, the rows below are the lo branch of each row
+  int nFamily(Zdd::EMPTY);
+  this->cover(nCol);
+  for (int r = m_Nodes[nCol].nUp; r != nCol && nFamily >= 0;
+       r = m_Nodes[r].nUp) {
+    for (int j = m_Nodes[r].nRight; j != r; j = m_Nodes[j].nRight) {
+      this->cover(m_Nodes[j].nColumn);
+    }
+    this->toggleCovered(pCovered, r);
+    const int nSub(this->searchZdd(pZdd, pCovered, pMemo, nMaxNodes));
+    this->toggleCovered(pCovered, r);
+    for (int j = m_Nodes[r].nLeft; j != r; j = m_Nodes[j].nLeft) {
+      this->uncover(m_Nodes[j].nColumn);
+    }
+
+    if (nSub < 0 || pZdd->getNumOfNodes() > nMaxNodes ||
+        pMemo->size() > nMaxNodes) {
+      nFamily = -1;  // Too large, abort
+    } else {
+      nFamily = pZdd->addNode(m_Nodes[r].nRow, nFamily, nSub);
+    }
+  }
+  this->uncover(nCol);
+
+  if (nFamily >= 0) {
+    pMemo->insert(key, nFamily);
+  }
+  return nFamily;
+}
+
+void ExactCover::toggleCovered(QByteArray *pCovered,
+                               const int nRowNode) const {
+  char *pBits = pCovered->data();
+  int j(nRowNode);
+  do {
+    const int nCol(m_Nodes[j].nColumn);
+    pBits[nCol >> 3] ^= char(1 << (nCol & 7));
+    j = m_Nodes[j].nRight;
+  } while (j != nRowNode);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool ExactCover::fixRows(const QList<int> &listRows) {
+  // Fixed rows must not share a column, otherwise covering breaks the links
+  // (links within a row are never changed, even if the row is covered)
+  QVector<bool> bUsed(m_nColumns + 1, false);
+  foreach (int nRow, listRows) {
+    if (nRow < 0 || nRow >= m_nRows || m_nRowNode[nRow] < 0) {
+      return false;
+    }
+    const int nFirst(m_nRowNode[nRow]);
+    int j(nFirst);
+    do {
+      if (bUsed[m_Nodes[j].nColumn]) {
+        return false;
+      }
+      bUsed[m_Nodes[j].nColumn] = true;
+      j = m_Nodes[j].nRight;
+    } while (j != nFirst);
+  }
+
+  // Keep the rows up to the first one which isn't fixed any longer,
+  // release the others in reverse order and cover the new ones
+  int nKeep(0);
+  while (nKeep < m_listFixed.size() &&
+         listRows.contains(m_listFixed.at(nKeep))) {
+    nKeep++;
+  }
+  while (m_listFixed.size() > nKeep) {
+    this->uncoverRow(m_listFixed.takeLast());
+  }
+  foreach (int nRow, listRows) {
+    if (!m_listFixed.contains(nRow)) {
+      this->coverRow(nRow);
+      m_listFixed << nRow;
+    }
+  }
+  return true;
+}
+
+void ExactCover::coverRow(const int nRow) {
+  const int nFirst(m_nRowNode[nRow]);
+  int j(nFirst);
+  do {
+    this->cover(m_Nodes[j].nColumn);
+    j = m_Nodes[j].nRight;
+  } while (j != nFirst);
+}
+
+void ExactCover::uncoverRow(const int nRow) {
+  const int nFirst(m_nRowNode[nRow]);
+  int j(m_Nodes[nFirst].nLeft);
+  do {
+    this->uncover(m_Nodes[j].nColumn);
+    j = m_Nodes[j].nLeft;
+  } while (j != m_Nodes[nFirst].nLeft);
+}
+
+bool ExactCover::containsAll(const QList<int> &list,
+                             const QList<int> &listSubset) {
+  // Lists are as short as the number of pieces
+  foreach (int n, listSubset) {
+    if (!list.contains(n)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+quint64 ExactCover::countSolutions(const int nThreads,
+                                   const QList<int> &listFixedRows) {
+  m_nNodes = 0;
+  if (!this->fixRows(listFixedRows)) {
+    return 0;
+  }
+  const int nCol(this->chooseColumn());
+  if (1 == nThreads || 0 == nCol) {
+    return this->search();
+  }
+
+  // Split at first level: each row of the most constrained column
+  QThreadPool pool;
+  pool.setMaxThreadCount(nThreads > 0 ? nThreads :
+                                        QThread::idealThreadCount());
+  QList<QFuture<QPair<quint64, quint64> > > listFutures;
+  for (int r = m_Nodes[nCol].nDown; r != nCol; r = m_Nodes[r].nDown) {
+    listFutures << QtConcurrent::run(&pool, &ExactCover::countBranch,
+                                     *this, r);
+  }
+
+  quint64 nCount(0);
+  m_nNodes = 1;
+  for (int i = 0; i < listFutures.size(); i++) {
+    nCount += listFutures[i].result().first;
+    m_nNodes += listFutures[i].result().second;
+  }
+  return nCount;
+}
+
+QPair<quint64, quint64> ExactCover::countBranch(ExactCover matrix,
+                                                const int nRowNode) {
+  matrix.m_nNodes = 0;
+  matrix.cover(matrix.m_Nodes[nRowNode].nColumn);
+  for (int j = matrix.m_Nodes[nRowNode].nRight; j != nRowNode;
+       j = matrix.m_Nodes[j].nRight) {
+    matrix.cover(matrix.m_Nodes[j].nColumn);
+  }
+  const quint64 nCount(matrix.search());
+  return qMakePair(nCount, matrix.m_nNodes);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool ExactCover::findSolution(QList<int> *pListRows,
+                              const QList<int> &listFixedRows) {
+  m_nNodes = 0;
+  pListRows->clear();
+
+  // Last solution is still valid, e.g. after its hint has been placed
+  if (!m_listLastSolution.isEmpty() &&
+      ExactCover::containsAll(m_listLastSolution, listFixedRows)) {
+    *pListRows += listFixedRows;
+    foreach (int nRow, m_listLastSolution) {
+      if (!listFixedRows.contains(nRow)) {
+        pListRows->append(nRow);
+      }
+    }
+    return true;
+  }
+  if (m_bNoSolution &&
+      ExactCover::containsAll(listFixedRows, m_listNoSolution)) {
+    return false;
+  }
+
+  if (!this->fixRows(listFixedRows)) {
+    return false;
+  }
+  *pListRows += listFixedRows;
+  const bool bFound(this->searchFirst(pListRows));
+  if (bFound) {
+    m_listLastSolution = *pListRows;
+  } else {
+    pListRows->clear();
+    m_listNoSolution = listFixedRows;
+    m_bNoSolution = true;
+  }
+  return bFound;
+}
+
+// ---------------------------------------------------------------------------
+
+quint64 ExactCover::collectSolutions(QVector<int> *pListRows,
+                                     const quint64 nLimit) {
+  // Rows of all solutions, each terminated by -1; stops after nLimit + 1
+  m_nNodes = 0;
+  this->fixRows(QList<int>());
+  quint64 nFound(0);
+  QVector<int> listStack;
+  pListRows->clear();
+  this->searchAll(&listStack, pListRows, &nFound, nLimit);
+  return nFound;
+}
+
+// ---------------------------------------------------------------------------
+
+bool ExactCover::buildZdd(Zdd *pZdd, const QList<int> &listColumnOrder,
+                          const int nMaxNodes) {
+  // Primary columns are linked in branching order, missing ones follow
+  m_nNodes = 0;
+  this->fixRows(QList<int>());
+  QVector<int> listPriority(m_nColumns + 1, INT_MAX);
+  QList<int> listHeaders;
+  foreach (int nCol, listColumnOrder) {
+    if (nCol >= 0 && nCol < m_nPrimary && INT_MAX == listPriority[nCol + 1]) {
+      listPriority[nCol + 1] = listHeaders.size();
+      listHeaders << nCol + 1;
+    }
+  }
+  for (int c = 1; c <= m_nColumns; c++) {
+    if (c > m_nPrimary) {
+      listPriority[c] = m_nColumns + c;  // Secondary, never chosen
+    } else if (INT_MAX == listPriority[c]) {
+      listPriority[c] = listHeaders.size();
+      listHeaders << c;
+    }
+  }
+
+  // Level of a row: its first column in branching order, then row index
+  QList<QPair<int, int> > listOrder;
+  for (int nRow = 0; nRow < m_nRows; nRow++) {
+    int nFirstCol(INT_MAX);
+    const int nFirst(m_nRowNode[nRow]);
+    if (nFirst >= 0) {
+      int j(nFirst);
+      do {
+        nFirstCol = qMin(nFirstCol, listPriority[m_Nodes[j].nColumn]);
+        j = m_Nodes[j].nRight;
+      } while (j != nFirst);
+    }
+    listOrder << qMakePair(nFirstCol, nRow);
+  }
+  qSort(listOrder);
+  QVector<int> listLevels(m_nRows);
+  for (int i = 0; i < listOrder.size(); i++) {
+    listLevels[listOrder.at(i).second] = i;
+  }
+
+  this->linkColumns(listHeaders);
+  *pZdd = Zdd(listLevels);
+  QByteArray covered((m_nColumns + 8) / 8, '\0');
+  QHash<QByteArray, int> memo;
+  const int nRoot(this->searchZdd(pZdd, &covered, &memo, nMaxNodes));
+  listHeaders.clear();
+  for (int c = 1; c <= m_nPrimary; c++) {
+    listHeaders << c;
+  }
+  this->linkColumns(listHeaders);
+
+  if (nRoot < 0) {
+    *pZdd = Zdd();
+    return false;
+  }
+  pZdd->setRoot(nRoot);
+  return true;
+}
+
+void ExactCover::linkColumns(const QList<int> &listHeaders) {
+  // All columns have to be uncovered
+  int nPrev(0);
+  foreach (int nHeader, listHeaders) {
+    m_Nodes[nPrev].nRight = nHeader;
+    m_Nodes[nHeader].nLeft = nPrev;
+    nPrev = nHeader;
+  }
+  m_Nodes[nPrev].nRight = 0;
+  m_Nodes[0].nLeft = nPrev;
+}
+
+void ExactCover::setTableSize(const int nMegabytes) {
+  // Shared by all copies (threads), 0 = no transposition table
+  if (nMegabytes > 0) {
+    m_pTable = QSharedPointer<TranspositionTable>(
+                 new TranspositionTable(nMegabytes));
+  } else {
+    m_pTable.clear();
+  }
+}
+
+void ExactCover::setTable(const QSharedPointer<TranspositionTable> &pTable) {
+  // Table of other matrices as well, NULL = no transposition table
+  m_pTable = pTable;
+}
+
+quint64 ExactCover::getNodes() const {
+  return m_nNodes;
+}
+
+int ExactCover::getNumOfRows() const {
+  return m_nRows;
+}
+
+int ExactCover::getNumOfColumns() const {
+  return m_nColumns;
+}
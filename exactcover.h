@@ -0,0 +1,150 @@
+/**
+ * \file exactcover.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the exact cover solver (dancing links).
+ */
+
+#ifndef EXACTCOVER_H_
+#define EXACTCOVER_H_
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSharedPointer>
+#include <QVector>
+
+#include "./transpositiontable.h"
+#include "./zdd.h"
+
+/**
+ * \class ExactCover
+ * \brief Knuth's Algorithm X with dancing links, stored in plain arrays.
+ *
+ * Primary columns have to be covered exactly once, secondary columns at
+ * most once. The matrix is a value type: for counting in parallel every
+ * branch of the first column works on its own copy. Rows can be fixed in
+ * advance, e.g. for pieces which are already placed on the board.
+ *
+ * Optionally counting caches the number of solutions of each subproblem
+ * in a transposition table, which all copies of the matrix share.
+ *
+ * Consecutive queries usually differ by a single piece move, so the
+ * fixed rows stay covered until the next query and only the rows after
+ * the first changed one are released and covered again. The last found
+ * solution is returned again while it contains all fixed rows, and fixed
+ * rows without solution reject all queries containing them.
+ *
+ * Colourings (parity constraints) prune every search node, if enabled by
+ * setParityPruning(): each column has a weight and each row contains
+ * exactly one group column (e.g. its piece). The weights of the uncovered
+ * columns have to be reachable as sum of one row weight of each uncovered
+ * group, otherwise the branch can't be completed. Only rows still in the
+ * matrix count. Off by default: on pentomino rectangles it saves ~4 % of
+ * the nodes, but the check makes the search 30-50 % slower.
+ *
+ * buildZdd() stores all solutions as diagram over the rows: the search
+ * always takes the first uncovered column of a given order and equal
+ * subproblems (same covered columns) are solved only once.
+ */
+class ExactCover {
+ public:
+    ExactCover(const int nPrimary = 0, const int nSecondary = 0);
+
+    int addRow(const QVector<int> &listColumns);
+    quint64 countSolutions(const int nThreads = 0,
+                           const QList<int> &listFixedRows = QList<int>());
+    bool findSolution(QList<int> *pListRows,
+                      const QList<int> &listFixedRows = QList<int>());
+    quint64 collectSolutions(QVector<int> *pListRows, const quint64 nLimit);
+    bool buildZdd(Zdd *pZdd, const QList<int> &listColumnOrder,
+                  const int nMaxNodes);
+    void setTableSize(const int nMegabytes);
+    void setTable(const QSharedPointer<TranspositionTable> &pTable);
+    void setColourings(const QList<QVector<int> > &listWeights,
+                       const int nFirstGroup);
+    void setParityPruning(const bool bEnabled);
+    quint64 getNodes() const;
+    int getNumOfRows() const;
+    int getNumOfColumns() const;
+
+ private:
+    struct Node {
+      int nLeft;
+      int nRight;
+      int nUp;
+      int nDown;
+      int nColumn;  // Header node of the column
+      int nRow;
+    };
+
+    void cover(const int nCol);
+    void uncover(const int nCol);
+    int chooseColumn() const;
+    quint64 search();
+    bool searchFirst(QList<int> *pListRows);
+    void searchAll(QVector<int> *pStack, QVector<int> *pListRows,
+                   quint64 *pFound, const quint64 nLimit);
+    int searchZdd(Zdd *pZdd, QByteArray *pCovered,
+                  QHash<QByteArray, int> *pMemo, const int nMaxNodes);
+    void toggleCovered(QByteArray *pCovered, const int nRowNode) const;
+    bool isFeasible();
+    quint64 signature(const int nCol, const int *pBits) const;
+    void addGroup(const quint64 nSignature, const bool bOptional);
+    void linkColumns(const QList<int> &listHeaders);
+    bool fixRows(const QList<int> &listRows);
+    void coverRow(const int nRow);
+    void uncoverRow(const int nRow);
+    static bool containsAll(const QList<int> &list,
+                            const QList<int> &listSubset);
+    static QPair<quint64, quint64> countBranch(ExactCover matrix,
+                                               const int nRowNode);
+
+    QVector<Node> m_Nodes;  // 0 = root, 1..columns = column headers
+    QVector<int> m_nColSize;
+    QVector<int> m_nRowNode;  // First node of each row, -1 if empty
+    int m_nPrimary;
+    int m_nColumns;
+    int m_nRows;
+    quint64 m_nNodes;
+    QVector<quint64> m_listColumnKeys;
+    quint64 m_nKey;  // Covered columns, key of the transposition table
+    QSharedPointer<TranspositionTable> m_pTable;
+    QList<int> m_listFixed;  // Covered since the last query, in order
+    QList<int> m_listLastSolution;
+    QList<int> m_listNoSolution;  // Fixed rows of the last failed search
+    bool m_bNoSolution;
+
+    // Per colouring k: weight of each column header and of each row
+    // (bit 32 + weight) without its group column
+    int m_nColourings;
+    QVector<int> m_listColumnWeights;  // [k * (columns + 1) + header]
+    QVector<int> m_listRowBits;  // [k * rows + row]
+    int m_nFirstGroup;  // Header of the first group column
+    int m_nReachOffset;  // Bit of sum 0 in m_listReach
+    QVector<quint64> m_listReach;  // Reachable sums, scratch
+    QVector<quint64> m_listNext;
+    bool m_bParity;
+};
+
+#endif  // EXACTCOVER_H_
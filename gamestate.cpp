@@ -0,0 +1,152 @@
+/**
+ * \file gamestate.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * State of one headless game session.
+ */
+
+#include "./gamestate.h"
+
+GameState::GameState(const Solver *pSolver)
+  : m_pSolver(pSolver),
+    m_nCovered(0),
+    m_nMoves(0) {
+  if (NULL != m_pSolver) {
+    m_Occupied.fill(0, (m_pSolver->getCells().size() + 63) / 64);
+    m_nPieceRow.fill(-1, m_pSolver->getNumOfPieces());
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+GameState::MoveResult GameState::movePiece(const int nPiece,
+                                           const QVector<Voxel> &listCells) {
+  if (NULL == m_pSolver || nPiece < 0 || nPiece >= m_nPieceRow.size()) {
+    return MoveInvalid;
+  }
+
+  // No cells: piece is taken from the board
+  int nRow(-1);
+  if (!listCells.isEmpty()) {
+    nRow = m_pSolver->findPlacement(nPiece, listCells);
+    if (nRow < 0) {
+      return MoveInvalid;
+    }
+  }
+  return this->placeRow(nPiece, nRow);
+}
+
+GameState::MoveResult GameState::placeRow(const int nPiece, const int nRow) {
+  if (NULL == m_pSolver || nPiece < 0 || nPiece >= m_nPieceRow.size() ||
+      nRow < -1 || nRow >= m_pSolver->getPlacements().size() ||
+      (nRow >= 0 && m_pSolver->getPlacements().at(nRow).nPiece != nPiece)) {
+    return MoveInvalid;
+  }
+
+  const int nOldRow(m_nPieceRow.at(nPiece));
+  if (nOldRow == nRow) {
+    return this->isSolved() ? MoveSolved : MoveOk;
+  }
+  if (nOldRow >= 0) {
+    this->setCells(m_pSolver->getRowCells(nOldRow), false);
+  }
+  if (nRow >= 0) {
+    const QVector<int> &listRowCells = m_pSolver->getRowCells(nRow);
+    if (!this->isFree(listRowCells)) {
+      if (nOldRow >= 0) {
+        this->setCells(m_pSolver->getRowCells(nOldRow), true);
+      }
+      return MoveBlocked;
+    }
+    this->setCells(listRowCells, true);
+  }
+
+  m_nPieceRow[nPiece] = nRow;
+  m_nMoves++;
+  return this->isSolved() ? MoveSolved : MoveOk;
+}
+
+// Row fits, if its cells are free or covered by the piece itself
+bool GameState::canPlace(const int nPiece, const int nRow) const {
+  if (NULL == m_pSolver || nPiece < 0 || nPiece >= m_nPieceRow.size() ||
+      nRow < 0 || nRow >= m_pSolver->getPlacements().size() ||
+      m_pSolver->getPlacements().at(nRow).nPiece != nPiece) {
+    return false;
+  }
+  const int nOldRow(m_nPieceRow.at(nPiece));
+  foreach (int nCell, m_pSolver->getRowCells(nRow)) {
+    if ((m_Occupied.at(nCell / 64) & (Q_UINT64_C(1) << (nCell % 64))) &&
+        (nOldRow < 0 || !m_pSolver->getRowCells(nOldRow).contains(nCell))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+
+bool GameState::isFree(const QVector<int> &listCells) const {
+  foreach (int nCell, listCells) {
+    if (m_Occupied.at(nCell / 64) & (Q_UINT64_C(1) << (nCell % 64))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void GameState::setCells(const QVector<int> &listCells,
+                         const bool bOccupied) {
+  foreach (int nCell, listCells) {
+    if (bOccupied) {
+      m_Occupied[nCell / 64] |= Q_UINT64_C(1) << (nCell % 64);
+    } else {
+      m_Occupied[nCell / 64] &= ~(Q_UINT64_C(1) << (nCell % 64));
+    }
+  }
+  m_nCovered += bOccupied ? listCells.size() : -listCells.size();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool GameState::isSolved() const {
+  return NULL != m_pSolver && m_nCovered == m_pSolver->getCells().size();
+}
+
+int GameState::getRow(const int nPiece) const {
+  return m_nPieceRow.value(nPiece, -1);
+}
+
+quint32 GameState::getMoves() const {
+  return m_nMoves;
+}
+
+QList<Solver::Placement> GameState::getPlaced() const {
+  QList<Solver::Placement> listPlaced;
+  foreach (int nRow, m_nPieceRow) {
+    if (nRow >= 0) {
+      listPlaced << m_pSolver->getPlacements().at(nRow);
+    }
+  }
+  return listPlaced;
+}
@@ -0,0 +1,74 @@
+/**
+ * \file gamestate.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the state of one game session.
+ */
+
+#ifndef GAMESTATE_H_
+#define GAMESTATE_H_
+
+#include <QList>
+#include <QVector>
+
+#include "./solver.h"
+
+/**
+ * \class GameState
+ * \brief Pieces on the board of one headless game, without any GUI.
+ *
+ * Occupied cells are kept as bitboard (one bit per solver cell), each
+ * piece by its placement row of the solver. A move is valid, if it
+ * matches a placement of the piece and all its cells are free. The
+ * solver is shared by all games of the same board and only read.
+ */
+class GameState {
+ public:
+    enum MoveResult {
+      MoveOk,
+      MoveSolved,
+      MoveInvalid,
+      MoveBlocked
+    };
+
+    explicit GameState(const Solver *pSolver = NULL);
+
+    MoveResult movePiece(const int nPiece, const QVector<Voxel> &listCells);
+    MoveResult placeRow(const int nPiece, const int nRow);  // -1 = remove
+    bool canPlace(const int nPiece, const int nRow) const;
+    int getRow(const int nPiece) const;
+    bool isSolved() const;
+    quint32 getMoves() const;
+    QList<Solver::Placement> getPlaced() const;
+
+ private:
+    bool isFree(const QVector<int> &listCells) const;
+    void setCells(const QVector<int> &listCells, const bool bOccupied);
+
+    const Solver *m_pSolver;
+    QVector<quint64> m_Occupied;
+    QVector<int> m_nPieceRow;  // -1 = piece not on the board
+    int m_nCovered;
+    quint32 m_nMoves;
+};
+
+#endif  // GAMESTATE_H_
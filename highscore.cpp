@@ -52,6 +52,17 @@ Highscore::Highscore(QWidget *pParent, QObject *pParentObj)
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
+QStringList Highscore::getBoards() const {
+  return m_pHighscore->childGroups();
+}
+
+quint8 Highscore::getMaxPosition() const {
+  return m_nMAXPOS;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
 void Highscore::showHighscore(const QString &sBoard) {
   Qt::AlignmentFlag Align = Qt::AlignCenter;
   QStringList sListTemp;
@@ -106,14 +117,14 @@ void Highscore::showHighscore(const QString &sBoard) {
 // ---------------------------------------------------------------------------
 
 void Highscore::checkHighscore(const QString &sBoard, const quint32 nMoves,
-                               const QTime tTime) {
+                               const QTime tTime, const QByteArray &moveLog) {
   QStringList sListTemp;
   quint32 nScoreMoves(0);
   QTime tScoreTime(0, 0, 0);
 
   for (int i = 1; i <= m_nMAXPOS; i++) {
     sListTemp = readHighscore(sBoard, "Position" + QString::number(i));
-    if (3 != sListTemp.size()) {
+    if (sListTemp.size() < 3) {
       qWarning() << "Found invalid highscore:" << sListTemp;
       continue;
     }
@@ -126,11 +137,11 @@ void Highscore::checkHighscore(const QString &sBoard, const quint32 nMoves,
     */
 
     if (nMoves < nScoreMoves || 0 == nScoreMoves) {
-      this->insertHighscore(sBoard, i, nMoves, tTime);
+      this->insertHighscore(sBoard, i, nMoves, tTime, moveLog);
       break;
     } else if (nMoves == nScoreMoves) {
       if (tTime < tScoreTime) {
-        this->insertHighscore(sBoard, i, nMoves, tTime);
+        this->insertHighscore(sBoard, i, nMoves, tTime, moveLog);
         break;
       }
     }
@@ -141,7 +152,8 @@ void Highscore::checkHighscore(const QString &sBoard, const quint32 nMoves,
 // ---------------------------------------------------------------------------
 
 void Highscore::insertHighscore(const QString &sBoard, const quint8 nPosition,
-                                const quint32 nMoves, const QTime tTime) {
+                                const quint32 nMoves, const QTime tTime,
+                                const QByteArray &moveLog) {
   if (nPosition <= m_nMAXPOS) {
     QStringList sListEntries;
     sListEntries.reserve(m_nMAXPOS + 1);
@@ -169,6 +181,9 @@ void Highscore::insertHighscore(const QString &sBoard, const quint8 nPosition,
     }
     ba.append(sName + "|" + tTime.toString("hh:mm:ss") + "|"
               + QString::number(nMoves));
+    if (!moveLog.isEmpty()) {
+      ba.append("|" + moveLog.toBase64());
+    }
     sListEntries.insert(nPosition - 1, ba.toBase64());
     for (int i = 0; i < m_nMAXPOS; i++) {
       m_pHighscore->setValue(sBoard + "/Position"
@@ -196,7 +211,8 @@ QStringList Highscore::readHighscore(const QString &sBoard,
       sListTemp[j] = "-";
     }
   }
-  if (3 != sListTemp.size()) {
+  // Entries without move log are from older versions
+  if (3 != sListTemp.size() && 4 != sListTemp.size()) {
     qWarning() << "Found invalid highscore:" << sListTemp;
     sListTemp.clear();
     sListTemp << "Cheater" << "99:99:99" << "999";
@@ -34,6 +34,9 @@
 /**
  * \class Highscore
  * \brief Generating and showing highscore.
+ *
+ * An entry is "name|time|moves" in base64, new entries append the
+ * base64 move log (see MoveLog), so they can be verified by replay.
  */
 class Highscore : public QObject {
   Q_OBJECT
@@ -41,15 +44,19 @@ class Highscore : public QObject {
  public:
     explicit Highscore(QWidget *pParent = 0, QObject *pParentObj = 0);
 
+    QStringList getBoards() const;
+    quint8 getMaxPosition() const;
+    QStringList readHighscore(const QString &sBoard, const QString &sKey) const;
+
  public slots:
     void showHighscore(const QString &sBoard);
     void checkHighscore(const QString &sBoard, const quint32 nMoves,
-                        const QTime tTime);
+                        const QTime tTime, const QByteArray &moveLog);
 
  private:
-    QStringList readHighscore(const QString &sBoard, const QString &sKey) const;
     void insertHighscore(const QString &sBoard, const quint8 nPosition,
-                         const quint32 nMoves, const QTime tTime);
+                         const quint32 nMoves, const QTime tTime,
+                         const QByteArray &moveLog);
 
     QWidget *m_pParent;
     QSettings *m_pHighscore;
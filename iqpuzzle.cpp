@@ -28,11 +28,16 @@
 
 #include <QApplication>
 #include <QDialogButtonBox>
+#include <QDir>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QGridLayout>
+#include <QInputDialog>
 #include <QLabel>
 #include <QMessageBox>
+#include <QtConcurrentRun>
 
+#include "./lattice.h"
 #include "ui_iqpuzzle.h"
 
 IQPuzzle::IQPuzzle(const QDir &userDataDir, const QDir &sharePath,
@@ -49,7 +54,13 @@ IQPuzzle::IQPuzzle(const QDir &userDataDir, const QDir &sharePath,
     m_sSavedTime(""),
     m_sSavedMoves(""),
     m_Time(0, 0, 0),
-    m_bSolved(false) {
+    m_bSolved(false),
+    m_nNextChoice(0),
+    m_sNextBoard(""),
+    m_nHintLevel(0),
+    m_nHintCommand(0),
+    m_pDeduction(NULL),
+    m_pTelemetry(NULL) {
   qDebug() << Q_FUNC_INFO;
 
   m_pUi->setupUi(this);
@@ -74,6 +85,9 @@ IQPuzzle::IQPuzzle(const QDir &userDataDir, const QDir &sharePath,
           m_pSettings, SLOT(updateUiLang()));
   this->loadLanguage(m_pSettings->getLanguage());
   this->setupMenu();
+  connect(m_pSettings, SIGNAL(changeTelemetry(bool)),
+          this, SLOT(switchTelemetry(bool)));
+  this->switchTelemetry(m_pSettings->getTelemetry());
 
   m_pGraphView = new QGraphicsView(this);
   this->setCentralWidget(m_pGraphView);
@@ -90,6 +104,29 @@ IQPuzzle::IQPuzzle(const QDir &userDataDir, const QDir &sharePath,
   m_pUi->statusBar->addWidget(m_pStatusLabelTime);
   m_pUi->statusBar->addPermanentWidget(m_pStatusLabelMoves);
 
+  m_pHintWatcher = new QFutureWatcher<SolverDaemon::Reply>(this);
+  connect(m_pHintWatcher, SIGNAL(finished()), this, SLOT(hintReady()));
+
+  // Race: miniature of the opponent's board next to the own one
+  m_pRaceLink = new RaceLink(this);
+  connect(m_pRaceLink, SIGNAL(connected()), this, SLOT(raceConnected()));
+  connect(m_pRaceLink, SIGNAL(disconnected()),
+          this, SLOT(raceDisconnected()));
+  connect(m_pRaceLink, SIGNAL(boardChosen(QString)),
+          this, SLOT(joinRaceBoard(QString)));
+  connect(m_pRaceLink, SIGNAL(opponentSolved(quint32, quint32)),
+          this, SLOT(opponentSolved(quint32, quint32)));
+  m_pRaceView = new RaceView(this);
+  connect(m_pRaceLink, SIGNAL(opponentMoved(int, int, int)),
+          m_pRaceView, SLOT(movePiece(int, int, int)));
+  m_pRaceDock = new QDockWidget(tr("Opponent"), this);
+  m_pRaceDock->setObjectName("RaceDock");
+  m_pRaceDock->setFeatures(QDockWidget::DockWidgetMovable |
+                           QDockWidget::DockWidgetFloatable);
+  m_pRaceDock->setWidget(m_pRaceView);
+  this->addDockWidget(Qt::RightDockWidgetArea, m_pRaceDock);
+  m_pRaceDock->hide();
+
   // Seed random number generator
   QTime time = QTime::currentTime();
   qsrand((uint)time.msec());
@@ -141,6 +178,7 @@ IQPuzzle::IQPuzzle(const QDir &userDataDir, const QDir &sharePath,
 }
 
 IQPuzzle::~IQPuzzle() {
+  delete m_pDeduction;
 }
 
 // ---------------------------------------------------------------------------
@@ -194,6 +232,24 @@ void IQPuzzle::setupMenu() {
   connect(m_pUi->action_RestartGame, SIGNAL(triggered()),
           this, SLOT(restartGame()));
 
+  // Hint (solver daemon or own process)
+  m_pUi->action_Hint->setShortcut(Qt::CTRL + Qt::Key_I);
+  connect(m_pUi->action_Hint, SIGNAL(triggered()),
+          this, SLOT(showHint()));
+  // Forced moves overlay, updated after each move
+  connect(m_pUi->action_ForcedMoves, SIGNAL(toggled(bool)),
+          this, SLOT(updateForcedMoves()));
+
+  // Race against a second player
+  connect(m_pUi->action_RaceHost, SIGNAL(triggered()),
+          this, SLOT(hostRace()));
+  connect(m_pUi->action_RaceJoin, SIGNAL(triggered()),
+          this, SLOT(joinRace()));
+  connect(m_pUi->action_RaceLoopback, SIGNAL(triggered()),
+          this, SLOT(startLoopbackRace()));
+  connect(m_pUi->action_RaceLeave, SIGNAL(triggered()),
+          this, SLOT(leaveRace()));
+
   // Load game
   m_pUi->action_LoadGame->setShortcut(QKeySequence::Open);
   connect(m_pUi->action_LoadGame, SIGNAL(triggered()),
@@ -214,8 +270,9 @@ void IQPuzzle::setupMenu() {
           this, SLOT(showHighscore()));
   connect(this, SIGNAL(showHighscore(QString)),
           m_pHighscore, SLOT(showHighscore(QString)));
-  connect(this, SIGNAL(checkHighscore(QString, quint32, QTime)),
-          m_pHighscore, SLOT(checkHighscore(QString, quint32, QTime)));
+  connect(this, SIGNAL(checkHighscore(QString, quint32, QTime, QByteArray)),
+          m_pHighscore,
+          SLOT(checkHighscore(QString, quint32, QTime, QByteArray)));
 
   // Statistics
   connect(m_pUi->action_Statistics, SIGNAL(triggered()),
@@ -262,6 +319,11 @@ void IQPuzzle::startNewGame(QString sBoardFile, const QString &sSavedGame,
     qWarning() << "Board file not found:" << sBoardFile;
     return;
   }
+  if (QSettings(sBoardFile, QSettings::IniFormat).value(
+        "Layers", 1).toUInt() > 1) {
+    this->playLayers(sBoardFile);
+    return;
+  }
   m_sBoardFile = sBoardFile;
   m_sSavedGame = "";
 
@@ -309,6 +371,29 @@ void IQPuzzle::setGameTitle() {
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
+// 3D boxes are played in an own window, one layer at a time
+void IQPuzzle::playLayers(const QString &sBoardFile) {
+  LayerView *pView = new LayerView(this);
+  pView->setWindowFlags(Qt::Window);
+  pView->setAttribute(Qt::WA_DeleteOnClose);
+  if (!pView->setBoard(BoardDescriptor::load(sBoardFile))) {
+    QMessageBox::warning(this, qApp->applicationName(),
+                         tr("Error while loading the 3D board."));
+    qWarning() << "Couldn't load 3D board:" << sBoardFile;
+    delete pView;
+    return;
+  }
+  pView->setWindowTitle(QFileInfo(sBoardFile).baseName() + " - " +
+                        qApp->applicationName());
+  pView->setToolTip(tr("PageUp/PageDown: change layer\n"
+                       "Tab, 1-9: select piece\n"
+                       "R: rotate piece\n"
+                       "Click: place piece, right click: remove piece"));
+  pView->show();
+}
+
+// ---------------------------------------------------------------------------
+
 QString IQPuzzle::chooseBoard() {
   if (NULL != m_pBoardDialog) {
     delete m_pBoardDialog;
@@ -341,8 +426,20 @@ void IQPuzzle::createBoard() {
     }
     delete m_pBoard;
   }
-  m_pBoard = new Board(m_pGraphView, m_sBoardFile, m_pSettings,
-                       nGridSize, m_sSavedGame);
+  delete m_pDeduction;
+  m_pDeduction = NULL;
+
+  BoardDescriptor descriptor;
+  if (m_sSavedGame.isEmpty() && !m_sNextBoard.isEmpty() &&
+      m_sBoardFile == m_sSharePath + "/boards/" + m_sNextBoard) {
+    // Prepared in background by prefetchRandomGame()
+    descriptor = m_futureNextBoard.result();
+    m_sNextBoard.clear();
+  } else {
+    descriptor = BoardDescriptor::load(m_sBoardFile, m_sSavedGame);
+  }
+
+  m_pBoard = new Board(m_pGraphView, descriptor, m_pSettings, nGridSize);
   sPreviousBoard = m_sBoardFile;
   connect(m_pBoard, SIGNAL(setWindowSize(const QSize, const bool)),
           this, SLOT(setMinWindowSize(const QSize, const bool)));
@@ -350,10 +447,16 @@ void IQPuzzle::createBoard() {
           m_pBoard, SLOT(zoomIn()));
   connect(m_pUi->action_ZoomOut, SIGNAL(triggered()),
           m_pBoard, SLOT(zoomOut()));
+  connect(m_pUi->action_TidyUp, SIGNAL(triggered()),
+          m_pBoard, SLOT(tidyUpPieces()));
   connect(m_pBoard, SIGNAL(incrementMoves()),
           this, SLOT(incrementMoves()));
   connect(m_pBoard, SIGNAL(solvedPuzzle()),
           this, SLOT(solvedPuzzle()));
+  connect(m_pBoard, SIGNAL(builtShape(const QList<QPoint> &, const quint16)),
+          this, SLOT(builtShape(const QList<QPoint> &, const quint16)));
+  connect(m_pBoard, SIGNAL(recordEvent(int, quint16, QPoint)),
+          this, SLOT(recordEvent(int, quint16, QPoint)));
 
   if (m_pBoard->setupBoard()) {
     bool bFreestyle = m_pBoard->setupBlocks();
@@ -361,33 +464,258 @@ void IQPuzzle::createBoard() {
       m_pTimer->stop();
       m_pUi->action_PauseGame->setEnabled(false);
       m_pUi->action_Highscore->setEnabled(false);
+      m_pUi->action_Hint->setEnabled(false);
+      m_pUi->action_ForcedMoves->setEnabled(false);
+      m_pUi->action_TidyUp->setEnabled(false);
+      // Index of all board shapes is only needed for freestyle, build it on
+      // first use (a default constructed QFuture is canceled)
+      if (m_futureShapeIndex.isCanceled()) {
+        m_futureShapeIndex = QtConcurrent::run(&ShapeIndex::build,
+                                               m_sSharePath + "/boards");
+      }
     } else {
       m_pTimer->start(1000);
       m_pUi->action_PauseGame->setEnabled(true);
       m_pUi->action_Highscore->setEnabled(true);
+      m_pUi->action_Hint->setEnabled(true);
+      m_pUi->action_ForcedMoves->setEnabled(true);
+      m_pUi->action_TidyUp->setEnabled(true);
+      QString sBoard(m_sBoardFile);
+      m_sTelemetryBoard = sBoard.remove(m_sSharePath + "/boards/");
+      this->recordEvent(Telemetry::EventStart);
     }
 
     m_pUi->action_PauseGame->setChecked(false);
     m_pUi->action_SaveGame->setEnabled(true);
     m_pUi->action_RestartGame->setEnabled(true);
     m_bSolved = false;
+    m_nHintLevel = 0;
+    // Saved games continue with their pieces on the board
+    m_MoveLog.clear();
+    m_MoveLog.addSnapshot(m_nMoves, QTime(0, 0, 0).secsTo(m_Time),
+                          m_pBoard->getPieceCells());
     m_pGraphView->setScene(m_pBoard);
+    m_pGraphView->setFocus();  // Keyboard control
+    this->updateForcedMoves();
+    this->startRace(descriptor);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void IQPuzzle::builtShape(const QList<QPoint> &listCells,
+                          const quint16 nBlocks) {
+  if (!m_futureShapeIndex.isFinished() || m_futureShapeIndex.isCanceled()) {
+    return;  // Index not ready yet
+  }
+
+  QString sBoard(m_futureShapeIndex.result().findBoard(listCells));
+  if (sBoard.isEmpty()) {
+    m_pUi->statusBar->showMessage(
+          tr("This is a new shape (%1 blocks, %2 cells)")
+          .arg(nBlocks).arg(listCells.size()), 5000);
+  } else {
+    m_pUi->statusBar->showMessage(tr("You built board %1").arg(sBoard), 5000);
   }
 }
 
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
+void IQPuzzle::showHint() {
+  if (NULL == m_pBoard || m_bSolved || m_pHintWatcher->isRunning() ||
+      m_pUi->action_PauseGame->isChecked()) {
+    return;
+  }
+
+  // Graded: first a single cell, then a complete block position
+  if (0 == m_nHintLevel) {
+    this->queryHint(SolverDaemon::CommandCellHint);
+  } else {
+    this->queryHint(SolverDaemon::CommandHint);
+  }
+}
+
+void IQPuzzle::queryHint(const int nCommand) {
+  m_sHintBoard = m_sBoardFile;
+  m_nHintCommand = nCommand;
+  m_pUi->statusBar->showMessage(tr("Searching hint..."));
+  m_pHintWatcher->setFuture(
+        QtConcurrent::run(&SolverDaemon::query, nCommand,
+                          m_sBoardFile, this->placedPieces()));
+}
+
+QList<Solver::Placement> IQPuzzle::placedPieces() const {
+  QList<Solver::Placement> listPlaced;
+  const QList<QList<QPoint> > listPieces(m_pBoard->getPieceCells());
+  for (int i = 0; i < listPieces.size(); i++) {
+    Solver::Placement placement;
+    placement.nPiece = i;
+    placement.nOrientation = 0;
+    foreach (const QPoint &cell, listPieces.at(i)) {
+      placement.listCells << Voxel(cell.x(), cell.y(), 0);
+    }
+    listPlaced << placement;
+  }
+  return listPlaced;
+}
+
+void IQPuzzle::hintReady() {
+  if (NULL == m_pBoard || m_sHintBoard != m_sBoardFile) {
+    m_pUi->statusBar->clearMessage();
+    return;  // Board changed meanwhile
+  }
+
+  const SolverDaemon::Reply reply(m_pHintWatcher->result());
+  QList<QPoint> listCells;
+  foreach (const Voxel &v, reply.hint.listCells) {
+    listCells << QPoint(v.x, v.y);
+  }
+
+  if (SolverDaemon::CommandCellHint == m_nHintCommand) {
+    if (SolverCache::Found != reply.result || reply.hint.nPiece < 0 ||
+        0 == reply.nSolutions) {
+      // No frequency map for this board, continue with a block position
+      this->queryHint(SolverDaemon::CommandHint);
+      return;
+    }
+    m_pBoard->showHint(reply.hint.nPiece, listCells);
+    this->recordEvent(Telemetry::EventHint, reply.hint.nPiece + 1,
+                      listCells.value(0));
+    if (reply.nCount == reply.nSolutions) {
+      m_pUi->statusBar->showMessage(
+            tr("This cell is always covered by block %1.")
+            .arg(reply.hint.nPiece + 1), 5000);
+    } else {
+      m_pUi->statusBar->showMessage(
+            tr("This cell is covered by block %1 in %2% of the remaining "
+               "solutions.")
+            .arg(reply.hint.nPiece + 1)
+            .arg(qRound(100.0 * reply.nCount / reply.nSolutions)), 5000);
+    }
+    m_nHintLevel++;
+    return;
+  }
+
+  switch (reply.result) {
+    case SolverCache::Found:
+      if (reply.hint.nPiece < 0) {
+        m_pUi->statusBar->showMessage(tr("All pieces are placed."), 5000);
+      } else {
+        m_pBoard->showHint(reply.hint.nPiece, listCells);
+        this->recordEvent(Telemetry::EventHint, reply.hint.nPiece + 1,
+                          listCells.value(0));
+        m_pUi->statusBar->showMessage(
+              tr("Hint: block %1").arg(reply.hint.nPiece + 1), 5000);
+      }
+      break;
+    case SolverCache::NoSolution:
+      m_pUi->statusBar->showMessage(
+            tr("The placed blocks can't be completed to a solution."), 5000);
+      break;
+    default:
+      m_pUi->statusBar->showMessage(
+            tr("No hint available for this board."), 5000);
+      break;
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+void IQPuzzle::updateForcedMoves() {
+  if (NULL == m_pBoard) {
+    return;
+  }
+  QList<int> listPieces;
+  QList<QList<QPoint> > listCells;
+  QList<QPoint> listMarked;
+  QStringList sListReasons;
+  if (!m_pUi->action_ForcedMoves->isChecked() ||
+      !m_pUi->action_ForcedMoves->isEnabled() || m_bSolved) {
+    m_pBoard->showForcedMoves(listPieces, listCells, listMarked,
+                              sListReasons);
+    return;
+  }
+
+  // Placements of the board are generated once per game
+  if (NULL == m_pDeduction) {
+    m_pDeduction = new Deduction(m_pBoard->getDescriptor());
+  }
+  const Solver &solver = m_pDeduction->getSolver();
+  const bool bConsistent(m_pDeduction->update(this->placedPieces()));
+
+  // Later moves may rely on the ones before
+  foreach (const Deduction::Move &move, m_pDeduction->getForcedMoves()) {
+    QList<QPoint> listMoveCells;
+    foreach (const Voxel &v, solver.getPlacements().at(move.nRow).listCells) {
+      listMoveCells << QPoint(v.x, v.y);
+    }
+    QPoint marked(-1, -1);
+    if (move.nCell >= 0) {
+      const Voxel &v = solver.getCells().at(move.nCell);
+      marked = QPoint(v.x, v.y);
+    }
+    switch (move.reason) {
+      case Deduction::OnlyPlacementOfPiece:
+        sListReasons << tr("Block %1 fits only here.").arg(move.nPiece + 1);
+        break;
+      case Deduction::OnlyPlacementOfPocket:
+        sListReasons << tr("Only block %1 fills the marked gap.")
+                        .arg(move.nPiece + 1);
+        break;
+      default:
+        sListReasons << tr("Only block %1 can cover the marked cell.")
+                        .arg(move.nPiece + 1);
+        break;
+    }
+    listPieces << move.nPiece;
+    listCells << listMoveCells;
+    listMarked << marked;
+  }
+
+  if (!bConsistent) {
+    const Deduction::Move &conflict = m_pDeduction->getConflict();
+    QString sReason;
+    switch (conflict.reason) {
+      case Deduction::OnlyPlacementOfPiece:
+        sReason = tr("Block %1 doesn't fit anywhere anymore.")
+                  .arg(conflict.nPiece + 1);
+        break;
+      case Deduction::OnlyPlacementOfPocket:
+        sReason = tr("The marked gap can't be filled.");
+        break;
+      default:
+        sReason = tr("The marked cell can't be covered anymore.");
+        break;
+    }
+    if (conflict.nCell >= 0) {
+      const Voxel &v = solver.getCells().at(conflict.nCell);
+      listPieces << -1;
+      listCells << (QList<QPoint>() << QPoint(v.x, v.y));
+      listMarked << QPoint(v.x, v.y);
+      sListReasons << sReason;
+    }
+    m_pUi->statusBar->showMessage(sReason, 5000);
+  }
+  m_pBoard->showForcedMoves(listPieces, listCells, listMarked, sListReasons);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
 void IQPuzzle::randomGame(const int nChoice) {
   qDebug() << "Random game:" << nChoice;
 
   if (nChoice > 0 && nChoice <= m_sListFiles.size()) {
     if (!m_sListFiles[nChoice-1]->isEmpty()) {
-      int nRand = qrand() % m_sListFiles.at(nChoice-1)->size();
-      if (nRand >= 0 && nRand < m_sListFiles.at(nChoice-1)->size()) {
-        this->startNewGame(m_sSharePath + "/boards/" +
-                           m_sListFiles.at(nChoice-1)->at(nRand));
+      QString sBoard(m_sNextBoard);
+      if (nChoice != m_nNextChoice ||
+          !m_sListFiles.at(nChoice-1)->contains(sBoard)) {
+        sBoard = this->pickRandomBoard(nChoice);
       }
+      this->startNewGame(m_sSharePath + "/boards/" + sBoard);
+      this->prefetchRandomGame(nChoice);
     } else {
       qWarning() << "Game file list is emtpy!";
       QMessageBox::warning(this, qApp->applicationName(),
@@ -401,6 +729,36 @@ void IQPuzzle::randomGame(const int nChoice) {
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
+QString IQPuzzle::pickRandomBoard(const int nChoice) const {
+  if (m_sListFiles.at(nChoice-1)->isEmpty()) {
+    return "";
+  }
+  int nRand = qrand() % m_sListFiles.at(nChoice-1)->size();
+  if (nRand >= 0 && nRand < m_sListFiles.at(nChoice-1)->size()) {
+    return m_sListFiles.at(nChoice-1)->at(nRand);
+  }
+  return "";
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void IQPuzzle::prefetchRandomGame(const int nChoice) {
+  // Choose next random board of the same kind already now and parse it
+  // on a worker thread, so that the next random game starts without delay
+  m_nNextChoice = nChoice;
+  m_sNextBoard = this->pickRandomBoard(nChoice);
+  if (!m_sNextBoard.isEmpty()) {
+    m_futureNextBoard = QtConcurrent::run(
+                          &BoardDescriptor::load,
+                          m_sSharePath + "/boards/" + m_sNextBoard,
+                          QString());
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
 void IQPuzzle::generateFileLists() {
 #if defined _WIN32
   QSettings tmpScore(QSettings::IniFormat, QSettings::UserScope,
@@ -422,6 +780,11 @@ void IQPuzzle::generateFileLists() {
       // qDebug() << sName;
 
       QSettings tmpSet(it.filePath(), QSettings::IniFormat);
+      if (tmpSet.value("Layers", 1).toUInt() > 1 ||  // Filter 3D boxes
+          tmpSet.value("Lattice", SquareLattice::name()).toString() !=
+          Lattice::name()) {  // and boards for other grids
+        continue;
+      }
       quint32 nSolutions = tmpSet.value("PossibleSolutions", 0).toUInt();
       bool bSolved = tmpScore.childGroups().contains(
                        it.fileName().remove(".conf"));
@@ -517,7 +880,9 @@ void IQPuzzle::pauseGame(const bool bPaused) {
       m_pTimer->stop();
       m_pGraphView->setEnabled(false);
       m_pGraphView->setScene(m_pScenePaused);
+      this->recordEvent(Telemetry::EventPause);
     } else {
+      this->recordEvent(Telemetry::EventResume);
       m_pTimer->start();
       m_pGraphView->setEnabled(true);
       m_pGraphView->setScene(m_pBoard);
@@ -557,7 +922,36 @@ void IQPuzzle::setMinWindowSize(const QSize size, const bool bFreestyle) {
 
 void IQPuzzle::incrementMoves() {
   m_nMoves++;
+  m_nHintLevel = 0;
+  m_MoveLog.addSnapshot(m_nMoves, QTime(0, 0, 0).secsTo(m_Time),
+                        m_pBoard->getPieceCells());
   m_pStatusLabelMoves->setText(tr("Moves") + ": " + QString::number(m_nMoves));
+  // Piece may still be reset after a collision
+  if (m_pUi->action_ForcedMoves->isChecked()) {
+    QTimer::singleShot(0, this, SLOT(updateForcedMoves()));
+  }
+  if (m_pRaceLink->isConnected()) {
+    QTimer::singleShot(0, this, SLOT(sendRaceMoves()));
+  }
+}
+
+void IQPuzzle::recordEvent(const int nEvent, const quint16 nPiece,
+                           const QPoint &cell) {
+  if (NULL != m_pTelemetry) {
+    m_pTelemetry->record(m_sTelemetryBoard, Telemetry::Event(nEvent), nPiece,
+                         cell, QTime(0, 0, 0).secsTo(m_Time));
+  }
+}
+
+// Switched in the settings dialog, stops recording at once
+void IQPuzzle::switchTelemetry(const bool bEnabled) {
+  if (bEnabled && NULL == m_pTelemetry) {
+    m_pTelemetry = new Telemetry(m_userDataDir.absolutePath() + "/telemetry",
+                                 m_pSettings->getTelemetryDays(), this);
+  } else if (!bEnabled && NULL != m_pTelemetry) {
+    delete m_pTelemetry;  // Flushes the pending records
+    m_pTelemetry = NULL;
+  }
 }
 
 // ---------------------------------------------------------------------------
@@ -575,6 +969,11 @@ void IQPuzzle::solvedPuzzle() {
   QFileInfo fi(m_sBoardFile);
   m_pTimer->stop();
   m_bSolved = true;
+  this->recordEvent(Telemetry::EventSolved);
+  if (m_pRaceLink->isConnected()) {
+    this->sendRaceMoves();
+    m_pRaceLink->sendSolved(m_nMoves, QTime(0, 0, 0).secsTo(m_Time));
+  }
   QMessageBox::information(this, qApp->applicationName(),
                            tr("Puzzle solved!") + "\n\n" +
                            tr("Moves") + ": " + QString::number(m_nMoves)
@@ -583,12 +982,23 @@ void IQPuzzle::solvedPuzzle() {
   m_pUi->action_PauseGame->setEnabled(false);
   m_pUi->action_PauseGame->setChecked(false);
   m_pUi->action_SaveGame->setEnabled(false);
+  m_pUi->action_Hint->setEnabled(false);
+  m_pUi->action_ForcedMoves->setEnabled(false);
+  m_pUi->action_TidyUp->setEnabled(false);
+  this->updateForcedMoves();
 
   // Save won game state for debugging
   m_pBoard->saveGame(m_userDataDir.absolutePath() + "/S0LV3D.debug",
                      "55:55:55", "10000");
   QFile::remove(m_userDataDir.absolutePath() + "/S0LV3D.debug");
-  emit checkHighscore(fi.baseName(), m_nMoves, m_Time);
+  // Highscore carries the moves, so it can be verified by replay
+  QByteArray moveLog;
+  const BoardDescriptor descriptor(BoardDescriptor::load(m_sBoardFile));
+  if (!descriptor.boardPoly.isEmpty() &&
+      descriptor.sInvalidPolygon.isEmpty()) {
+    moveLog = m_MoveLog.encode(Solver(descriptor));
+  }
+  emit checkHighscore(fi.baseName(), m_nMoves, m_Time, moveLog);
 
   // Update "unsolved lists" for random games
   QString sBoard(m_sBoardFile);
@@ -599,6 +1009,174 @@ void IQPuzzle::solvedPuzzle() {
   m_sListHardUnsolved.removeAt(m_sListHardUnsolved.indexOf(sBoard));
 }
 
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void IQPuzzle::hostRace() {
+  // Opponent plays on another machine: all network interfaces
+  if (!m_pRaceLink->host(RaceLink::DEFAULT_PORT, QHostAddress::Any)) {
+    QMessageBox::warning(this, qApp->applicationName(),
+                         tr("Race could not be started on port %1.")
+                         .arg(RaceLink::DEFAULT_PORT));
+    return;
+  }
+  m_pUi->statusBar->showMessage(tr("Waiting for an opponent on port %1...")
+                                .arg(m_pRaceLink->getPort()));
+  this->updateRaceActions();
+}
+
+void IQPuzzle::joinRace() {
+  bool bOk(false);
+  const QString sHost(QInputDialog::getText(
+                        this, tr("Join race"),
+                        tr("Host of the race (name or address[:port]):"),
+                        QLineEdit::Normal, "localhost", &bOk).trimmed());
+  if (!bOk || sHost.isEmpty()) {
+    return;
+  }
+
+  QString sName(sHost);
+  quint16 nPort(RaceLink::DEFAULT_PORT);
+  const int nColon(sHost.lastIndexOf(':'));
+  if (nColon > 0 && sHost.count(':') == 1) {
+    sName = sHost.left(nColon);
+    nPort = sHost.mid(nColon + 1).toUShort(&bOk);
+    if (!bOk) {
+      QMessageBox::warning(this, qApp->applicationName(),
+                           tr("Invalid port: %1").arg(sHost.mid(nColon + 1)));
+      return;
+    }
+  }
+  m_pRaceLink->join(sName, nPort);
+  m_pUi->statusBar->showMessage(tr("Connecting to %1...").arg(sHost));
+  this->updateRaceActions();
+}
+
+void IQPuzzle::startLoopbackRace() {
+  // Opponent on 127.0.0.1 plays back every own move
+  if (!m_pRaceLink->startLoopback()) {
+    QMessageBox::warning(this, qApp->applicationName(),
+                         tr("Race could not be started on loopback."));
+    return;
+  }
+  this->updateRaceActions();
+}
+
+void IQPuzzle::leaveRace() {
+  m_pRaceLink->leave();
+  m_pRaceDock->hide();
+  m_pUi->statusBar->showMessage(tr("Race ended"), 5000);
+  this->updateRaceActions();
+}
+
+// ---------------------------------------------------------------------------
+
+void IQPuzzle::raceConnected() {
+  m_pUi->statusBar->showMessage(tr("Race started"), 5000);
+  this->updateRaceActions();
+  // Both players start from scratch, the host chooses the board
+  if (m_pRaceLink->isHost() && !m_sBoardFile.isEmpty()) {
+    this->startNewGame(m_sBoardFile);
+  }
+}
+
+void IQPuzzle::raceDisconnected() {
+  m_pRaceDock->hide();
+  m_pUi->statusBar->showMessage(tr("The race was ended by the opponent"));
+  this->updateRaceActions();
+}
+
+void IQPuzzle::joinRaceBoard(const QString &sBoard) {
+  // Name is sent by the opponent: only boards inside the boards folder
+  const QString sBoardsDir(QDir(m_sSharePath + "/boards").canonicalPath());
+  QString sBoardFile;
+  if (!sBoardsDir.isEmpty() && !sBoard.isEmpty() &&
+      !QDir::isAbsolutePath(sBoard) && !sBoard.contains("..")) {
+    sBoardFile = QFileInfo(sBoardsDir + "/" + sBoard).canonicalFilePath();
+  }
+  if (!sBoardFile.startsWith(sBoardsDir + "/") ||
+      !sBoardFile.endsWith(".conf") || !QFileInfo(sBoardFile).isFile()) {
+    qWarning() << "Board of the race not found:" << sBoard;
+    QMessageBox::warning(this, qApp->applicationName(),
+                         tr("The board of the race is not available:") +
+                         "\n" + sBoard);
+    this->leaveRace();
+    return;
+  }
+  this->startNewGame(sBoardFile);
+}
+
+// ---------------------------------------------------------------------------
+
+void IQPuzzle::startRace(const BoardDescriptor &descriptor) {
+  if (!m_pRaceLink->isConnected()) {
+    return;
+  }
+  if (m_pRaceLink->isHost()) {
+    // Opponent only accepts boards of the boards folder
+    const QString sBoardsDir(
+          QDir(m_sSharePath + "/boards").canonicalPath() + "/");
+    const QString sBoardFile(QFileInfo(m_sBoardFile).canonicalFilePath());
+    if (!sBoardFile.startsWith(sBoardsDir)) {
+      QMessageBox::warning(this, qApp->applicationName(),
+                           tr("Only boards of the boards folder can be "
+                              "raced."));
+      this->leaveRace();
+      return;
+    }
+    m_pRaceLink->sendBoard(sBoardFile.mid(sBoardsDir.size()));
+  }
+  m_pRaceView->setBoard(descriptor);
+  m_pRaceDock->show();
+  // All pieces are sent once, the opponent may still show an old game
+  m_listRaceRows.clear();
+  this->sendRaceMoves();
+}
+
+void IQPuzzle::sendRaceMoves() {
+  if (NULL == m_pBoard || !m_pRaceLink->isConnected()) {
+    return;
+  }
+  // Only pieces which changed since the last move
+  const QList<QList<QPoint> > listPieces(m_pBoard->getPieceCells());
+  while (m_listRaceRows.size() < listPieces.size()) {
+    m_listRaceRows << -2;
+  }
+  for (int i = 0; i < listPieces.size(); i++) {
+    int nOrientation(0);
+    int nCell(RaceLink::NO_CELL);
+    const int nRow(m_pRaceView->encodeMove(i, listPieces.at(i),
+                                           &nOrientation, &nCell));
+    if (nRow != m_listRaceRows.at(i)) {
+      m_listRaceRows[i] = nRow;
+      m_pRaceLink->sendMove(i, nOrientation, nCell);
+    }
+  }
+}
+
+void IQPuzzle::opponentSolved(const quint32 nMoves, const quint32 nSeconds) {
+  const QString sResult(tr("Moves") + ": " + QString::number(nMoves) + ", " +
+                        tr("Time") + ": " +
+                        QTime(0, 0, 0).addSecs(nSeconds).toString("hh:mm:ss"));
+  if (m_bSolved) {
+    m_pUi->statusBar->showMessage(tr("Your opponent solved the puzzle, too")
+                                  + " (" + sResult + ")");
+  } else {
+    m_pUi->statusBar->showMessage(tr("Your opponent solved the puzzle first!")
+                                  + " (" + sResult + ")");
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+void IQPuzzle::updateRaceActions() {
+  const bool bActive(m_pRaceLink->isActive());
+  m_pUi->action_RaceHost->setEnabled(!bActive);
+  m_pUi->action_RaceJoin->setEnabled(!bActive);
+  m_pUi->action_RaceLoopback->setEnabled(!bActive);
+  m_pUi->action_RaceLeave->setEnabled(bActive);
+}
+
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
@@ -28,6 +28,9 @@
 #define IQPUZZLE_H_
 
 #include <QtCore>
+#include <QFuture>
+#include <QDockWidget>
+#include <QFutureWatcher>
 #include <QGraphicsTextItem>
 #include <QGraphicsView>
 #include <QtGui>
@@ -36,8 +39,16 @@
 
 #include "./board.h"
 #include "./boarddialog.h"
+#include "./deduction.h"
 #include "./highscore.h"
+#include "./layerview.h"
+#include "./movelog.h"
+#include "./racelink.h"
+#include "./raceview.h"
 #include "./settings.h"
+#include "./shapeindex.h"
+#include "./solverdaemon.h"
+#include "./telemetry.h"
 
 namespace Ui {
 class IQPuzzle;
@@ -68,10 +79,11 @@ class IQPuzzle : public QMainWindow {
     void updateUiLang();
     void showHighscore(const QString &sBoard);
     void checkHighscore(const QString &sBoard, const quint32 nMoves,
-                        const QTime tTime);
+                        const QTime tTime, const QByteArray &moveLog);
 
  private slots:
     void loadLanguage(const QString &sLang);
+    void switchTelemetry(const bool bEnabled);
     void startNewGame(QString sBoardFile = "", const QString &sSavedGame = "",
                       const QString &sTime = "", const QString &sMoves = "");
     QString chooseBoard();
@@ -83,17 +95,39 @@ class IQPuzzle : public QMainWindow {
     void pauseGame(const bool bPaused);
     void updateTimer();
     void solvedPuzzle();
+    void builtShape(const QList<QPoint> &listCells, const quint16 nBlocks);
+    void showHint();
+    void hintReady();
+    void updateForcedMoves();
     void showHighscore();
     void showStatistics();
     void reportBug() const;
     void showInfoBox();
+    void hostRace();
+    void joinRace();
+    void startLoopbackRace();
+    void leaveRace();
+    void raceConnected();
+    void raceDisconnected();
+    void joinRaceBoard(const QString &sBoard);
+    void sendRaceMoves();
+    void opponentSolved(const quint32 nMoves, const quint32 nSeconds);
+    void recordEvent(const int nEvent, const quint16 nPiece = 0,
+                     const QPoint &cell = QPoint());
 
  private:
     bool switchTranslator(QTranslator *translator, const QString &sFile,
                           const QString &sPath = "");
     void setupMenu();
     void setGameTitle();
+    void playLayers(const QString &sBoardFile);
     void generateFileLists();
+    QString pickRandomBoard(const int nChoice) const;
+    void prefetchRandomGame(const int nChoice);
+    void queryHint(const int nCommand);
+    QList<Solver::Placement> placedPieces() const;
+    void startRace(const BoardDescriptor &descriptor);
+    void updateRaceActions();
 
     Ui::IQPuzzle *m_pUi;
     QTranslator m_translator;  // App translations
@@ -114,6 +148,7 @@ class IQPuzzle : public QMainWindow {
     QString m_sSavedMoves;
     QTime m_Time;
     QTimer *m_pTimer;
+    MoveLog m_MoveLog;
     QGraphicsTextItem *m_pTextPaused;
     bool m_bSolved;
     Highscore *m_pHighscore;
@@ -129,6 +164,22 @@ class IQPuzzle : public QMainWindow {
     QStringList m_sListMediumUnsolved;
     QStringList m_sListHard;
     QStringList m_sListHardUnsolved;
+
+    int m_nNextChoice;
+    QString m_sNextBoard;
+    QFuture<BoardDescriptor> m_futureNextBoard;
+    QFuture<ShapeIndex> m_futureShapeIndex;
+    QFutureWatcher<SolverDaemon::Reply> *m_pHintWatcher;
+    QString m_sHintBoard;
+    int m_nHintLevel;
+    int m_nHintCommand;
+    Deduction *m_pDeduction;  // Created when forced moves are shown
+    RaceLink *m_pRaceLink;
+    RaceView *m_pRaceView;  // Opponent's board
+    QDockWidget *m_pRaceDock;
+    QList<int> m_listRaceRows;  // Last row sent per piece, -2 = not sent
+    Telemetry *m_pTelemetry;  // NULL if switched off in the settings
+    QString m_sTelemetryBoard;
 };
 
 #endif  // IQPUZZLE_H_
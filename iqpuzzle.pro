@@ -37,31 +37,104 @@ OBJECTS_DIR   = ./.objs
 UI_DIR        = ./.ui
 RCC_DIR       = ./.rcc
 
-QT           += core gui
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+# QAtomicInteger<quint64> (transposition table) needs Qt 5.3
+lessThan(QT_MAJOR_VERSION, 5): error("iQPuzzle requires Qt 5.3 or newer")
+equals(QT_MAJOR_VERSION, 5): lessThan(QT_MINOR_VERSION, 3) {
+  error("iQPuzzle requires Qt 5.3 or newer")
+}
+
+QT           += core gui widgets concurrent network
 
 DEFINES      += QT_DEPRECATED_WARNINGS
 
+# Grid geometry for polyiamonds / polyhexes: qmake CONFIG+=lattice_triangle
+# The boards of a lattice (data/lattice/) are only installed with its build,
+# the default (square) build can't play them.
+lattice_triangle {
+  DEFINES      += LATTICE_TRIANGLE
+  LATTICE_DATA  = data/lattice/triangle/polyiamonds
+}
+lattice_hex {
+  DEFINES      += LATTICE_HEX
+  LATTICE_DATA  = data/lattice/hex/polyhexes
+}
+
 SOURCES      += main.cpp\
                 iqpuzzle.cpp \
                 board.cpp \
                 block.cpp \
+                boarddescriptor.cpp \
                 boarddialog.cpp \
+                cellmap.cpp \
+                commandline.cpp \
+                deduction.cpp \
+                exactcover.cpp \
+                gamestate.cpp \
                 highscore.cpp \
-                settings.cpp
+                layerview.cpp \
+                loadgenerator.cpp \
+                movelog.cpp \
+                piecelayout.cpp \
+                polycube.cpp \
+                profilecounter.cpp \
+                puzzleserver.cpp \
+                racelink.cpp \
+                raceview.cpp \
+                sessionstore.cpp \
+                settings.cpp \
+                shapeindex.cpp \
+                solver.cpp \
+                solvercache.cpp \
+                solverdaemon.cpp \
+                telemetry.cpp \
+                transpositiontable.cpp \
+                zdd.cpp
 
 HEADERS      += iqpuzzle.h \
                 board.h \
                 block.h \
+                boarddescriptor.h \
                 boarddialog.h \
+                cellmap.h \
+                commandline.h \
+                deduction.h \
+                exactcover.h \
+                gamestate.h \
                 highscore.h \
-                settings.h
+                layerview.h \
+                lattice.h \
+                loadgenerator.h \
+                movelog.h \
+                piecelayout.h \
+                polycube.h \
+                profilecounter.h \
+                protocol.h \
+                puzzleserver.h \
+                racelink.h \
+                raceview.h \
+                sessionstore.h \
+                settings.h \
+                shapeindex.h \
+                solver.h \
+                solvercache.h \
+                solverdaemon.h \
+                telemetry.h \
+                transpositiontable.h \
+                zdd.h
 
 FORMS        += iqpuzzle.ui \
                 settings.ui
 
 RESOURCES     = res/iqpuzzle_resources.qrc \
                 res/translations.qrc
+
+# Scripted bots (--script, command line only) need QtQml, skipped without it
+qtHaveModule(qml) {
+  QT      += qml
+  DEFINES += SCRIPT_SUPPORT
+  SOURCES += scriptboard.cpp
+  HEADERS += scriptboard.h
+}
 win32:RC_FILE = res/iqpuzzle_win.rc
 os2:RC_FILE   = res/iqpuzzle_os2.rc
 
@@ -77,6 +150,12 @@ macx {
   BOARDS_DATA.path   = Contents/Resources
   BOARDS_DATA.files += data/boards
   QMAKE_BUNDLE_DATA += BOARDS_DATA
+
+  !isEmpty(LATTICE_DATA) {
+    LATTICE_BOARDS.path   = Contents/Resources/boards
+    LATTICE_BOARDS.files += $$LATTICE_DATA
+    QMAKE_BUNDLE_DATA    += LATTICE_BOARDS
+  }
 }
 
 unix: !macx {
@@ -108,6 +187,12 @@ unix: !macx {
     meta.path      = $$PREFIX/share/metainfo
     meta.files    += res/iqpuzzle.appdata.xml
 
+    !isEmpty(LATTICE_DATA) {
+        lattice.path   = $$PREFIX/share/iqpuzzle/boards
+        lattice.files += $$LATTICE_DATA
+        INSTALLS      += lattice
+    }
+
     INSTALLS      += target \
                      data \
                      desktop \
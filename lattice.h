@@ -0,0 +1,455 @@
+/**
+ * \file lattice.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Grid geometry (square, triangular and hexagonal lattice).
+ *
+ * The lattice is chosen at compile time (qmake CONFIG+=lattice_triangle
+ * or CONFIG+=lattice_hex), so all calls are inlined and the square grid
+ * keeps its plain integer arithmetic.
+ *
+ * Coordinates used:
+ * - Lattice: board files (polygon points, start positions). Triangular
+ *   and hexagonal lattices use a skewed basis (1, 0) and (1/2, sqrt(3)/2).
+ * - Plane: lattice coordinates mapped to cartesian grid units (scene
+ *   coordinates divided by grid size).
+ * - Cell keys: integer cell ids used by CellMap, ShapeIndex and Solver.
+ *   A translation by a lattice vector adds keyOffset() to every key.
+ */
+
+#ifndef LATTICE_H_
+#define LATTICE_H_
+
+#include <limits.h>
+
+#include <QList>
+#include <QPoint>
+#include <QPointF>
+#include <QVector>
+#include <qmath.h>
+
+#include "./cellmap.h"
+
+/**
+ * \struct SquareLattice
+ * \brief Square grid, cell key = top left corner.
+ */
+struct SquareLattice {
+  static const int ROTATIONS = 4;  // Rotation step 90 degree
+  static const bool IS_SQUARE = true;
+
+  static const char *name() {
+    return "square";
+  }
+
+  static QPointF toPlane(const QPointF &p) {
+    return p;
+  }
+  static QPointF fromPlane(const QPointF &p) {
+    return p;
+  }
+
+  // Nearest translation (lattice coordinates) for a plane point
+  static QPoint snap(const QPointF &p) {
+    return QPoint(qRound(p.x()), qRound(p.y()));
+  }
+  static QPoint keyOffset(const QPoint &translation) {
+    return translation;
+  }
+  static bool isTranslation(const QPoint &keyOffset) {
+    Q_UNUSED(keyOffset);
+    return true;
+  }
+  // Key of the cell containing a plane point
+  static QPoint cellAt(const QPointF &p) {
+    return QPoint(qFloor(p.x()), qFloor(p.y()));
+  }
+  // Translation which moves a cell key onto the origin cell(s)
+  static QPoint translationOf(const QPoint &key) {
+    return key;
+  }
+
+  // nSym < 2 * ROTATIONS: rotations, mirrored rotations
+  static QPoint transformCell(const QPoint &key, const int nSym) {
+    int x(nSym >= ROTATIONS ? -key.x() - 1 : key.x());
+    int y(key.y());
+    for (int i = 0; i < nSym % ROTATIONS; i++) {
+      const int nTmp(x);
+      x = -y - 1;
+      y = nTmp;
+    }
+    return QPoint(x, y);
+  }
+
+  // Lattice step for arrow key direction (-1/0/1, -1/0/1)
+  static QPoint arrowStep(const QPoint &direction) {
+    return direction;
+  }
+
+  static QList<QPoint> neighbours(const QPoint &key) {
+    QList<QPoint> list;
+    list << key + QPoint(1, 0) << key + QPoint(-1, 0)
+         << key + QPoint(0, 1) << key + QPoint(0, -1);
+    return list;
+  }
+
+  static bool checkCorner(const QPointF &p0, const QPointF &p1,
+                          const QPointF &p2) {
+    return (p0.x() == p1.x() && p1.y() == p2.y()) ||
+        (p0.y() == p1.y() && p1.x() == p2.x());
+  }
+
+  static QList<QPoint> cells(const QVector<QPointF> &planePolygon) {
+    return CellMap::rasterize(planePolygon);
+  }
+
+  static QVector<QPointF> cellPolygon(const QPoint &key) {
+    QVector<QPointF> poly;
+    poly << QPointF(key.x(), key.y()) << QPointF(key.x() + 1, key.y())
+         << QPointF(key.x() + 1, key.y() + 1)
+         << QPointF(key.x(), key.y() + 1) << QPointF(key.x(), key.y());
+    return poly;
+  }
+};
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+/**
+ * \struct TriangularBase
+ * \brief Common geometry of triangle and hexagon grid.
+ *
+ * Polygon points of both lie on the triangular lattice.
+ */
+struct TriangularBase {
+  static const int ROTATIONS = 6;  // Rotation step 60 degree
+  static const bool IS_SQUARE = false;
+
+  static qreal height() {
+    return 0.8660254037844386;  // sqrt(3) / 2
+  }
+
+  static QPointF toPlane(const QPointF &p) {
+    return QPointF(p.x() + p.y() / 2, p.y() * height());
+  }
+  static QPointF fromPlane(const QPointF &p) {
+    const qreal y(p.y() / height());
+    return QPointF(p.x() - y / 2, y);
+  }
+
+  // Rotation by 60 degree (and mirroring) of a lattice vector
+  static QPoint transformVector(const QPoint &v, const int nSym) {
+    int x(nSym >= ROTATIONS ? v.y() : v.x());
+    int y(nSym >= ROTATIONS ? v.x() : v.y());
+    for (int i = 0; i < nSym % ROTATIONS; i++) {
+      const int nTmp(x);
+      x = -y;
+      y = nTmp + y;
+    }
+    return QPoint(x, y);
+  }
+
+  static bool isDirection(const QPointF &d) {
+    return (0 != d.x() || 0 != d.y()) &&
+        (0 == d.x() || 0 == d.y() || d.x() == -d.y());
+  }
+
+  static bool checkCorner(const QPointF &p0, const QPointF &p1,
+                          const QPointF &p2) {
+    const QPointF d1(p1 - p0);
+    const QPointF d2(p2 - p1);
+    return isDirection(d1) && isDirection(d2) &&
+        0 != d1.x() * d2.y() - d1.y() * d2.x();  // Not collinear
+  }
+
+  static QVector<QPointF> toPlanePolygon(const QVector<QPointF> &polygon) {
+    QVector<QPointF> plane;
+    plane.reserve(polygon.size());
+    foreach (const QPointF &p, polygon) {
+      plane << toPlane(p);
+    }
+    return plane;
+  }
+
+  static void latticeBounds(const QVector<QPointF> &planePolygon,
+                            QPoint *pMin, QPoint *pMax) {
+    *pMin = QPoint(INT_MAX, INT_MAX);
+    *pMax = QPoint(INT_MIN, INT_MIN);
+    foreach (const QPointF &p, planePolygon) {
+      const QPointF l(fromPlane(p));
+      pMin->setX(qMin(pMin->x(), qFloor(l.x())));
+      pMin->setY(qMin(pMin->y(), qFloor(l.y())));
+      pMax->setX(qMax(pMax->x(), qCeil(l.x())));
+      pMax->setY(qMax(pMax->y(), qCeil(l.y())));
+    }
+  }
+
+  static int floorDiv(const int n, const int d) {
+    return (n >= 0) ? n / d : -((-n + d - 1) / d);
+  }
+};
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+/**
+ * \struct TriangleLattice
+ * \brief Triangle grid (polyiamonds).
+ *
+ * Cell key = (2 * x + t, y) of the lattice parallelogram (x, y), t = 0 for
+ * the upper left triangle, t = 1 for the lower right one.
+ */
+struct TriangleLattice : public TriangularBase {
+  static const char *name() {
+    return "triangle";
+  }
+
+  static QPoint snap(const QPointF &p) {
+    const QPointF l(fromPlane(p));
+    return QPoint(qRound(l.x()), qRound(l.y()));
+  }
+  static QPoint keyOffset(const QPoint &translation) {
+    return QPoint(2 * translation.x(), translation.y());
+  }
+  static bool isTranslation(const QPoint &keyOffset) {
+    return 0 == (keyOffset.x() & 1);
+  }
+  static QPoint cellAt(const QPointF &p) {
+    // Diagonal of the parallelogram separates upper and lower triangle
+    const QPointF l(fromPlane(p));
+    const int x(qFloor(l.x()));
+    const int y(qFloor(l.y()));
+    const int t((l.x() - x) + (l.y() - y) < 1 ? 0 : 1);
+    return QPoint(2 * x + t, y);
+  }
+  static QPoint translationOf(const QPoint &key) {
+    return QPoint(key.x() & ~1, key.y());
+  }
+
+  static QPoint transformCell(const QPoint &key, const int nSym) {
+    // Centroid * 3 is an integer lattice vector
+    const int t(key.x() & 1);
+    const QPoint c(transformVector(
+                     QPoint(3 * (key.x() >> 1) + 1 + t, 3 * key.y() + 1 + t),
+                     nSym));
+    const int nX(floorDiv(c.x(), 3));
+    return QPoint(2 * nX + (c.x() - 3 * nX - 1), floorDiv(c.y(), 3));
+  }
+
+  static QPoint arrowStep(const QPoint &direction) {
+    return direction;
+  }
+
+  static QList<QPoint> neighbours(const QPoint &key) {
+    // Upper triangle: right, left, above - lower one: left, right, below
+    const int nDir((key.x() & 1) ? -1 : 1);
+    QList<QPoint> list;
+    list << key + QPoint(nDir, 0) << key + QPoint(-nDir, 0)
+         << key + QPoint(nDir, -nDir);
+    return list;
+  }
+
+  static QList<QPoint> cells(const QVector<QPointF> &planePolygon) {
+    QList<QPoint> listCells;
+    QPoint min;
+    QPoint max;
+    latticeBounds(planePolygon, &min, &max);
+    for (int y = min.y(); y < max.y(); y++) {
+      for (int x = min.x(); x < max.x(); x++) {
+        for (int t = 0; t < 2; t++) {
+          const qreal d((1 + t) / 3.0);
+          if (CellMap::containsPoint(planePolygon,
+                                     toPlane(QPointF(x + d, y + d)))) {
+            listCells << QPoint(2 * x + t, y);
+          }
+        }
+      }
+    }
+    return listCells;
+  }
+
+  static QVector<QPointF> cellPolygon(const QPoint &key) {
+    const int x(key.x() >> 1);
+    const int y(key.y());
+    QVector<QPointF> poly;
+    if (0 == (key.x() & 1)) {
+      poly << QPointF(x, y) << QPointF(x + 1, y) << QPointF(x, y + 1);
+    } else {
+      poly << QPointF(x + 1, y) << QPointF(x + 1, y + 1)
+           << QPointF(x, y + 1);
+    }
+    poly << poly.first();
+    return toPlanePolygon(poly);
+  }
+};
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+/**
+ * \struct HexLattice
+ * \brief Hexagon grid (polyhexes).
+ *
+ * Cell key = hexagon center (x, y) with (x - y) divisible by 3, the
+ * corners are the six neighbouring lattice points.
+ */
+struct HexLattice : public TriangularBase {
+  static const char *name() {
+    return "hex";
+  }
+
+  static QPoint snap(const QPointF &p) {
+    // Nearest hexagon center
+    const QPointF l(fromPlane(p));
+    QPoint best(qFloor(l.x()), qFloor(l.y()));
+    qreal dBest(-1);
+    for (int y = qFloor(l.y()) - 1; y <= qFloor(l.y()) + 2; y++) {
+      for (int x = qFloor(l.x()) - 1; x <= qFloor(l.x()) + 2; x++) {
+        if (0 == (x - y) % 3) {
+          const QPointF d(toPlane(QPointF(x, y)) - p);
+          const qreal dDist(d.x() * d.x() + d.y() * d.y());
+          if (dBest < 0 || dDist < dBest) {
+            dBest = dDist;
+            best = QPoint(x, y);
+          }
+        }
+      }
+    }
+    return best;
+  }
+  static QPoint keyOffset(const QPoint &translation) {
+    return translation;
+  }
+  static bool isTranslation(const QPoint &keyOffset) {
+    return 0 == (keyOffset.x() - keyOffset.y()) % 3;
+  }
+  static QPoint cellAt(const QPointF &p) {
+    return snap(p);  // Hexagon of the nearest center
+  }
+  static QPoint translationOf(const QPoint &key) {
+    return key;
+  }
+
+  static QPoint transformCell(const QPoint &key, const int nSym) {
+    return transformVector(key, nSym);
+  }
+
+  static QPoint arrowStep(const QPoint &direction) {
+    // Left/right: upper left and lower right neighbour, up/down: vertical
+    return QPoint(direction.x() - direction.y(),
+                  direction.x() + 2 * direction.y());
+  }
+
+  static QList<QPoint> neighbours(const QPoint &key) {
+    QList<QPoint> list;
+    list << key + QPoint(1, 1) << key + QPoint(-1, -1)
+         << key + QPoint(2, -1) << key + QPoint(-2, 1)
+         << key + QPoint(1, -2) << key + QPoint(-1, 2);
+    return list;
+  }
+
+  static QList<QPoint> cells(const QVector<QPointF> &planePolygon) {
+    QList<QPoint> listCells;
+    QPoint min;
+    QPoint max;
+    latticeBounds(planePolygon, &min, &max);
+    for (int y = min.y(); y <= max.y(); y++) {
+      for (int x = min.x(); x <= max.x(); x++) {
+        if (0 == (x - y) % 3 &&
+            CellMap::containsPoint(planePolygon, toPlane(QPointF(x, y)))) {
+          listCells << QPoint(x, y);
+        }
+      }
+    }
+    return listCells;
+  }
+
+  static QVector<QPointF> cellPolygon(const QPoint &key) {
+    static const int nCorners[7][2] = {{1, 0}, {0, 1}, {-1, 1}, {-1, 0},
+                                       {0, -1}, {1, -1}, {1, 0}};
+    QVector<QPointF> poly;
+    for (int i = 0; i < 7; i++) {
+      poly << QPointF(key.x() + nCorners[i][0], key.y() + nCorners[i][1]);
+    }
+    return toPlanePolygon(poly);
+  }
+};
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+#if defined(LATTICE_TRIANGLE)
+typedef TriangleLattice Lattice;
+#elif defined(LATTICE_HEX)
+typedef HexLattice Lattice;
+#else
+typedef SquareLattice Lattice;
+#endif
+
+/**
+ * \brief Polygon in lattice coordinates mapped to plane coordinates.
+ */
+inline QVector<QPointF> planePolygon(const QVector<QPointF> &polygon) {
+  QVector<QPointF> plane;
+  plane.reserve(polygon.size());
+  foreach (const QPointF &p, polygon) {
+    plane << Lattice::toPlane(p);
+  }
+  return plane;
+}
+
+/**
+ * \brief Cell keys of a polygon given in lattice coordinates.
+ */
+inline QList<QPoint> latticeCells(const QVector<QPointF> &polygon) {
+  return Lattice::cells(planePolygon(polygon));
+}
+
+/**
+ * \brief Sorts cells row by row and moves the first one to the origin.
+ *
+ * Result is equal for all translated copies of a shape.
+ */
+inline void normalizeCells(QList<QPoint> *pListCells) {
+  if (pListCells->isEmpty()) {
+    return;
+  }
+  QList<quint64> listSorted;
+  listSorted.reserve(pListCells->size());
+  foreach (const QPoint &cell, *pListCells) {
+    listSorted << ((quint64(quint32(cell.y() + 0x40000000)) << 32) |
+                   quint32(cell.x() + 0x40000000));
+  }
+  qSort(listSorted);
+
+  const QPoint first(int(quint32(listSorted.first())) - 0x40000000,
+                     int(quint32(listSorted.first() >> 32)) - 0x40000000);
+  const QPoint offset(Lattice::translationOf(first));
+  pListCells->clear();
+  foreach (quint64 n, listSorted) {
+    pListCells->append(QPoint(int(quint32(n)) - 0x40000000 - offset.x(),
+                              int(quint32(n >> 32)) - 0x40000000 -
+                              offset.y()));
+  }
+}
+
+#endif  // LATTICE_H_
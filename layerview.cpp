@@ -0,0 +1,387 @@
+/**
+ * \file layerview.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Playing 3D boxes layer by layer.
+ */
+
+#include "./layerview.h"
+
+#include <QCursor>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QTransform>
+
+#include "./lattice.h"
+
+LayerView::LayerView(QWidget *pParent)
+  : QWidget(pParent),
+    m_pSolver(NULL),
+    m_nLayers(0),
+    m_nLayer(0),
+    m_nPiece(0),
+    m_nHoverCell(-1) {
+  this->setMinimumSize(240, 200);
+  this->setFocusPolicy(Qt::StrongFocus);
+  this->setMouseTracking(true);
+}
+
+LayerView::~LayerView() {
+  delete m_pSolver;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool LayerView::setBoard(const BoardDescriptor &descriptor) {
+  delete m_pSolver;
+  m_pSolver = NULL;
+  m_State = GameState();
+  m_listOrientations.clear();
+  m_listOrientation.clear();
+  m_listCellOwner.clear();
+  m_listPieceColors.clear();
+  m_nLayers = 0;
+  m_nLayer = 0;
+  m_nPiece = 0;
+  m_nHoverCell = -1;
+  m_sMessage.clear();
+  if (descriptor.boardPoly.isEmpty() ||
+      !descriptor.sInvalidPolygon.isEmpty() || descriptor.nLayers < 2) {
+    this->layoutCells();
+    return false;
+  }
+
+  m_pSolver = new Solver(descriptor);
+  if (0 == m_pSolver->getNumOfPieces()) {
+    delete m_pSolver;
+    m_pSolver = NULL;
+    this->layoutCells();
+    return false;
+  }
+  m_State = GameState(m_pSolver);
+  m_nLayers = descriptor.nLayers;
+  for (int i = 0; i < m_pSolver->getNumOfPieces(); i++) {
+    m_listOrientations << QList<int>();
+    m_listOrientation << 0;
+    m_listPieceColors << readColor(descriptor,
+                                   "Block" + QString::number(i + 1) + "/Color",
+                                   Qt::gray);
+  }
+  foreach (const Solver::Placement &placement, m_pSolver->getPlacements()) {
+    if (!m_listOrientations.at(placement.nPiece).contains(
+          placement.nOrientation)) {
+      m_listOrientations[placement.nPiece] << placement.nOrientation;
+    }
+  }
+  for (int i = 0; i < m_listOrientations.size(); i++) {
+    qSort(m_listOrientations[i]);
+  }
+  m_listCellOwner.fill(-1, m_pSolver->getCells().size());
+
+  m_rectPlane = QRectF();
+  foreach (const Voxel &v, m_pSolver->getCells()) {
+    m_rectPlane |= QPolygonF(
+          Lattice::cellPolygon(QPoint(v.x, v.y))).boundingRect();
+  }
+  m_bgColor = readColor(descriptor, "BGColor", Qt::white);
+  m_boardColor = readColor(descriptor, "Board/Color", Qt::lightGray);
+  m_gridColor = readColor(descriptor, "Board/GridColor", Qt::darkGray);
+
+  this->layoutCells();
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+
+QColor LayerView::readColor(const BoardDescriptor &descriptor,
+                            const QString &sKey, const QColor &fallback) {
+  const QColor color(descriptor.hashColors.value(sKey, ""));
+  return color.isValid() ? color : fallback;
+}
+
+// ---------------------------------------------------------------------------
+
+// Same x/y position for the cells of all layers, status lines on top
+void LayerView::layoutCells() {
+  m_listCellPolys.clear();
+  const int nStatus(2 * this->fontMetrics().lineSpacing() + 8);
+  m_rectBoard = this->rect().adjusted(0, nStatus, 0, 0);
+  if (NULL == m_pSolver || m_rectPlane.isEmpty() ||
+      m_rectBoard.height() <= 0) {
+    this->update();
+    return;
+  }
+
+  const qreal dMargin(8);
+  const qreal dScale(qMin((m_rectBoard.width() - 2 * dMargin) /
+                          m_rectPlane.width(),
+                          (m_rectBoard.height() - 2 * dMargin) /
+                          m_rectPlane.height()));
+  QTransform transform;
+  transform.translate(m_rectBoard.center().x(), m_rectBoard.center().y());
+  transform.scale(dScale, dScale);
+  transform.translate(-m_rectPlane.center().x(), -m_rectPlane.center().y());
+  foreach (const Voxel &v, m_pSolver->getCells()) {
+    m_listCellPolys << transform.map(
+                         QPolygonF(Lattice::cellPolygon(QPoint(v.x, v.y))));
+  }
+  this->update();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// Solver cell on the shown layer at a widget position, -1 if none
+int LayerView::cellAt(const QPoint &pos) const {
+  if (NULL == m_pSolver) {
+    return -1;
+  }
+  for (int i = 0; i < m_listCellPolys.size(); i++) {
+    if (m_nLayer == m_pSolver->getCells().at(i).z &&
+        m_listCellPolys.at(i).containsPoint(pos, Qt::OddEvenFill)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Row of the selected piece anchored on the hovered cell, -1 if none
+int LayerView::hoverRow() const {
+  if (NULL == m_pSolver || m_nHoverCell < 0 ||
+      m_listOrientations.at(m_nPiece).isEmpty()) {
+    return -1;
+  }
+  return m_pSolver->findAnchorRow(
+        m_nPiece, m_listOrientations.at(m_nPiece).at(
+          m_listOrientation.at(m_nPiece)), m_nHoverCell);
+}
+
+// ---------------------------------------------------------------------------
+
+void LayerView::selectPiece(const int nPiece) {
+  if (NULL != m_pSolver && nPiece >= 0 &&
+      nPiece < m_pSolver->getNumOfPieces()) {
+    m_nPiece = nPiece;
+    m_sMessage.clear();
+    this->update();
+  }
+}
+
+void LayerView::showLayer(const int nLayer) {
+  if (nLayer >= 0 && nLayer < m_nLayers && nLayer != m_nLayer) {
+    m_nLayer = nLayer;
+    m_nHoverCell = this->cellAt(this->mapFromGlobal(QCursor::pos()));
+    this->update();
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+void LayerView::placePiece(const int nPiece, const int nRow) {
+  switch (m_State.placeRow(nPiece, nRow)) {
+    case GameState::MoveSolved:
+      m_sMessage = tr("Solved with %1 moves!").arg(m_State.getMoves());
+      break;
+    case GameState::MoveBlocked:
+      m_sMessage = tr("Blocked by another piece");
+      return;
+    case GameState::MoveInvalid:
+      m_sMessage = tr("Piece doesn't fit here");
+      return;
+    default:
+      m_sMessage.clear();
+      break;
+  }
+
+  m_listCellOwner.fill(-1);
+  for (int i = 0; i < m_pSolver->getNumOfPieces(); i++) {
+    if (m_State.getRow(i) >= 0) {
+      foreach (int nCell, m_pSolver->getRowCells(m_State.getRow(i))) {
+        m_listCellOwner[nCell] = i;
+      }
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool LayerView::focusNextPrevChild(bool bNext) {
+  Q_UNUSED(bNext);
+  return false;  // Tab selects pieces
+}
+
+void LayerView::keyPressEvent(QKeyEvent *pEvent) {
+  if (NULL == m_pSolver) {
+    QWidget::keyPressEvent(pEvent);
+    return;
+  }
+  const int nPieces(m_pSolver->getNumOfPieces());
+  switch (pEvent->key()) {
+    case Qt::Key_PageUp:
+      this->showLayer(m_nLayer + 1);
+      break;
+    case Qt::Key_PageDown:
+      this->showLayer(m_nLayer - 1);
+      break;
+    case Qt::Key_Tab:
+      this->selectPiece((m_nPiece + 1) % nPieces);
+      break;
+    case Qt::Key_Backtab:
+      this->selectPiece((m_nPiece + nPieces - 1) % nPieces);
+      break;
+    case Qt::Key_R:
+      if (!m_listOrientations.at(m_nPiece).isEmpty()) {
+        const int nCount(m_listOrientations.at(m_nPiece).size());
+        const int nStep(pEvent->modifiers() & Qt::ShiftModifier ? -1 : 1);
+        m_listOrientation[m_nPiece] =
+            (m_listOrientation.at(m_nPiece) + nCount + nStep) % nCount;
+        this->update();
+      }
+      break;
+    case Qt::Key_Delete:
+      this->placePiece(m_nPiece, -1);
+      this->update();
+      break;
+    default:
+      if (pEvent->key() >= Qt::Key_1 && pEvent->key() <= Qt::Key_9) {
+        this->selectPiece(pEvent->key() - Qt::Key_1);
+      } else {
+        QWidget::keyPressEvent(pEvent);
+      }
+      break;
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+void LayerView::mousePressEvent(QMouseEvent *pEvent) {
+  const int nCell(this->cellAt(pEvent->pos()));
+  if (nCell < 0) {
+    return;
+  }
+  if (Qt::LeftButton == pEvent->button()) {
+    const int nRow(this->hoverRow());
+    if (nRow < 0) {
+      m_sMessage = tr("Piece doesn't fit here");
+    } else {
+      this->placePiece(m_nPiece, nRow);
+    }
+  } else if (Qt::RightButton == pEvent->button() &&
+             m_listCellOwner.at(nCell) >= 0) {
+    m_nPiece = m_listCellOwner.at(nCell);
+    this->placePiece(m_nPiece, -1);
+  }
+  this->update();
+}
+
+void LayerView::mouseMoveEvent(QMouseEvent *pEvent) {
+  const int nCell(this->cellAt(pEvent->pos()));
+  if (nCell != m_nHoverCell) {
+    m_nHoverCell = nCell;
+    this->update();
+  }
+}
+
+void LayerView::leaveEvent(QEvent *pEvent) {
+  QWidget::leaveEvent(pEvent);
+  m_nHoverCell = -1;
+  this->update();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+QString LayerView::statusText() const {
+  QString sStatus(tr("Layer %1/%2").arg(m_nLayer + 1).arg(m_nLayers));
+  sStatus += "    " + tr("Piece %1/%2").arg(m_nPiece + 1).arg(
+               m_pSolver->getNumOfPieces());
+  const QList<int> &listOrientations(m_listOrientations.at(m_nPiece));
+  if (!listOrientations.isEmpty()) {
+    sStatus += "    " + tr("Orientation %1/%2").arg(
+                 m_listOrientation.at(m_nPiece) + 1).arg(
+                 listOrientations.size());
+  }
+  sStatus += "    " + tr("Moves") + ": " +
+             QString::number(m_State.getMoves());
+  return sStatus;
+}
+
+// ---------------------------------------------------------------------------
+
+void LayerView::paintEvent(QPaintEvent *pEvent) {
+  Q_UNUSED(pEvent);
+  QPainter painter(this);
+  painter.fillRect(this->rect(), NULL == m_pSolver ?
+                     this->palette().window().color() : m_bgColor);
+  if (NULL == m_pSolver) {
+    return;
+  }
+
+  // Status: swatch of the selected piece, layer/piece/orientation
+  const int nLine(this->fontMetrics().lineSpacing());
+  painter.setPen(Qt::black);
+  painter.setBrush(m_listPieceColors.at(m_nPiece));
+  painter.drawRect(4, 4, nLine - 2, nLine - 2);
+  painter.drawText(QRect(nLine + 8, 4, this->width() - nLine - 12, nLine),
+                   Qt::AlignLeft | Qt::AlignVCenter, this->statusText());
+  if (!m_sMessage.isEmpty()) {
+    painter.drawText(QRect(4, 4 + nLine, this->width() - 8, nLine),
+                     Qt::AlignLeft | Qt::AlignVCenter, m_sMessage);
+  }
+
+  for (int i = 0; i < m_listCellPolys.size(); i++) {
+    if (m_nLayer == m_pSolver->getCells().at(i).z) {
+      const int nOwner(m_listCellOwner.at(i));
+      painter.setPen(m_gridColor);
+      painter.setBrush(nOwner < 0 ? m_boardColor :
+                                    m_listPieceColors.at(nOwner));
+      painter.drawPolygon(m_listCellPolys.at(i));
+    }
+  }
+
+  // Preview of the selected piece on the shown layer, red if blocked
+  const int nRow(this->hoverRow());
+  if (nRow >= 0) {
+    QColor color(m_listPieceColors.at(m_nPiece));
+    color.setAlpha(128);
+    painter.setBrush(color);
+    painter.setPen(QPen(m_State.canPlace(m_nPiece, nRow) ? Qt::black :
+                                                           Qt::red, 2));
+    foreach (int nCell, m_pSolver->getRowCells(nRow)) {
+      if (m_nLayer == m_pSolver->getCells().at(nCell).z) {
+        painter.drawPolygon(m_listCellPolys.at(nCell));
+      }
+    }
+  }
+}
+
+void LayerView::resizeEvent(QResizeEvent *pEvent) {
+  QWidget::resizeEvent(pEvent);
+  this->layoutCells();
+}
+
+QSize LayerView::sizeHint() const {
+  return QSize(400, 360);
+}
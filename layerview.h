@@ -0,0 +1,100 @@
+/**
+ * \file layerview.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for playing 3D boxes layer by layer.
+ */
+
+#ifndef LAYERVIEW_H_
+#define LAYERVIEW_H_
+
+#include <QColor>
+#include <QList>
+#include <QPolygonF>
+#include <QVector>
+#include <QWidget>
+
+#include "./boarddescriptor.h"
+#include "./gamestate.h"
+#include "./solver.h"
+
+/**
+ * \class LayerView
+ * \brief Minimal play view for 3D boxes, showing one z-slice at a time.
+ *
+ * Pieces are moved as placement rows of a solver for the box (see
+ * GameState). A click places the selected piece in its current
+ * orientation with its anchor (smallest cell, see Solver) on the clicked
+ * cell, so a piece reaches from the shown layer upwards. PageUp/PageDown
+ * switch the layer, Tab or 1-9 select a piece, R cycles its orientations,
+ * a right click takes a piece from the box.
+ */
+class LayerView : public QWidget {
+  Q_OBJECT
+
+ public:
+    explicit LayerView(QWidget *pParent = 0);
+    ~LayerView();
+
+    bool setBoard(const BoardDescriptor &descriptor);
+    QSize sizeHint() const;
+
+ protected:
+    bool focusNextPrevChild(bool bNext);
+    void keyPressEvent(QKeyEvent *pEvent);
+    void leaveEvent(QEvent *pEvent);
+    void mouseMoveEvent(QMouseEvent *pEvent);
+    void mousePressEvent(QMouseEvent *pEvent);
+    void paintEvent(QPaintEvent *pEvent);
+    void resizeEvent(QResizeEvent *pEvent);
+
+ private:
+    static QColor readColor(const BoardDescriptor &descriptor,
+                            const QString &sKey, const QColor &fallback);
+    void layoutCells();
+    int cellAt(const QPoint &pos) const;
+    int hoverRow() const;
+    void selectPiece(const int nPiece);
+    void showLayer(const int nLayer);
+    void placePiece(const int nPiece, const int nRow);
+    QString statusText() const;
+
+    Solver *m_pSolver;
+    GameState m_State;
+    int m_nLayers;
+    int m_nLayer;  // Shown z-slice
+    int m_nPiece;  // Selected piece
+    int m_nHoverCell;  // Solver cell under the mouse, -1 = none
+    QString m_sMessage;  // Result of the last move
+    QList<QList<int> > m_listOrientations;  // Orientations with placements
+    QList<int> m_listOrientation;  // Index into m_listOrientations per piece
+    QVector<int> m_listCellOwner;  // Piece covering a cell, -1 = none
+    QVector<QPolygonF> m_listCellPolys;  // Widget coordinates, all layers
+    QRectF m_rectPlane;  // Cells of all layers in plane coordinates
+    QRect m_rectBoard;  // Widget area below the status lines
+    QColor m_bgColor;
+    QColor m_boardColor;
+    QColor m_gridColor;
+    QList<QColor> m_listPieceColors;
+};
+
+#endif  // LAYERVIEW_H_
@@ -0,0 +1,620 @@
+/**
+ * \file loadgenerator.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Load generator for the puzzle server.
+ */
+
+#include "./loadgenerator.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSaveFile>
+#include <QTcpSocket>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+
+#include "./lattice.h"
+#include "./protocol.h"
+#include "./puzzleserver.h"
+
+LoadGenerator::Options::Options()
+  : nPlayers(100),
+    nMoves(1000),
+    nThreads(0),
+    nBoards(20),
+    nSeed(1),
+    nPort(PuzzleServer::DEFAULT_PORT) {
+}
+
+LoadGenerator::Player::Player()
+  : nIndex(0),
+    nSession(0),
+    nReplayMove(0),
+    pSocket(NULL) {
+}
+
+LoadGenerator::Result::Result()
+  : listStatus(SessionStore::StatusFull + 1, 0),
+    nErrors(0) {
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+LoadGenerator::LoadGenerator(const Options &options)
+  : m_Options(options),
+    m_pStore(NULL),
+    m_nThreads(1) {
+}
+
+LoadGenerator::~LoadGenerator() {
+  foreach (const Board &board, m_hashBoards) {
+    delete board.pSolver;
+  }
+  delete m_pStore;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool LoadGenerator::run(QTextStream *pOut) {
+  qsrand(m_Options.nSeed);
+  if (!this->loadBoards()) {
+    return false;
+  }
+  if (m_Options.sHost.isEmpty()) {
+    m_pStore = new SessionStore(m_Options.sBoardsDir, m_Options.nPlayers);
+  }
+
+  m_nThreads = qBound(1, m_Options.nThreads > 0 ?
+                         m_Options.nThreads : QThread::idealThreadCount(),
+                      m_Options.nPlayers);
+  *pOut << "Players: " << m_Options.nPlayers << ", moves per player: "
+        << m_Options.nMoves << ", threads: " << m_nThreads << ", boards: "
+        << m_sListBoards.size() << ", target: "
+        << (m_Options.sHost.isEmpty() ? QString("core engine") :
+                                        m_Options.sHost + ":" +
+                                        QString::number(m_Options.nPort))
+        << "\n";
+  pOut->flush();
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(m_nThreads);
+  QList<QFuture<Result> > listFutures;
+  QElapsedTimer timer;
+  timer.start();
+  for (int i = 0; i < m_nThreads; i++) {
+    listFutures << QtConcurrent::run(&pool, this, &LoadGenerator::runPlayers,
+                                     i);
+  }
+  QList<Result> listResults;
+  for (int i = 0; i < listFutures.size(); i++) {
+    listResults << listFutures[i].result();
+  }
+  const qint64 nElapsed(timer.elapsed());
+
+  this->report(listResults, nElapsed, pOut);
+  if (!m_Options.sRecordFile.isEmpty()) {
+    return this->saveRecording(listResults);
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool LoadGenerator::loadBoards() {
+  if (!m_Options.sReplayFile.isEmpty()) {
+    if (!this->loadRecording()) {
+      return false;
+    }
+    foreach (const Game &game, m_listReplay) {
+      if (!m_hashBoards.contains(game.sBoard) &&
+          !this->loadBoard(game.sBoard)) {
+        qWarning() << "Load generator: board of recording can't be played:"
+                   << game.sBoard;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  QStringList sListCatalog;
+  QDirIterator it(m_Options.sBoardsDir, QStringList() << "*.conf",
+                  QDir::NoDotAndDotDot | QDir::Files,
+                  QDirIterator::Subdirectories);
+  while (it.hasNext()) {
+    it.next();
+    if (!it.filePath().contains("freestyle")) {
+      sListCatalog << it.filePath().remove(m_Options.sBoardsDir + "/");
+    }
+  }
+  sListCatalog.sort();
+
+  // Random boards of the catalog, same choice for the same seed
+  while (!sListCatalog.isEmpty() &&
+         m_sListBoards.size() < m_Options.nBoards) {
+    const QString sBoard(sListCatalog.takeAt(qrand() % sListCatalog.size()));
+    this->loadBoard(sBoard);
+  }
+  if (m_sListBoards.isEmpty()) {
+    qWarning() << "Load generator: no boards found in"
+               << m_Options.sBoardsDir;
+    return false;
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+
+bool LoadGenerator::loadBoard(const QString &sBoard) {
+  const BoardDescriptor descriptor(BoardDescriptor::load(
+                                     m_Options.sBoardsDir + "/" + sBoard));
+  if (descriptor.boardPoly.isEmpty() ||
+      !descriptor.sInvalidPolygon.isEmpty() || descriptor.bFreestyle ||
+      descriptor.sLattice != Lattice::name()) {
+    return false;
+  }
+
+  Board board;
+  board.pSolver = new Solver(descriptor);
+  board.listPieceRows.resize(board.pSolver->getNumOfPieces());
+  const QList<Solver::Placement> &listPlacements =
+      board.pSolver->getPlacements();
+  for (int nRow = 0; nRow < listPlacements.size(); nRow++) {
+    board.listPieceRows[listPlacements.at(nRow).nPiece] << nRow;
+  }
+  m_hashBoards[sBoard] = board;
+  m_sListBoards << sBoard;
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool LoadGenerator::loadRecording() {
+  QFile file(m_Options.sReplayFile);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    qWarning() << "Load generator: couldn't open recording"
+               << m_Options.sReplayFile;
+    return false;
+  }
+
+  QTextStream in(&file);
+  int nLine(0);
+  while (!in.atEnd()) {
+    nLine++;
+    const QString sLine(in.readLine().trimmed());
+    if (sLine.isEmpty() || sLine.startsWith("#")) {
+      continue;
+    }
+    if (sLine.startsWith("board ")) {
+      Game game;
+      game.sBoard = sLine.mid(6).trimmed();
+      m_listReplay << game;
+      continue;
+    }
+
+    const QStringList sListFields(sLine.split(' ', QString::SkipEmptyParts));
+    Solver::Placement move;
+    bool bOk(false);
+    move.nPiece = sListFields.first().toInt(&bOk);
+    move.nOrientation = 0;
+    for (int i = 1; bOk && i < sListFields.size(); i++) {
+      const QStringList sListCoord(sListFields.at(i).split(','));
+      bOk = (3 == sListCoord.size());
+      if (bOk) {
+        move.listCells << Voxel(sListCoord.at(0).toInt(),
+                                sListCoord.at(1).toInt(),
+                                sListCoord.at(2).toInt());
+      }
+    }
+    if (!bOk || m_listReplay.isEmpty()) {
+      qWarning() << "Load generator: invalid recording, line" << nLine;
+      return false;
+    }
+    m_listReplay.last().listMoves << move;
+  }
+
+  if (m_listReplay.isEmpty()) {
+    qWarning() << "Load generator: empty recording"
+               << m_Options.sReplayFile;
+    return false;
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+
+bool LoadGenerator::saveRecording(const QList<Result> &listResults) const {
+  QSaveFile file(m_Options.sRecordFile);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    qWarning() << "Load generator: couldn't write recording"
+               << m_Options.sRecordFile;
+    return false;
+  }
+
+  QTextStream out(&file);
+  out << "# iQPuzzle load generator recording\n";
+  for (int nPlayer = 0; nPlayer < m_Options.nPlayers; nPlayer++) {
+    foreach (const Result &result, listResults) {
+      foreach (const Game &game, result.hashRecorded.value(nPlayer)) {
+        out << "board " << game.sBoard << "\n";
+        foreach (const Solver::Placement &move, game.listMoves) {
+          out << move.nPiece;
+          foreach (const Voxel &v, move.listCells) {
+            out << " " << v.x << "," << v.y << "," << v.z;
+          }
+          out << "\n";
+        }
+      }
+    }
+  }
+  out.flush();
+  return file.commit();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+LoadGenerator::Result LoadGenerator::runPlayers(const int nThread) {
+  qsrand(m_Options.nSeed + nThread + 1);  // Seed is per thread
+
+  Result result;
+  QList<Player> listPlayers;
+  // Players nThread, nThread + m_nThreads, ... take turns on this thread
+  for (int i = nThread; i < m_Options.nPlayers; i += m_nThreads) {
+    Player player;
+    player.nIndex = i;
+    if (!m_Options.sHost.isEmpty()) {
+      player.pSocket = new QTcpSocket();
+      player.pSocket->connectToHost(m_Options.sHost, m_Options.nPort);
+      if (!player.pSocket->waitForConnected(5000)) {
+        qWarning() << "Load generator:" << player.pSocket->errorString();
+        delete player.pSocket;
+        result.nErrors++;
+        continue;
+      }
+      player.pSocket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    }
+    if (this->startGame(&player, &result)) {
+      listPlayers << player;
+    } else {
+      delete player.pSocket;
+    }
+  }
+
+  QElapsedTimer timer;
+  Solver::Placement move;
+  int nRow(-1);
+  for (int nMove = 0; nMove < m_Options.nMoves; nMove++) {
+    for (int i = 0; i < listPlayers.size(); i++) {
+      Player &player = listPlayers[i];
+      if (0 == player.nSession) {
+        continue;
+      }
+      if (!this->nextMove(&player, &move, &nRow)) {
+        // Recording finished, play it again
+        this->endGame(&player);
+        this->startGame(&player, &result);
+        continue;
+      }
+
+      timer.start();
+      const SessionStore::Status status(this->sendMove(&player, move));
+      result.listLatencies << quint32(qMin(timer.nsecsElapsed(),
+                                           qint64(0xFFFFFFFF)));
+      result.listStatus[status]++;
+      if (!m_Options.sRecordFile.isEmpty()) {
+        result.hashRecorded[player.nIndex].last().listMoves << move;
+      }
+
+      if (SessionStore::StatusOk == status ||
+          SessionStore::StatusSolved == status) {
+        player.listPieceRows[move.nPiece] = nRow;
+      } else if (SessionStore::StatusBadRequest == status) {
+        result.nErrors++;
+        player.nSession = 0;  // Connection lost
+      }
+      if (SessionStore::StatusSolved == status) {
+        this->endGame(&player);
+        this->startGame(&player, &result);
+      }
+    }
+  }
+
+  for (int i = 0; i < listPlayers.size(); i++) {
+    this->endGame(&listPlayers[i]);
+    delete listPlayers[i].pSocket;
+  }
+  return result;
+}
+
+// ---------------------------------------------------------------------------
+
+bool LoadGenerator::startGame(Player *pPlayer, Result *pResult) {
+  if (!m_listReplay.isEmpty()) {
+    pPlayer->sBoard = m_listReplay.at(pPlayer->nIndex %
+                                      m_listReplay.size()).sBoard;
+    pPlayer->nReplayMove = 0;
+  } else {
+    pPlayer->sBoard = m_sListBoards.at(qrand() % m_sListBoards.size());
+  }
+
+  quint32 nSession(0);
+  SessionStore::Status status(SessionStore::StatusBadRequest);
+  if (NULL != m_pStore) {
+    int nPieces(0);
+    int nCells(0);
+    status = m_pStore->createSession(pPlayer->sBoard, &nSession,
+                                     &nPieces, &nCells);
+  } else {
+    QByteArray request;
+    QDataStream out(&request, QIODevice::WriteOnly);
+    out << PuzzleServer::PROTOCOL_VERSION
+        << quint8(PuzzleServer::CommandCreate) << pPlayer->sBoard.toUtf8();
+    QByteArray reply;
+    if (this->request(pPlayer->pSocket, request, &reply)) {
+      QDataStream in(reply);
+      quint8 nStatus(SessionStore::StatusBadRequest);
+      in >> nStatus >> nSession;
+      status = SessionStore::Status(nStatus);
+    }
+  }
+  if (SessionStore::StatusOk != status) {
+    qWarning() << "Load generator: couldn't create session, status"
+               << status;
+    pResult->nErrors++;
+    pPlayer->nSession = 0;
+    return false;
+  }
+
+  pPlayer->nSession = nSession;
+  pPlayer->listPieceRows.fill(
+        -1, m_hashBoards.constFind(pPlayer->sBoard)->pSolver
+        ->getNumOfPieces());
+  if (!m_Options.sRecordFile.isEmpty()) {
+    Game game;
+    game.sBoard = pPlayer->sBoard;
+    pResult->hashRecorded[pPlayer->nIndex] << game;
+  }
+  return true;
+}
+
+void LoadGenerator::endGame(Player *pPlayer) {
+  if (0 == pPlayer->nSession) {
+    return;
+  }
+  if (NULL != m_pStore) {
+    m_pStore->closeSession(pPlayer->nSession);
+  } else {
+    QByteArray request;
+    QDataStream out(&request, QIODevice::WriteOnly);
+    out << PuzzleServer::PROTOCOL_VERSION
+        << quint8(PuzzleServer::CommandClose) << pPlayer->nSession;
+    QByteArray reply;
+    this->request(pPlayer->pSocket, request, &reply);
+  }
+  pPlayer->nSession = 0;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool LoadGenerator::nextMove(Player *pPlayer, Solver::Placement *pMove,
+                             int *pRow) const {
+  const Board &board = *m_hashBoards.constFind(pPlayer->sBoard);
+  const QList<Solver::Placement> &listPlacements =
+      board.pSolver->getPlacements();
+
+  if (!m_listReplay.isEmpty()) {
+    const Game &game = m_listReplay.at(pPlayer->nIndex %
+                                       m_listReplay.size());
+    if (pPlayer->nReplayMove >= game.listMoves.size()) {
+      return false;
+    }
+    *pMove = game.listMoves.at(pPlayer->nReplayMove++);
+    *pRow = board.pSolver->findPlacement(pMove->nPiece, pMove->listCells);
+    return true;
+  }
+
+  const int nPiece(qrand() % board.listPieceRows.size());
+  const QVector<int> &listRows = board.listPieceRows.at(nPiece);
+  if (listRows.isEmpty()) {
+    return false;
+  }
+  const int nCurrent(pPlayer->listPieceRows.at(nPiece));
+  const int nAction(qrand() % 10);
+  if (nCurrent < 0) {  // Piece is dragged onto the board
+    *pRow = listRows.at(qrand() % listRows.size());
+  } else if (nAction < 5) {  // Moved, orientation stays
+    const int nOrientation(listPlacements.at(nCurrent).nOrientation);
+    *pRow = listRows.at(qrand() % listRows.size());
+    for (int i = 0; i < 8 &&
+         listPlacements.at(*pRow).nOrientation != nOrientation; i++) {
+      *pRow = listRows.at(qrand() % listRows.size());
+    }
+  } else if (nAction < 9) {  // Rotated or flipped in place
+    *pRow = this->nearestRow(board, nPiece, nCurrent);
+  } else {  // Taken from the board
+    *pRow = -1;
+  }
+
+  pMove->nPiece = nPiece;
+  pMove->nOrientation = 0;
+  pMove->listCells.clear();
+  if (*pRow >= 0) {
+    pMove->listCells = listPlacements.at(*pRow).listCells;
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+
+int LoadGenerator::nearestRow(const Board &board, const int nPiece,
+                              const int nCurrent) const {
+  // Closest placement with a random other orientation
+  const QList<Solver::Placement> &listPlacements =
+      board.pSolver->getPlacements();
+  const QVector<int> &listRows = board.listPieceRows.at(nPiece);
+  const Solver::Placement &current = listPlacements.at(nCurrent);
+  int nOrientation(current.nOrientation);
+  for (int i = 0; i < 8 && nOrientation == current.nOrientation; i++) {
+    nOrientation = listPlacements.at(
+                     listRows.at(qrand() % listRows.size())).nOrientation;
+  }
+
+  int nBest(nCurrent);
+  int nBestDistance(-1);
+  foreach (int nRow, listRows) {
+    const Solver::Placement &placement = listPlacements.at(nRow);
+    if (placement.nOrientation != nOrientation) {
+      continue;
+    }
+    const Voxel d(placement.listCells.first() - current.listCells.first());
+    const int nDistance(qAbs(d.x) + qAbs(d.y) + qAbs(d.z));
+    if (nBestDistance < 0 || nDistance < nBestDistance) {
+      nBest = nRow;
+      nBestDistance = nDistance;
+    }
+  }
+  return nBest;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+SessionStore::Status LoadGenerator::sendMove(Player *pPlayer,
+                                             const Solver::Placement &move) {
+  quint32 nMoves(0);
+  if (NULL != m_pStore) {
+    return m_pStore->move(pPlayer->nSession, move.nPiece, move.listCells,
+                          &nMoves);
+  }
+
+  QByteArray request;
+  QDataStream out(&request, QIODevice::WriteOnly);
+  out << PuzzleServer::PROTOCOL_VERSION << quint8(PuzzleServer::CommandMove)
+      << pPlayer->nSession;
+  writePlacement(&out, move);
+
+  QByteArray reply;
+  if (!this->request(pPlayer->pSocket, request, &reply)) {
+    return SessionStore::StatusBadRequest;
+  }
+  QDataStream in(reply);
+  quint8 nStatus(SessionStore::StatusBadRequest);
+  in >> nStatus >> nMoves;
+  return SessionStore::Status(qMin(nStatus,
+                                   quint8(SessionStore::StatusFull)));
+}
+
+// ---------------------------------------------------------------------------
+
+bool LoadGenerator::request(QTcpSocket *pSocket, const QByteArray &request,
+                            QByteArray *pReply) const {
+  pSocket->write(frameMessage(request));
+  QByteArray buffer;
+  while (!takeMessage(&buffer, pReply)) {
+    if (!pSocket->waitForReadyRead(5000)) {
+      qWarning() << "Load generator:" << pSocket->errorString();
+      return false;
+    }
+    buffer += pSocket->readAll();
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void LoadGenerator::report(const QList<Result> &listResults,
+                           const qint64 nElapsed, QTextStream *pOut) const {
+  QVector<quint32> listLatencies;
+  QVector<quint64> listStatus(SessionStore::StatusFull + 1, 0);
+  quint64 nErrors(0);
+  foreach (const Result &result, listResults) {
+    listLatencies += result.listLatencies;
+    for (int i = 0; i < listStatus.size(); i++) {
+      listStatus[i] += result.listStatus.at(i);
+    }
+    nErrors += result.nErrors;
+  }
+  qSort(listLatencies);
+
+  const int nMoves(listLatencies.size());
+  *pOut << "Moves: " << nMoves << " in " << nElapsed << " ms ("
+        << (nElapsed > 0 ? qint64(nMoves) * 1000 / nElapsed : 0)
+        << " moves/s), errors: " << nErrors << "\n"
+        << "Replies: ok " << listStatus.at(SessionStore::StatusOk)
+        << ", solved " << listStatus.at(SessionStore::StatusSolved)
+        << ", blocked " << listStatus.at(SessionStore::StatusBlocked)
+        << ", invalid " << listStatus.at(SessionStore::StatusInvalid)
+        << "\n";
+  if (0 == nMoves) {
+    return;
+  }
+
+  // Percentiles in microseconds
+  const double dPercentiles[] = {50, 90, 99, 99.9};
+  *pOut << "Latency (us):";
+  for (int i = 0; i < 4; i++) {
+    const int nIndex(qMin(nMoves - 1, int(nMoves * dPercentiles[i] / 100)));
+    *pOut << " p" << dPercentiles[i] << " "
+          << QString::number(listLatencies.at(nIndex) / 1000.0, 'f', 1);
+  }
+  *pOut << " max "
+        << QString::number(listLatencies.last() / 1000.0, 'f', 1) << "\n";
+
+  // Histogram with power of two buckets: < 1 us, < 2 us, < 4 us, ...
+  QVector<int> listBuckets(33, 0);
+  foreach (quint32 nLatency, listLatencies) {
+    int nBucket(0);
+    for (quint32 nMicro = nLatency / 1000; nMicro > 0; nMicro >>= 1) {
+      nBucket++;
+    }
+    listBuckets[nBucket]++;
+  }
+  int nFirst(0);
+  while (0 == listBuckets.at(nFirst)) {
+    nFirst++;
+  }
+  int nLast(listBuckets.size() - 1);
+  while (0 == listBuckets.at(nLast)) {
+    nLast--;
+  }
+  int nMax(0);
+  foreach (int nCount, listBuckets) {
+    nMax = qMax(nMax, nCount);
+  }
+  for (int i = nFirst; i <= nLast; i++) {
+    *pOut << QString("  < %1 us").arg(quint64(1) << i, 10)
+          << QString(" %1 ").arg(listBuckets.at(i), 9)
+          << QString(listBuckets.at(i) * 40 / nMax, '#') << "\n";
+  }
+}
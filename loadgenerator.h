@@ -0,0 +1,129 @@
+/**
+ * \file loadgenerator.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the load generator of the puzzle server.
+ */
+
+#ifndef LOADGENERATOR_H_
+#define LOADGENERATOR_H_
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "./sessionstore.h"
+
+class QTcpSocket;
+class QTextStream;
+
+/**
+ * \class LoadGenerator
+ * \brief Simulated players for sizing the puzzle server.
+ *
+ * Started with --loadgen. Every player opens a session on a board of the
+ * catalog and moves, rotates, flips and removes pieces like a human
+ * would (most moves are blocked therefore), or replays a recording.
+ * Players are spread over threads and run against the core engine in
+ * the own process or against a running --server. Each move is timed
+ * end to end, the report contains throughput and a latency histogram.
+ *
+ * Recordings are text files: "board <file>" starts a game, every
+ * following line is a move "<piece> x,y,z x,y,z ..." (no cells = remove).
+ */
+class LoadGenerator {
+ public:
+    struct Options {
+      Options();
+      int nPlayers;
+      int nMoves;  // Per player
+      int nThreads;  // 0 = ideal thread count
+      int nBoards;  // Boards picked from the catalog
+      uint nSeed;
+      QString sBoardsDir;
+      QString sHost;  // Empty = core engine in own process
+      quint16 nPort;
+      QString sRecordFile;
+      QString sReplayFile;
+    };
+
+    explicit LoadGenerator(const Options &options);
+    ~LoadGenerator();
+
+    bool run(QTextStream *pOut);
+
+ private:
+    Q_DISABLE_COPY(LoadGenerator)
+
+    struct Board {
+      Solver *pSolver;
+      QVector<QVector<int> > listPieceRows;  // Placement rows per piece
+    };
+    struct Game {
+      QString sBoard;
+      QList<Solver::Placement> listMoves;
+    };
+    struct Player {
+      Player();
+      int nIndex;
+      QString sBoard;
+      quint32 nSession;
+      QVector<int> listPieceRows;  // Current row of each piece, -1 = off
+      int nReplayMove;
+      QTcpSocket *pSocket;
+    };
+    struct Result {
+      Result();
+      QVector<quint32> listLatencies;  // Nanoseconds
+      QVector<quint64> listStatus;  // Replies per SessionStore::Status
+      quint64 nErrors;
+      QHash<int, QList<Game> > hashRecorded;  // Per player
+    };
+
+    bool loadBoards();
+    bool loadBoard(const QString &sBoard);
+    bool loadRecording();
+    bool saveRecording(const QList<Result> &listResults) const;
+    Result runPlayers(const int nThread);
+    bool startGame(Player *pPlayer, Result *pResult);
+    void endGame(Player *pPlayer);
+    bool nextMove(Player *pPlayer, Solver::Placement *pMove,
+                  int *pRow) const;
+    int nearestRow(const Board &board, const int nPiece,
+                   const int nCurrent) const;
+    SessionStore::Status sendMove(Player *pPlayer,
+                                  const Solver::Placement &move);
+    bool request(QTcpSocket *pSocket, const QByteArray &request,
+                 QByteArray *pReply) const;
+    void report(const QList<Result> &listResults, const qint64 nElapsed,
+                QTextStream *pOut) const;
+
+    const Options m_Options;
+    SessionStore *m_pStore;  // NULL if a server is used
+    int m_nThreads;
+    QHash<QString, Board> m_hashBoards;
+    QStringList m_sListBoards;
+    QList<Game> m_listReplay;
+};
+
+#endif  // LOADGENERATOR_H_
@@ -31,26 +31,34 @@
  */
 
 #include <QApplication>
+#include <QMutex>
 #include <QTextStream>
 
+#include "./commandline.h"
 #include "./iqpuzzle.h"
 
 QFile logfile;
 QTextStream out(&logfile);
+QMutex logMutex;  // Boards are parsed on worker threads as well
 
 void setupLogger(const QString &sDebugFilePath,
                  const QString &sAppName,
                  const QString &sVersion);
 
-#if QT_VERSION >= 0x050000
 void LoggingHandler(QtMsgType type,
                     const QMessageLogContext &context,
                     const QString &sMsg);
-#else
-void LoggingHandler(QtMsgType type, const char *sMsg);
-#endif
 
 int main(int argc, char *argv[]) {
+  // Solving from command line doesn't need any GUI (works headless)
+  const CommandLine::Handler handler(CommandLine::findHandler(argc, argv));
+  if (NULL != handler) {
+    QCoreApplication app(argc, argv);
+    app.setApplicationName(APP_NAME);
+    app.setApplicationVersion(APP_VERSION);
+    return handler(app.arguments());
+  }
+
   QApplication app(argc, argv);
   app.setApplicationName(APP_NAME);
   app.setApplicationVersion(APP_VERSION);
@@ -62,20 +70,8 @@ int main(int argc, char *argv[]) {
     exit(0);
   }
 
-  // Default share data path (Windows and debugging)
-  QString sSharePath = app.applicationDirPath();
-  // Standard installation path (Linux)
-  QDir tmpDir(app.applicationDirPath() + "/../share/"
-              + app.applicationName().toLower());
-  if (!app.arguments().contains("--debug") && tmpDir.exists()) {
-    sSharePath = app.applicationDirPath() + "/../share/"
-                 + app.applicationName().toLower();
-  }
-#if defined(Q_OS_OSX)
-  sSharePath = app.applicationDirPath() + "/../Resources/";
-#endif
+  const QString sSharePath(CommandLine::getSharePath());
 
-#if QT_VERSION >= 0x050000
   QStringList sListPaths = QStandardPaths::standardLocations(
                              QStandardPaths::DataLocation);
   if (sListPaths.isEmpty()) {
@@ -83,11 +79,6 @@ int main(int argc, char *argv[]) {
     sListPaths << app.applicationDirPath();
   }
   const QDir userDataDir(sListPaths[0].toLower());
-#else
-  const QDir userDataDir(
-        QDesktopServices::storageLocation(
-          QDesktopServices::DataLocation).toLower());
-#endif
   // Create folder including possible parent directories (mkPATH)
   if (!userDataDir.exists()) {
     userDataDir.mkpath(userDataDir.absolutePath());
@@ -121,11 +112,7 @@ void setupLogger(const QString &sDebugFilePath,
   if (!logfile.open(QIODevice::WriteOnly)) {
     qWarning() << "Couldn't create logging file: " << sDebugFilePath;
   } else {
-#if QT_VERSION >= 0x050000
     qInstallMessageHandler(LoggingHandler);
-#else
-    qInstallMsgHandler(LoggingHandler);
-#endif
   }
 
   qDebug() << sAppName << sVersion;
@@ -136,7 +123,6 @@ void setupLogger(const QString &sDebugFilePath,
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-#if QT_VERSION >= 0x050000
 void LoggingHandler(QtMsgType type,
                     const QMessageLogContext &context,
                     const QString &sMsg) {
@@ -145,12 +131,8 @@ void LoggingHandler(QtMsgType type,
                      QString(context.file) + ":" +
                      QString::number(context.line) + ", " +
                      QString(context.function) + ")";
-#else
-void LoggingHandler(QtMsgType type, const char *sMsg) {
-  QString sMsg2(sMsg);
-  QString sContext(sMsg);
-#endif
   QString sTime(QTime::currentTime().toString());
+  QMutexLocker locker(&logMutex);
 
   switch (type) {
     case QtDebugMsg:
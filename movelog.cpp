@@ -0,0 +1,206 @@
+/**
+ * \file movelog.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Move log of a game.
+ */
+
+#include "./movelog.h"
+
+#include "./gamestate.h"
+
+const char MoveLog::MAGIC[4] = {'I', 'Q', 'M', 'L'};
+const quint8 MoveLog::VERSION = 1;
+
+void MoveLog::clear() {
+  m_listSnapshots.clear();
+}
+
+void MoveLog::addSnapshot(const quint32 nMove, const quint32 nSeconds,
+                          const QList<QList<QPoint> > &listPieces) {
+  if (!m_listSnapshots.isEmpty() &&
+      m_listSnapshots.last().listPieces == listPieces) {
+    return;
+  }
+  Snapshot snapshot;
+  snapshot.nMove = nMove;
+  snapshot.nSeconds = nSeconds;
+  snapshot.listPieces = listPieces;
+  m_listSnapshots << snapshot;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+QByteArray MoveLog::encode(const Solver &solver) const {
+  const int nPieces(solver.getNumOfPieces());
+  QByteArray log(MAGIC, sizeof(MAGIC));
+  log.append(char(VERSION));
+  MoveLog::writeVarint(&log, nPieces);
+
+  GameState state(&solver);
+  QVector<int> listRows(nPieces, -1);
+  foreach (const Snapshot &snapshot, m_listSnapshots) {
+    // Removed pieces first, blocked ones again after all others moved
+    QVector<int> listTarget(listRows);
+    QList<int> listChanged;
+    for (int i = 0; i < nPieces && i < snapshot.listPieces.size(); i++) {
+      QVector<Voxel> listCells;
+      foreach (const QPoint &cell, snapshot.listPieces.at(i)) {
+        listCells << Voxel(cell.x(), cell.y(), 0);
+      }
+      listTarget[i] = solver.findPlacement(i, listCells);
+      if (listTarget.at(i) < 0 && listRows.at(i) >= 0) {
+        listChanged.prepend(i);
+      } else if (listTarget.at(i) != listRows.at(i)) {
+        listChanged << i;
+      }
+    }
+
+    QList<int> listBlocked;
+    for (int nPass = 0; nPass < 2; nPass++) {
+      foreach (int nPiece, 0 == nPass ? listChanged : listBlocked) {
+        int nRow(listTarget.at(nPiece));
+        if (GameState::MoveBlocked == state.placeRow(nPiece, nRow)) {
+          if (0 == nPass) {
+            listBlocked << nPiece;
+            continue;
+          }
+          nRow = -1;  // Overlapping another piece
+          state.placeRow(nPiece, nRow);
+        }
+        if (nRow != listRows.at(nPiece)) {
+          listRows[nPiece] = nRow;
+          MoveLog::writeVarint(&log, snapshot.nMove);
+          MoveLog::writeVarint(&log, snapshot.nSeconds);
+          MoveLog::writeVarint(&log, nPiece);
+          MoveLog::writeVarint(&log, nRow + 1);
+        }
+      }
+    }
+  }
+  return log;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+MoveLog::Result MoveLog::verify(const Solver &solver, const QByteArray &log,
+                                const quint32 nMoves,
+                                const quint32 nSeconds) {
+  const uchar *p = reinterpret_cast<const uchar *>(log.constData());
+  const uchar *pEnd = p + log.size();
+  quint32 nPieces(0);
+  if (log.size() < int(sizeof(MAGIC)) + 2 ||
+      !log.startsWith(QByteArray(MAGIC, sizeof(MAGIC))) ||
+      VERSION != p[sizeof(MAGIC)]) {
+    return Malformed;
+  }
+  p += sizeof(MAGIC) + 1;
+  if (!MoveLog::readVarint(&p, pEnd, &nPieces) ||
+      int(nPieces) != solver.getNumOfPieces()) {
+    return Malformed;
+  }
+
+  GameState state(&solver);
+  quint32 nLastMove(0);
+  quint32 nLastSeconds(0);
+  while (p < pEnd) {
+    quint32 nMove(0), nTime(0), nPiece(0), nRow(0);
+    if (!MoveLog::readVarint(&p, pEnd, &nMove) ||
+        !MoveLog::readVarint(&p, pEnd, &nTime) ||
+        !MoveLog::readVarint(&p, pEnd, &nPiece) ||
+        !MoveLog::readVarint(&p, pEnd, &nRow)) {
+      return Malformed;
+    }
+    if (nMove < nLastMove || nTime < nLastSeconds) {
+      return BadTimestamps;
+    }
+    nLastMove = nMove;
+    nLastSeconds = nTime;
+
+    if (nPiece >= nPieces || nRow > quint32(solver.getPlacements().size())) {
+      return IllegalMove;
+    }
+    const GameState::MoveResult result(state.placeRow(nPiece,
+                                                      int(nRow) - 1));
+    if (GameState::MoveInvalid == result ||
+        GameState::MoveBlocked == result) {
+      return IllegalMove;
+    }
+  }
+
+  if (!state.isSolved()) {
+    return NotSolved;
+  }
+  // Solved with the last logged move, the clock may have ticked once
+  if (nMoves != nLastMove || nSeconds < nLastSeconds ||
+      nSeconds > nLastSeconds + 1) {
+    return WrongScore;
+  }
+  return Valid;
+}
+
+QString MoveLog::resultName(const Result result) {
+  switch (result) {
+    case Valid:
+      return "valid";
+    case Malformed:
+      return "malformed log";
+    case IllegalMove:
+      return "illegal move";
+    case NotSolved:
+      return "not solved";
+    case BadTimestamps:
+      return "timestamps not monotonic";
+    case WrongScore:
+      return "score doesn't match log";
+  }
+  return QString();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void MoveLog::writeVarint(QByteArray *pData, quint32 nValue) {
+  while (nValue >= 0x80) {
+    pData->append(char((nValue & 0x7F) | 0x80));
+    nValue >>= 7;
+  }
+  pData->append(char(nValue));
+}
+
+bool MoveLog::readVarint(const uchar **ppData, const uchar *pEnd,
+                         quint32 *pValue) {
+  *pValue = 0;
+  for (int nShift = 0; nShift < 35; nShift += 7) {
+    if (*ppData >= pEnd) {
+      return false;
+    }
+    const uchar c(*(*ppData)++);
+    *pValue |= quint32(c & 0x7F) << nShift;
+    if (0 == (c & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,85 @@
+/**
+ * \file movelog.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the move log of a game.
+ */
+
+#ifndef MOVELOG_H_
+#define MOVELOG_H_
+
+#include <QByteArray>
+#include <QList>
+#include <QPoint>
+#include <QString>
+
+#include "./solver.h"
+
+/**
+ * \class MoveLog
+ * \brief Moves of a game, stored with a highscore and verified by replay.
+ *
+ * During the game the cells of all pieces are recorded after each move.
+ * encode() turns them into placement rows of the solver: "IQML", quint8
+ * version, number of pieces and per change the move counter, the game
+ * time (seconds), the piece and row + 1 (0 = removed), all as varints.
+ * Pieces overlapping others are taken as removed, so the log only
+ * contains legal moves. verify() replays the log on a bitboard.
+ */
+class MoveLog {
+ public:
+    enum Result {
+      Valid,
+      Malformed,
+      IllegalMove,
+      NotSolved,
+      BadTimestamps,
+      WrongScore
+    };
+
+    void clear();
+    void addSnapshot(const quint32 nMove, const quint32 nSeconds,
+                     const QList<QList<QPoint> > &listPieces);
+    QByteArray encode(const Solver &solver) const;
+
+    static Result verify(const Solver &solver, const QByteArray &log,
+                         const quint32 nMoves, const quint32 nSeconds);
+    static QString resultName(const Result result);
+
+ private:
+    struct Snapshot {
+      quint32 nMove;
+      quint32 nSeconds;
+      QList<QList<QPoint> > listPieces;
+    };
+
+    static void writeVarint(QByteArray *pData, quint32 nValue);
+    static bool readVarint(const uchar **ppData, const uchar *pEnd,
+                           quint32 *pValue);
+
+    static const char MAGIC[4];
+    static const quint8 VERSION;
+
+    QList<Snapshot> m_listSnapshots;
+};
+
+#endif  // MOVELOG_H_
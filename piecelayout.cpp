@@ -0,0 +1,181 @@
+/**
+ * \file piecelayout.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Arrangement of pieces around the board.
+ */
+
+#include "./piecelayout.h"
+
+#include <QPair>
+#include <QtAlgorithms>
+#include <qmath.h>
+
+#include "./lattice.h"
+
+QList<QPoint> PieceLayout::arrange(const QVector<QPointF> &boardPoly,
+                                   const QList<QVector<QPointF> > &listPieces,
+                                   const qreal dAspectRatio) {
+  // Board and each piece with a gap at the right and bottom
+  QPoint min;
+  QPoint max;
+  PieceLayout::bounds(boardPoly, &min, &max);
+  const QRect board(min.x(), min.y(), max.x() - min.x() + GAP,
+                    max.y() - min.y() + GAP);
+
+  QList<Item> listItems;
+  qreal dArea(board.width() * board.height());
+  int nMinWidth(board.width());
+  for (int i = 0; i < listPieces.size(); i++) {
+    PieceLayout::bounds(listPieces.at(i), &min, &max);
+    Item item;
+    item.nPiece = i;
+    item.nWidth = max.x() - min.x() + GAP;
+    item.nHeight = max.y() - min.y() + GAP;
+    item.offset = min;
+    dArea += item.nWidth * item.nHeight;
+    nMinWidth = qMax(nMinWidth, item.nWidth);
+    listItems << item;
+  }
+  qSort(listItems.begin(), listItems.end(), PieceLayout::higherThan);
+
+  // Band widths from 60 % to 160 % of a square layout of the given ratio
+  const qreal dAspect(dAspectRatio > 0 ? dAspectRatio : 1.0);
+  const qreal dEstimate(qSqrt(dArea * dAspect));
+  QList<QPoint> listBest;
+  qreal dBestScore(-1);
+  for (int nStep = 6; nStep <= 16; nStep++) {
+    const int nWidth(qMax(nMinWidth, qCeil(dEstimate * nStep / 10)));
+    QList<QPoint> listPos;
+    const QRect used(PieceLayout::pack(board, listItems, nWidth, dAspect,
+                                       &listPos));
+    const qreal dRatio(qreal(used.width()) / used.height() / dAspect);
+    const qreal dScore(qreal(used.width()) * used.height() *
+                       qMax(dRatio, 1 / dRatio));
+    if (dBestScore < 0 || dScore < dBestScore) {
+      dBestScore = dScore;
+      listBest = listPos;
+    }
+  }
+  return listBest;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+QRect PieceLayout::pack(const QRect &board, const QList<Item> &listItems,
+                        const int nWidth, const qreal dAspectRatio,
+                        QList<QPoint> *pListPos) {
+  // Band centered on the board, first shelf above it
+  const int nLeft(board.left() - (nWidth - board.width()) / 2);
+  const int nHeight(qMax(board.height(), qCeil(nWidth / dAspectRatio)));
+  int y(board.top() - (nHeight - board.height()) / 2);
+
+  QVector<QPoint> listPos(listItems.size());
+  QList<Item> listLeft(listItems);
+  QRect used(board);
+  while (!listLeft.isEmpty()) {
+    // Free parts of the shelf (x, end), left and right of the board
+    const int nShelf(listLeft.first().nHeight);
+    QList<QPair<int, int> > listFree;
+    if (y < board.top() + board.height() && y + nShelf > board.top()) {
+      listFree << qMakePair(nLeft, board.left())
+               << qMakePair(board.left() + board.width(), nLeft + nWidth);
+    } else {
+      listFree << qMakePair(nLeft, nLeft + nWidth);
+    }
+
+    // Tallest first, lower pieces fill the rest of the shelf
+    bool bPlaced(false);
+    int i(0);
+    while (i < listLeft.size()) {
+      const Item item(listLeft.at(i));
+      int k(0);
+      int nShift(0);
+      while (k < listFree.size()) {
+        nShift = PieceLayout::latticeShift(
+                   QPoint(listFree.at(k).first, y) - item.offset);
+        if (listFree.at(k).first + nShift + item.nWidth <=
+            listFree.at(k).second) {
+          break;
+        }
+        k++;
+      }
+      if (k == listFree.size()) {
+        i++;
+        continue;
+      }
+      const int x(listFree.at(k).first + nShift);
+      listFree[k].first = x + item.nWidth;
+      listPos[item.nPiece] = QPoint(x, y) - item.offset;
+      used |= QRect(x, y, item.nWidth, item.nHeight);
+      listLeft.removeAt(i);
+      bPlaced = true;
+    }
+    y += bPlaced ? nShelf : 1;  // Too narrow next to the board
+  }
+
+  *pListPos = listPos.toList();
+  return used;
+}
+
+// ---------------------------------------------------------------------------
+
+// Steps to the right until the position is a translation of the lattice
+// (hex: (x - y) divisible by 3), zero on square and triangle grids
+int PieceLayout::latticeShift(const QPoint &pos) {
+  int nShift(0);
+  while (nShift < 2 * Lattice::ROTATIONS &&
+         !Lattice::isTranslation(Lattice::keyOffset(pos +
+                                                    QPoint(nShift, 0)))) {
+    nShift++;
+  }
+  return nShift;
+}
+
+bool PieceLayout::higherThan(const Item &item1, const Item &item2) {
+  if (item1.nHeight != item2.nHeight) {
+    return item1.nHeight > item2.nHeight;
+  }
+  if (item1.nWidth != item2.nWidth) {
+    return item1.nWidth > item2.nWidth;
+  }
+  return item1.nPiece < item2.nPiece;
+}
+
+void PieceLayout::bounds(const QVector<QPointF> &polygon,
+                         QPoint *pMin, QPoint *pMax) {
+  *pMin = QPoint(0, 0);
+  *pMax = QPoint(0, 0);
+  for (int i = 0; i < polygon.size(); i++) {
+    const QPoint low(qFloor(polygon.at(i).x()), qFloor(polygon.at(i).y()));
+    const QPoint high(qCeil(polygon.at(i).x()), qCeil(polygon.at(i).y()));
+    if (0 == i) {
+      *pMin = low;
+      *pMax = high;
+    }
+    pMin->setX(qMin(pMin->x(), low.x()));
+    pMin->setY(qMin(pMin->y(), low.y()));
+    pMax->setX(qMax(pMax->x(), high.x()));
+    pMax->setY(qMax(pMax->y(), high.y()));
+  }
+}
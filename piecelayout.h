@@ -0,0 +1,73 @@
+/**
+ * \file piecelayout.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for arranging pieces around the board.
+ */
+
+#ifndef PIECELAYOUT_H_
+#define PIECELAYOUT_H_
+
+#include <QList>
+#include <QPoint>
+#include <QPointF>
+#include <QRect>
+#include <QVector>
+
+/**
+ * \class PieceLayout
+ * \brief Start positions of pieces around the board without overlaps.
+ *
+ * Bounding boxes (lattice coordinates, one cell gap) are packed in
+ * shelves, tallest piece first, into a band of a given width centered on
+ * the board. Shelves next to the board are split in a left and a right
+ * part. Several widths are tried and the layout whose bounding box comes
+ * closest to the aspect ratio (width / height) with the least area wins.
+ * Positions are moved right onto the next translation of the lattice, so
+ * pieces land on whole cells of triangle and hex grids as well.
+ */
+class PieceLayout {
+ public:
+    static QList<QPoint> arrange(const QVector<QPointF> &boardPoly,
+                                 const QList<QVector<QPointF> > &listPieces,
+                                 const qreal dAspectRatio);
+
+ private:
+    struct Item {
+      int nPiece;
+      int nWidth;  // Including the gap
+      int nHeight;
+      QPoint offset;  // Top left of the piece polygon
+    };
+
+    static const int GAP = 1;
+
+    static int latticeShift(const QPoint &pos);
+    static bool higherThan(const Item &item1, const Item &item2);
+    static void bounds(const QVector<QPointF> &polygon,
+                       QPoint *pMin, QPoint *pMax);
+    static QRect pack(const QRect &board, const QList<Item> &listItems,
+                      const int nWidth, const qreal dAspectRatio,
+                      QList<QPoint> *pListPos);
+};
+
+#endif  // PIECELAYOUT_H_
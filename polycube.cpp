@@ -0,0 +1,114 @@
+/**
+ * \file polycube.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Polycube helpers (voxels and orientations).
+ */
+
+#include "./polycube.h"
+
+#include <limits.h>
+
+#include "./lattice.h"
+
+QVector<Voxel> Polycube::fromPolygon(const QVector<QPointF> &polygon,
+                                     const int nZ) {
+  QVector<Voxel> listVoxels;
+  foreach (const QPoint &cell, latticeCells(polygon)) {
+    listVoxels << Voxel(cell.x(), cell.y(), nZ);
+  }
+  return listVoxels;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+QVector<Voxel> Polycube::normalize(QVector<Voxel> listVoxels) {
+  Voxel minimum(INT_MAX, INT_MAX, INT_MAX);
+  foreach (const Voxel &v, listVoxels) {
+    minimum.x = qMin(minimum.x, v.x);
+    minimum.y = qMin(minimum.y, v.y);
+    minimum.z = qMin(minimum.z, v.z);
+  }
+  for (int i = 0; i < listVoxels.size(); i++) {
+    listVoxels[i] = listVoxels[i] - minimum;
+  }
+  qSort(listVoxels);
+  return listVoxels;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+QList<QVector<Voxel> > Polycube::orientations(
+    const QVector<Voxel> &listVoxels, const Symmetry symmetry) {
+  // All 6 axis permutations, odd permutations have negative determinant
+  static const int nPerms[6][3] = {{0, 1, 2}, {1, 2, 0}, {2, 0, 1},
+                                   {1, 0, 2}, {0, 2, 1}, {2, 1, 0}};
+  QList<QVector<Voxel> > listOrientations;
+
+  if (PlaneSymmetry == symmetry) {  // Symmetries of the 2D lattice
+    for (int nSym = 0; nSym < 2 * Lattice::ROTATIONS; nSym++) {
+      QList<QPoint> listCells;
+      foreach (const Voxel &v, listVoxels) {
+        listCells << Lattice::transformCell(QPoint(v.x, v.y), nSym);
+      }
+      normalizeCells(&listCells);
+      QVector<Voxel> listTrans;
+      listTrans.reserve(listCells.size());
+      foreach (const QPoint &cell, listCells) {
+        listTrans << Voxel(cell.x(), cell.y(), 0);
+      }
+      if (!listOrientations.contains(listTrans)) {
+        listOrientations << listTrans;
+      }
+    }
+    return listOrientations;
+  }
+
+  for (int p = 0; p < 6; p++) {
+    for (int nSigns = 0; nSigns < 8; nSigns++) {
+      const bool bOddPerm(p >= 3);
+      const bool bOddSigns(((nSigns & 1) ^ ((nSigns >> 1) & 1) ^
+                            ((nSigns >> 2) & 1)) != 0);
+      if (SpaceRotations == symmetry && bOddPerm != bOddSigns) {
+        continue;  // Reflection
+      }
+
+      QVector<Voxel> listTrans;
+      listTrans.reserve(listVoxels.size());
+      foreach (const Voxel &v, listVoxels) {
+        const int n[3] = {v.x, v.y, v.z};
+        int t[3];
+        for (int i = 0; i < 3; i++) {
+          t[i] = (nSigns & (1 << i)) ? -n[nPerms[p][i]] : n[nPerms[p][i]];
+        }
+        listTrans << Voxel(t[0], t[1], t[2]);
+      }
+      listTrans = Polycube::normalize(listTrans);
+      if (!listOrientations.contains(listTrans)) {
+        listOrientations << listTrans;
+      }
+    }
+  }
+  return listOrientations;
+}
@@ -0,0 +1,86 @@
+/**
+ * \file polycube.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for polycube helpers (voxels and orientations).
+ */
+
+#ifndef POLYCUBE_H_
+#define POLYCUBE_H_
+
+#include <QHash>
+#include <QList>
+#include <QPointF>
+#include <QVector>
+
+/**
+ * \struct Voxel
+ * \brief Unit cell of a 2D (z = 0) or 3D board.
+ */
+struct Voxel {
+  Voxel(const int nX = 0, const int nY = 0, const int nZ = 0)
+    : x(nX), y(nY), z(nZ) {
+  }
+  bool operator==(const Voxel &other) const {
+    return x == other.x && y == other.y && z == other.z;
+  }
+  bool operator<(const Voxel &other) const {
+    if (z != other.z) return z < other.z;
+    if (y != other.y) return y < other.y;
+    return x < other.x;
+  }
+  Voxel operator+(const Voxel &other) const {
+    return Voxel(x + other.x, y + other.y, z + other.z);
+  }
+  Voxel operator-(const Voxel &other) const {
+    return Voxel(x - other.x, y - other.y, z - other.z);
+  }
+
+  int x;
+  int y;
+  int z;
+};
+
+inline uint qHash(const Voxel &v) {
+  return (uint(v.z) << 20) ^ (uint(v.y) << 10) ^ uint(v.x);
+}
+
+/**
+ * \class Polycube
+ * \brief Normalization and orientations of pieces made of voxels.
+ */
+class Polycube {
+ public:
+    enum Symmetry {
+      PlaneSymmetry = 8,  // Rotation in plane and flip (2D, see lattice.h)
+      SpaceRotations = 24,  // Rotations in space (3D boxes)
+      SpaceSymmetry = 48  // Rotations and reflections in space
+    };
+
+    static QVector<Voxel> fromPolygon(const QVector<QPointF> &polygon,
+                                      const int nZ = 0);
+    static QVector<Voxel> normalize(QVector<Voxel> listVoxels);
+    static QList<QVector<Voxel> > orientations(
+        const QVector<Voxel> &listVoxels, const Symmetry symmetry);
+};
+
+#endif  // POLYCUBE_H_
@@ -0,0 +1,218 @@
+/**
+ * \file profilecounter.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Transfer matrix solution counter for narrow boards.
+ */
+
+#include "./profilecounter.h"
+
+#include <QDebug>
+#include <QHash>
+#include <QPair>
+
+#include "./lattice.h"
+#include "./polycube.h"
+#include "./solver.h"
+
+ProfileCounter::ProfileCounter(const BoardDescriptor &descriptor)
+  : m_bAllPiecesNeeded(!descriptor.bNotAllPiecesNeeded),
+    m_nPieces(descriptor.listBlocks.size()),
+    m_bValid(false),
+    m_bMajorX(true),
+    m_nHeight(0),
+    m_nLength(0),
+    m_nWindow(0),
+    m_nMaxStates(0) {
+  const QVector<Voxel> listCells(Solver::boardCells(descriptor));
+  if (descriptor.nLayers > 1 || m_nPieces > 32 || listCells.isEmpty()) {
+    return;
+  }
+
+  int nMinX(listCells.first().x), nMaxX(nMinX);
+  int nMinY(listCells.first().y), nMaxY(nMinY);
+  foreach (const Voxel &v, listCells) {
+    nMinX = qMin(nMinX, v.x);
+    nMaxX = qMax(nMaxX, v.x);
+    nMinY = qMin(nMinY, v.y);
+    nMaxY = qMax(nMaxY, v.y);
+  }
+  m_origin = QPoint(nMinX, nMinY);
+  m_bMajorX = (nMaxX - nMinX >= nMaxY - nMinY);
+  m_nHeight = 1 + (m_bMajorX ? nMaxY - nMinY : nMaxX - nMinX);
+  m_nLength = 1 + (m_bMajorX ? nMaxX - nMinX : nMaxY - nMinY);
+
+  // Bounding box positions without a board cell are occupied from start
+  m_listBlocked.fill(true, m_nHeight * m_nLength);
+  foreach (const Voxel &v, listCells) {
+    const int nMajor(m_bMajorX ? v.x - nMinX : v.y - nMinY);
+    const int nMinor(m_bMajorX ? v.y - nMinY : v.x - nMinX);
+    m_listBlocked[nMajor * m_nHeight + nMinor] = false;
+  }
+
+  int nMaxBit(0);
+  foreach (const BoardDescriptor::Piece &piece, descriptor.listBlocks) {
+    QList<Shape> listShapes;
+    foreach (const QVector<Voxel> &orient,
+             Polycube::orientations(Polycube::fromPolygon(piece.polygon),
+                                    Polycube::PlaneSymmetry)) {
+      // First cell in sweep order: smallest major, then minor coordinate
+      Voxel anchor(orient.first());
+      foreach (const Voxel &v, orient) {
+        const int nMajor(m_bMajorX ? v.x - anchor.x : v.y - anchor.y);
+        const int nMinor(m_bMajorX ? v.y - anchor.y : v.x - anchor.x);
+        if (nMajor < 0 || (0 == nMajor && nMinor < 0)) {
+          anchor = v;
+        }
+      }
+
+      Shape shape;
+      shape.anchor = QPoint(anchor.x, anchor.y);
+      shape.nMask = 0;
+      shape.nMinMinor = 0;
+      shape.nMaxMinor = 0;
+      shape.nMaxMajor = 0;
+      foreach (const Voxel &v, orient) {
+        const int nMinor(m_bMajorX ? v.y - anchor.y : v.x - anchor.x);
+        shape.nMinMinor = qMin(shape.nMinMinor, nMinor);
+        shape.nMaxMinor = qMax(shape.nMaxMinor, nMinor);
+      }
+      // Wider than the board: never fits, its bits would wrap into the
+      // neighbouring line
+      if (shape.nMaxMinor - shape.nMinMinor >= m_nHeight) {
+        continue;
+      }
+
+      foreach (const Voxel &v, orient) {
+        const int nMajor(m_bMajorX ? v.x - anchor.x : v.y - anchor.y);
+        const int nMinor(m_bMajorX ? v.y - anchor.y : v.x - anchor.x);
+        const int nBit(nMajor * m_nHeight + nMinor);
+        if (nBit < 0 || nBit >= 64) {
+          qWarning() << "Board too wide for transfer matrix counter.";
+          return;
+        }
+        shape.nMask |= Q_UINT64_C(1) << nBit;
+        shape.nMaxMajor = qMax(shape.nMaxMajor, nMajor);
+        nMaxBit = qMax(nMaxBit, nBit);
+      }
+      listShapes << shape;
+    }
+    m_listShapes << listShapes;
+  }
+
+  m_nWindow = nMaxBit + 1;
+  m_bValid = true;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+quint64 ProfileCounter::countSolutions() {
+  if (!m_bValid) {
+    return 0;
+  }
+
+  // Frontier: bit i = position nPos + i is occupied
+  typedef QPair<quint64, quint32> State;  // Frontier, used pieces
+  const int nPositions(m_listBlocked.size());
+  quint64 nStart(0);
+  for (int i = 0; i < m_nWindow && i < nPositions; i++) {
+    if (m_listBlocked.at(i)) {
+      nStart |= Q_UINT64_C(1) << i;
+    }
+  }
+  QHash<State, quint64> hashStates;
+  QHash<State, quint64> hashNext;
+  hashStates.insert(State(nStart, 0), 1);
+  m_nMaxStates = 1;
+
+  for (int nPos = 0; nPos < nPositions; nPos++) {
+    const int nMajor(nPos / m_nHeight);
+    const int nMinor(nPos % m_nHeight);
+    const QPoint key(this->cellKey(nPos));
+    // Position entering the frontier with the shift
+    const quint64 nEnter((nPos + m_nWindow < nPositions &&
+                          m_listBlocked.at(nPos + m_nWindow)) ?
+                           Q_UINT64_C(1) << (m_nWindow - 1) : 0);
+
+    hashNext.clear();
+    QHash<State, quint64>::const_iterator it = hashStates.constBegin();
+    for (; it != hashStates.constEnd(); ++it) {
+      const quint64 nFrontier(it.key().first);
+      const quint32 nUsed(it.key().second);
+      if (nFrontier & 1) {
+        hashNext[State((nFrontier >> 1) | nEnter, nUsed)] += it.value();
+        continue;
+      }
+
+      // Free cell: first cell of an unused piece
+      for (int nPiece = 0; nPiece < m_nPieces; nPiece++) {
+        if (nUsed & (1u << nPiece)) {
+          continue;
+        }
+        foreach (const Shape &shape, m_listShapes.at(nPiece)) {
+          if (nMinor + shape.nMinMinor < 0 ||
+              nMinor + shape.nMaxMinor >= m_nHeight ||
+              nMajor + shape.nMaxMajor >= m_nLength ||
+              (nFrontier & shape.nMask) ||
+              !Lattice::isTranslation(key - shape.anchor)) {
+            continue;
+          }
+          hashNext[State(((nFrontier | shape.nMask) >> 1) | nEnter,
+                         nUsed | (1u << nPiece))] += it.value();
+        }
+      }
+    }
+    hashStates.swap(hashNext);
+    m_nMaxStates = qMax(m_nMaxStates, hashStates.size());
+  }
+
+  // Pieces never reach beyond the last column, so all frontiers are empty
+  const quint32 nAllPieces(m_nPieces >= 32 ? 0xFFFFFFFF :
+                                             (1u << m_nPieces) - 1);
+  quint64 nSolutions(0);
+  QHash<State, quint64>::const_iterator it = hashStates.constBegin();
+  for (; it != hashStates.constEnd(); ++it) {
+    if (!m_bAllPiecesNeeded || nAllPieces == it.key().second) {
+      nSolutions += it.value();
+    }
+  }
+  return nSolutions;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+QPoint ProfileCounter::cellKey(const int nPos) const {
+  const int nMajor(nPos / m_nHeight);
+  const int nMinor(nPos % m_nHeight);
+  return m_origin + (m_bMajorX ? QPoint(nMajor, nMinor) :
+                                 QPoint(nMinor, nMajor));
+}
+
+bool ProfileCounter::isValid() const {
+  return m_bValid;
+}
+
+int ProfileCounter::getMaxStates() const {
+  return m_nMaxStates;
+}
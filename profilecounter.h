@@ -0,0 +1,82 @@
+/**
+ * \file profilecounter.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the transfer matrix solution counter.
+ */
+
+#ifndef PROFILECOUNTER_H_
+#define PROFILECOUNTER_H_
+
+#include <QList>
+#include <QPoint>
+#include <QVector>
+
+#include "./boarddescriptor.h"
+
+/**
+ * \class ProfileCounter
+ * \brief Counts solutions of narrow boards by dynamic programming.
+ *
+ * Cells are swept column by column along the longer side (broken
+ * profile). A state is the occupancy of the next cells (frontier) and
+ * the set of used pieces, equal states of all partial solutions are
+ * merged in a hash map. The first free cell is always covered by a
+ * piece, which has its first cell (in sweep order) there.
+ *
+ * Independent of the exact cover solver, so both counts check each
+ * other. Only 2D boards with up to 32 pieces and a frontier of up to
+ * 64 cells (short side times longest piece extent) are supported.
+ */
+class ProfileCounter {
+ public:
+    explicit ProfileCounter(const BoardDescriptor &descriptor);
+
+    bool isValid() const;
+    quint64 countSolutions();
+    int getMaxStates() const;
+
+ private:
+    struct Shape {
+      QPoint anchor;  // Key of the first cell in sweep order
+      quint64 nMask;  // Cells relative to the first one
+      int nMinMinor;
+      int nMaxMinor;
+      int nMaxMajor;
+    };
+
+    QPoint cellKey(const int nPos) const;
+
+    const bool m_bAllPiecesNeeded;
+    const int m_nPieces;
+    bool m_bValid;
+    bool m_bMajorX;  // Sweep along x (columns are y)
+    QPoint m_origin;
+    int m_nHeight;  // Cells of one column (short side)
+    int m_nLength;  // Number of columns
+    int m_nWindow;  // Frontier bits
+    QVector<bool> m_listBlocked;  // Per position: not a board cell
+    QList<QList<Shape> > m_listShapes;  // Orientations per piece
+    int m_nMaxStates;
+};
+
+#endif  // PROFILECOUNTER_H_
@@ -0,0 +1,96 @@
+/**
+ * \file protocol.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Message framing and piece encoding of the solver daemon and puzzle
+ * server protocols.
+ */
+
+#ifndef PROTOCOL_H_
+#define PROTOCOL_H_
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QtEndian>
+
+#include "./solver.h"
+
+// Every message is a big endian quint32 size followed by the payload
+static const quint32 MAX_MESSAGE_SIZE = 1 << 16;
+
+inline QByteArray frameMessage(const QByteArray &message) {
+  QByteArray data(4, 0);
+  qToBigEndian<quint32>(message.size(),
+                        reinterpret_cast<uchar *>(data.data()));
+  return data + message;
+}
+
+// Size of the next message in the buffer, 0 if not known yet
+inline quint32 nextMessageSize(const QByteArray &buffer) {
+  if (buffer.size() < 4) {
+    return 0;
+  }
+  return qFromBigEndian<quint32>(
+        reinterpret_cast<const uchar *>(buffer.constData()));
+}
+
+// Removes the first complete message from the buffer
+inline bool takeMessage(QByteArray *pBuffer, QByteArray *pMessage) {
+  if (pBuffer->size() < 4) {
+    return false;
+  }
+  const quint32 nSize(nextMessageSize(*pBuffer));
+  if (quint32(pBuffer->size() - 4) < nSize) {
+    return false;
+  }
+  *pMessage = pBuffer->mid(4, nSize);
+  pBuffer->remove(0, 4 + nSize);
+  return true;
+}
+
+// Piece: quint8 index (0xFF = none), quint8 number of cells, qint16 x, y, z
+inline void writePlacement(QDataStream *pStream,
+                           const Solver::Placement &placement) {
+  *pStream << quint8(placement.nPiece < 0 ? 0xFF : placement.nPiece)
+           << quint8(placement.listCells.size());
+  foreach (const Voxel &v, placement.listCells) {
+    *pStream << qint16(v.x) << qint16(v.y) << qint16(v.z);
+  }
+}
+
+inline bool readPlacement(QDataStream *pStream,
+                          Solver::Placement *pPlacement) {
+  quint8 nPiece(0);
+  quint8 nCells(0);
+  *pStream >> nPiece >> nCells;
+  pPlacement->nPiece = (0xFF == nPiece) ? -1 : nPiece;
+  pPlacement->nOrientation = 0;
+  pPlacement->listCells.clear();
+  for (int i = 0; i < nCells; i++) {
+    qint16 x(0), y(0), z(0);
+    *pStream >> x >> y >> z;
+    pPlacement->listCells << Voxel(x, y, z);
+  }
+  return QDataStream::Ok == pStream->status();
+}
+
+#endif  // PROTOCOL_H_
@@ -0,0 +1,226 @@
+/**
+ * \file puzzleserver.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Headless multi-session puzzle server.
+ */
+
+#include "./puzzleserver.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QTcpSocket>
+#include <QThread>
+
+#include "./protocol.h"
+
+const quint8 PuzzleServer::PROTOCOL_VERSION = 1;
+const quint16 PuzzleServer::DEFAULT_PORT = 7412;
+
+PuzzleServer::PuzzleServer(const QString &sBoardsDir, const int nThreads,
+                           const int nMaxSessions, QObject *pParent)
+  : QTcpServer(pParent),
+    m_Store(sBoardsDir, nMaxSessions),
+    m_nNextWorker(0) {
+  qRegisterMetaType<qintptr>("qintptr");
+
+  const int nWorkers(nThreads > 0 ? nThreads :
+                                    qMax(1, QThread::idealThreadCount()));
+  for (int i = 0; i < nWorkers; i++) {
+    QThread *pThread = new QThread(this);
+    ServerWorker *pWorker = new ServerWorker(&m_Store);
+    pWorker->moveToThread(pThread);
+    connect(pThread, SIGNAL(finished()), pWorker, SLOT(deleteLater()));
+    pThread->start();
+    m_listThreads << pThread;
+    m_listWorkers << pWorker;
+  }
+  qDebug() << "Puzzle server:" << nWorkers << "worker threads, max."
+           << nMaxSessions << "sessions";
+}
+
+PuzzleServer::~PuzzleServer() {
+  this->close();
+  foreach (QThread *pThread, m_listThreads) {
+    pThread->quit();
+    pThread->wait();
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void PuzzleServer::incomingConnection(qintptr nSocketDescriptor) {
+  // Socket is created in the thread of the worker
+  ServerWorker *pWorker = m_listWorkers.at(m_nNextWorker);
+  m_nNextWorker = (m_nNextWorker + 1) % m_listWorkers.size();
+  QMetaObject::invokeMethod(pWorker, "addConnection", Qt::QueuedConnection,
+                            Q_ARG(qintptr, nSocketDescriptor));
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+ServerWorker::ServerWorker(SessionStore *pStore, QObject *pParent)
+  : QObject(pParent),
+    m_pStore(pStore) {
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void ServerWorker::addConnection(qintptr nSocketDescriptor) {
+  QTcpSocket *pSocket = new QTcpSocket(this);
+  if (!pSocket->setSocketDescriptor(nSocketDescriptor)) {
+    qWarning() << "Puzzle server:" << pSocket->errorString();
+    delete pSocket;
+    return;
+  }
+  // Replies are small, don't wait for more data (Nagle)
+  pSocket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+  m_hashConnections[pSocket] = Connection();
+  connect(pSocket, SIGNAL(readyRead()),
+          this, SLOT(readRequest()));
+  connect(pSocket, SIGNAL(disconnected()),
+          this, SLOT(removeConnection()));
+}
+
+void ServerWorker::removeConnection() {
+  QTcpSocket *pSocket = qobject_cast<QTcpSocket *>(this->sender());
+  if (NULL == pSocket) {
+    return;
+  }
+  foreach (quint32 nSession, m_hashConnections.value(pSocket).setSessions) {
+    m_pStore->closeSession(nSession);
+  }
+  m_hashConnections.remove(pSocket);
+  pSocket->deleteLater();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void ServerWorker::readRequest() {
+  QTcpSocket *pSocket = qobject_cast<QTcpSocket *>(this->sender());
+  if (NULL == pSocket || !m_hashConnections.contains(pSocket)) {
+    return;
+  }
+
+  Connection &connection = m_hashConnections[pSocket];
+  connection.buffer += pSocket->readAll();
+  if (nextMessageSize(connection.buffer) > MAX_MESSAGE_SIZE) {
+    qWarning() << "Puzzle server: invalid request size.";
+    connection.buffer.clear();
+    pSocket->disconnectFromHost();
+    return;
+  }
+
+  // All replies of one read are sent together
+  QByteArray request;
+  QByteArray replies;
+  while (takeMessage(&connection.buffer, &request)) {
+    replies += frameMessage(this->processRequest(request, &connection));
+  }
+  if (!replies.isEmpty()) {
+    pSocket->write(replies);
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+QByteArray ServerWorker::processRequest(const QByteArray &request,
+                                        Connection *pConnection) {
+  QDataStream in(request);
+  quint8 nVersion(0);
+  quint8 nCommand(0);
+  in >> nVersion >> nCommand;
+
+  QByteArray message;
+  QDataStream out(&message, QIODevice::WriteOnly);
+  if (PuzzleServer::PROTOCOL_VERSION != nVersion ||
+      QDataStream::Ok != in.status()) {
+    out << quint8(SessionStore::StatusBadRequest);
+    return message;
+  }
+
+  if (PuzzleServer::CommandCreate == nCommand) {
+    QByteArray baBoard;
+    in >> baBoard;
+    quint32 nSession(0);
+    int nPieces(0);
+    int nCells(0);
+    SessionStore::Status status(SessionStore::StatusBadRequest);
+    if (QDataStream::Ok == in.status()) {
+      status = m_pStore->createSession(QString::fromUtf8(baBoard),
+                                       &nSession, &nPieces, &nCells);
+    }
+    if (SessionStore::StatusOk == status) {
+      pConnection->setSessions << nSession;
+    }
+    out << quint8(status) << nSession << quint8(nPieces) << quint16(nCells);
+    return message;
+  }
+
+  quint32 nSession(0);
+  in >> nSession;
+  if (QDataStream::Ok != in.status()) {
+    out << quint8(SessionStore::StatusBadRequest);
+    return message;
+  }
+  if (!pConnection->setSessions.contains(nSession)) {
+    out << quint8(SessionStore::StatusUnknownSession);
+    return message;
+  }
+
+  switch (nCommand) {
+    case PuzzleServer::CommandMove: {
+      Solver::Placement placement;
+      quint32 nMoves(0);
+      SessionStore::Status status(SessionStore::StatusBadRequest);
+      if (readPlacement(&in, &placement)) {
+        status = m_pStore->move(nSession, placement.nPiece,
+                                placement.listCells, &nMoves);
+      }
+      out << quint8(status) << nMoves;
+      break;
+    }
+    case PuzzleServer::CommandState: {
+      QList<Solver::Placement> listPlaced;
+      quint32 nMoves(0);
+      const SessionStore::Status status(
+            m_pStore->state(nSession, &listPlaced, &nMoves));
+      out << quint8(status) << nMoves << quint8(listPlaced.size());
+      foreach (const Solver::Placement &placement, listPlaced) {
+        writePlacement(&out, placement);
+      }
+      break;
+    }
+    case PuzzleServer::CommandClose:
+      pConnection->setSessions.remove(nSession);
+      out << quint8(m_pStore->closeSession(nSession));
+      break;
+    default:
+      out << quint8(SessionStore::StatusBadRequest);
+      break;
+  }
+  return message;
+}
@@ -0,0 +1,119 @@
+/**
+ * \file puzzleserver.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the headless multi-session puzzle server.
+ */
+
+#ifndef PUZZLESERVER_H_
+#define PUZZLESERVER_H_
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QTcpServer>
+
+#include "./sessionstore.h"
+
+class QTcpSocket;
+class QThread;
+
+/**
+ * \class ServerWorker
+ * \brief Handles the connections assigned to one thread of the server.
+ */
+class ServerWorker : public QObject {
+  Q_OBJECT
+
+ public:
+    explicit ServerWorker(SessionStore *pStore, QObject *pParent = 0);
+
+ public slots:
+    void addConnection(qintptr nSocketDescriptor);
+
+ private slots:
+    void readRequest();
+    void removeConnection();
+
+ private:
+    struct Connection {
+      QByteArray buffer;
+      QSet<quint32> setSessions;  // Sessions created by this client
+    };
+
+    QByteArray processRequest(const QByteArray &request,
+                              Connection *pConnection);
+
+    SessionStore *m_pStore;
+    QHash<QTcpSocket *, Connection> m_hashConnections;
+};
+
+// ---------------------------------------------------------------------------
+
+/**
+ * \class PuzzleServer
+ * \brief Game sessions of many players over TCP, without any GUI.
+ *
+ * Started with --server. Connections are distributed round robin to
+ * worker threads, all sessions are kept in one SessionStore. A client
+ * can only use the sessions it created, they are closed on disconnect.
+ *
+ * Messages are framed as in protocol.h, the payload uses QDataStream.
+ * Request: quint8 version, quint8 command and
+ * Create: QByteArray board file relative to the boards folder (UTF-8),
+ * Move: quint32 session, piece as in protocol.h (no cells = remove),
+ * State / Close: quint32 session.
+ * Reply: quint8 status and
+ * Create: quint32 session, quint8 pieces, quint16 cells,
+ * Move: quint32 moves,
+ * State: quint32 moves, quint8 placed pieces, pieces as in protocol.h.
+ */
+class PuzzleServer : public QTcpServer {
+  Q_OBJECT
+
+ public:
+    enum Command {
+      CommandCreate = 1,
+      CommandMove = 2,
+      CommandState = 3,
+      CommandClose = 4
+    };
+
+    PuzzleServer(const QString &sBoardsDir, const int nThreads,
+                 const int nMaxSessions, QObject *pParent = 0);
+    ~PuzzleServer();
+
+    static const quint8 PROTOCOL_VERSION;
+    static const quint16 DEFAULT_PORT;
+
+ protected:
+    void incomingConnection(qintptr nSocketDescriptor);
+
+ private:
+    SessionStore m_Store;
+    QList<QThread *> m_listThreads;
+    QList<ServerWorker *> m_listWorkers;
+    int m_nNextWorker;
+};
+
+#endif  // PUZZLESERVER_H_
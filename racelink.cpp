@@ -0,0 +1,350 @@
+/**
+ * \file racelink.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Connection between two racing players.
+ */
+
+#include "./racelink.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#include "./protocol.h"
+
+const quint8 RaceLink::PROTOCOL_VERSION = 1;
+const quint16 RaceLink::DEFAULT_PORT = 7413;
+const int RaceLink::NO_CELL = -1;
+const qint64 RaceLink::FRAME_USECS = 1000000 / 60;
+
+RaceLink::RaceLink(QObject *pParent)
+  : QObject(pParent),
+    m_pServer(NULL),
+    m_pSocket(NULL),
+    m_pMirror(NULL),
+    m_bMirror(false),
+    m_bHost(false),
+    m_nSequence(0),
+    m_nMaxRoundTrip(0),
+    m_nMovesSent(0) {
+  m_Clock.start();
+}
+
+RaceLink::~RaceLink() {
+  this->leave();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool RaceLink::host(const quint16 nPort, const QHostAddress &address) {
+  this->leave();
+  m_pServer = new QTcpServer(this);
+  connect(m_pServer, SIGNAL(newConnection()),
+          this, SLOT(acceptConnection()));
+  if (!m_pServer->listen(address, nPort)) {
+    qWarning() << "Race:" << m_pServer->errorString();
+    delete m_pServer;
+    m_pServer = NULL;
+    return false;
+  }
+  m_bHost = true;
+  qDebug() << "Race: waiting for opponent on port" << this->getPort();
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+
+void RaceLink::join(const QString &sHost, const quint16 nPort) {
+  this->leave();
+  m_bHost = false;
+  QTcpSocket *pSocket = new QTcpSocket(this);
+  connect(pSocket, SIGNAL(connected()),
+          this, SLOT(joined()));
+  this->setSocket(pSocket);
+  pSocket->connectToHost(sHost, nPort);
+}
+
+// ---------------------------------------------------------------------------
+
+bool RaceLink::startLoopback() {
+  if (!this->host(0, QHostAddress::LocalHost)) {
+    return false;
+  }
+  m_pMirror = new RaceLink(this);
+  m_pMirror->m_bMirror = true;
+  m_pMirror->join(QHostAddress(QHostAddress::LocalHost).toString(),
+                  this->getPort());
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+
+void RaceLink::leave() {
+  delete m_pMirror;
+  m_pMirror = NULL;
+  if (NULL != m_pSocket) {
+    m_pSocket->disconnect(this);
+    m_pSocket->abort();
+    m_pSocket->deleteLater();
+    m_pSocket = NULL;
+  }
+  delete m_pServer;
+  m_pServer = NULL;
+
+  if (m_nMovesSent > 0 && !m_bMirror) {
+    qDebug() << "Race:" << m_nMovesSent << "moves sent, max. round trip"
+             << m_nMaxRoundTrip << "usecs";
+  }
+  m_buffer.clear();
+  m_hashSent.clear();
+  m_nMaxRoundTrip = 0;
+  m_nMovesSent = 0;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool RaceLink::isActive() const {
+  return NULL != m_pServer || NULL != m_pSocket;
+}
+
+bool RaceLink::isConnected() const {
+  return NULL != m_pSocket &&
+      QAbstractSocket::ConnectedState == m_pSocket->state();
+}
+
+bool RaceLink::isHost() const {
+  return m_bHost;
+}
+
+quint16 RaceLink::getPort() const {
+  if (NULL != m_pServer) {
+    return m_pServer->serverPort();
+  }
+  return 0;
+}
+
+qint64 RaceLink::getMaxRoundTrip() const {
+  return m_nMaxRoundTrip;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void RaceLink::acceptConnection() {
+  QTcpSocket *pSocket = m_pServer->nextPendingConnection();
+  if (NULL == pSocket) {
+    return;
+  }
+  // One opponent only
+  m_pServer->close();
+  if (NULL != m_pSocket) {
+    pSocket->abort();
+    pSocket->deleteLater();
+    return;
+  }
+  pSocket->setParent(this);
+  this->setSocket(pSocket);
+  this->joined();
+}
+
+void RaceLink::joined() {
+  // Every move is a message of its own, don't wait for more data (Nagle)
+  m_pSocket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+  if (!m_bMirror) {
+    qDebug() << "Race: connected to" << m_pSocket->peerAddress().toString();
+  }
+  emit connected();
+}
+
+// ---------------------------------------------------------------------------
+
+void RaceLink::setSocket(QTcpSocket *pSocket) {
+  m_pSocket = pSocket;
+  m_buffer.clear();
+  connect(m_pSocket, SIGNAL(readyRead()),
+          this, SLOT(readMessages()));
+  connect(m_pSocket, SIGNAL(disconnected()),
+          this, SLOT(closeConnection()));
+  connect(m_pSocket, SIGNAL(error(QAbstractSocket::SocketError)),
+          this, SLOT(closeConnection()));
+}
+
+void RaceLink::closeConnection() {
+  if (NULL == m_pSocket) {
+    return;
+  }
+  if (QAbstractSocket::RemoteHostClosedError != m_pSocket->error() &&
+      QAbstractSocket::UnknownSocketError != m_pSocket->error()) {
+    qWarning() << "Race:" << m_pSocket->errorString();
+  }
+  this->leave();
+  emit disconnected();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void RaceLink::sendBoard(const QString &sBoard) {
+  QByteArray message;
+  QDataStream out(&message, QIODevice::WriteOnly);
+  out << PROTOCOL_VERSION << quint8(MessageBoard) << sBoard.toUtf8();
+  this->send(message);
+}
+
+void RaceLink::sendMove(const int nPiece, const int nOrientation,
+                        const int nCell) {
+  if (!this->isConnected()) {
+    return;
+  }
+  const quint16 nSequence(m_nSequence++);
+  m_hashSent[nSequence] = m_Clock.nsecsElapsed() / 1000;
+  m_nMovesSent++;
+
+  QByteArray message;
+  QDataStream out(&message, QIODevice::WriteOnly);
+  out << PROTOCOL_VERSION << quint8(MessageMove) << nSequence
+      << quint8(nPiece) << quint8(nOrientation)
+      << quint16(NO_CELL == nCell ? 0xFFFF : nCell);
+  this->send(message);
+}
+
+void RaceLink::sendSolved(const quint32 nMoves, const quint32 nSeconds) {
+  QByteArray message;
+  QDataStream out(&message, QIODevice::WriteOnly);
+  out << PROTOCOL_VERSION << quint8(MessageSolved) << nMoves << nSeconds;
+  this->send(message);
+}
+
+// ---------------------------------------------------------------------------
+
+void RaceLink::send(const QByteArray &message) {
+  if (!this->isConnected()) {
+    return;
+  }
+  m_pSocket->write(frameMessage(message));
+  // Hand over to the network stack now instead of on the next event loop
+  m_pSocket->flush();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void RaceLink::readMessages() {
+  if (NULL == m_pSocket) {
+    return;
+  }
+  m_buffer += m_pSocket->readAll();
+  if (nextMessageSize(m_buffer) > MAX_MESSAGE_SIZE) {
+    qWarning() << "Race: invalid message size.";
+    this->leave();
+    emit disconnected();
+    return;
+  }
+
+  QByteArray message;
+  // Socket is gone, if a message ended the race
+  while (NULL != m_pSocket && takeMessage(&m_buffer, &message)) {
+    this->processMessage(message);
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+void RaceLink::processMessage(const QByteArray &message) {
+  QDataStream in(message);
+  quint8 nVersion(0);
+  quint8 nMessage(0);
+  in >> nVersion >> nMessage;
+  if (PROTOCOL_VERSION != nVersion || QDataStream::Ok != in.status()) {
+    qWarning() << "Race: unsupported message, version" << nVersion;
+    return;
+  }
+
+  switch (nMessage) {
+    case MessageBoard: {
+      QByteArray baBoard;
+      in >> baBoard;
+      if (QDataStream::Ok == in.status() && !m_bMirror) {
+        emit boardChosen(QString::fromUtf8(baBoard));
+      }
+      break;
+    }
+    case MessageMove: {
+      quint16 nSequence(0);
+      quint8 nPiece(0);
+      quint8 nOrientation(0);
+      quint16 nCell(0);
+      in >> nSequence >> nPiece >> nOrientation >> nCell;
+      if (QDataStream::Ok != in.status()) {
+        break;
+      }
+      QByteArray ack;
+      QDataStream out(&ack, QIODevice::WriteOnly);
+      out << PROTOCOL_VERSION << quint8(MessageAck) << nSequence;
+      this->send(ack);
+
+      const int nBoardCell(0xFFFF == nCell ? NO_CELL : nCell);
+      if (m_bMirror) {
+        this->sendMove(nPiece, nOrientation, nBoardCell);
+      } else {
+        emit opponentMoved(nPiece, nOrientation, nBoardCell);
+      }
+      break;
+    }
+    case MessageAck: {
+      quint16 nSequence(0);
+      in >> nSequence;
+      if (QDataStream::Ok != in.status() || !m_hashSent.contains(nSequence)) {
+        break;
+      }
+      const qint64 nRoundTrip(m_Clock.nsecsElapsed() / 1000 -
+                              m_hashSent.take(nSequence));
+      m_nMaxRoundTrip = qMax(m_nMaxRoundTrip, nRoundTrip);
+      if (nRoundTrip > FRAME_USECS && !m_bMirror) {
+        qWarning() << "Race: move" << nSequence << "took" << nRoundTrip
+                   << "usecs, more than one frame";
+      }
+      break;
+    }
+    case MessageSolved: {
+      quint32 nMoves(0);
+      quint32 nSeconds(0);
+      in >> nMoves >> nSeconds;
+      if (QDataStream::Ok != in.status()) {
+        break;
+      }
+      if (m_bMirror) {
+        this->sendSolved(nMoves, nSeconds);
+      } else {
+        emit opponentSolved(nMoves, nSeconds);
+      }
+      break;
+    }
+    default:
+      qWarning() << "Race: unknown message" << nMessage;
+      break;
+  }
+}
@@ -0,0 +1,128 @@
+/**
+ * \file racelink.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the connection between two racing players.
+ */
+
+#ifndef RACELINK_H_
+#define RACELINK_H_
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostAddress>
+#include <QObject>
+#include <QString>
+
+class QTcpServer;
+class QTcpSocket;
+
+/**
+ * \class RaceLink
+ * \brief Head-to-head race of two players on the same board over TCP.
+ *
+ * One player hosts, the other one joins and plays the board of the host.
+ * host() listens on the given address only; the race menu uses all
+ * interfaces (the port is reachable from the network), the loopback race
+ * 127.0.0.1. The host sends the board relative to the boards folder, the
+ * joining player only opens boards inside that folder.
+ * Each move is sent as delta of one piece, i.e. a placement row of the
+ * solver split into piece, orientation and anchor cell (NO_CELL = piece
+ * left the board). The receiver acknowledges every move, the round trip
+ * is checked against one display frame. Sockets are unbuffered (no
+ * Nagle) and flushed right away. startLoopback() is a stand-in for an
+ * opponent: a second link on 127.0.0.1 which plays back every move.
+ *
+ * Messages are framed as in protocol.h, the payload uses QDataStream:
+ * quint8 version, quint8 message and
+ * Board: QByteArray board file relative to the boards folder (UTF-8),
+ * Move: quint16 sequence, quint8 piece, quint8 orientation, quint16 cell,
+ * Ack: quint16 sequence of the move,
+ * Solved: quint32 moves, quint32 seconds.
+ */
+class RaceLink : public QObject {
+  Q_OBJECT
+
+ public:
+    enum Message {
+      MessageBoard = 1,
+      MessageMove = 2,
+      MessageAck = 3,
+      MessageSolved = 4
+    };
+
+    explicit RaceLink(QObject *pParent = 0);
+    ~RaceLink();
+
+    bool host(const quint16 nPort, const QHostAddress &address);
+    void join(const QString &sHost, const quint16 nPort);
+    bool startLoopback();
+    void leave();
+    bool isActive() const;
+    bool isConnected() const;
+    bool isHost() const;
+    quint16 getPort() const;
+    qint64 getMaxRoundTrip() const;
+
+    void sendBoard(const QString &sBoard);
+    void sendMove(const int nPiece, const int nOrientation, const int nCell);
+    void sendSolved(const quint32 nMoves, const quint32 nSeconds);
+
+    static const quint8 PROTOCOL_VERSION;
+    static const quint16 DEFAULT_PORT;
+    static const int NO_CELL;
+    static const qint64 FRAME_USECS;
+
+ signals:
+    void connected();
+    void disconnected();
+    void boardChosen(const QString &sBoard);
+    void opponentMoved(const int nPiece, const int nOrientation,
+                       const int nCell);
+    void opponentSolved(const quint32 nMoves, const quint32 nSeconds);
+
+ private slots:
+    void acceptConnection();
+    void joined();
+    void readMessages();
+    void closeConnection();
+
+ private:
+    void setSocket(QTcpSocket *pSocket);
+    void send(const QByteArray &message);
+    void processMessage(const QByteArray &message);
+
+    QTcpServer *m_pServer;
+    QTcpSocket *m_pSocket;
+    QByteArray m_buffer;
+    RaceLink *m_pMirror;  // Loopback opponent
+    bool m_bMirror;  // This link plays back the moves it receives
+    bool m_bHost;
+    quint16 m_nSequence;
+    QHash<quint16, qint64> m_hashSent;  // Sequence -> time sent (usecs)
+    QElapsedTimer m_Clock;
+    qint64 m_nMaxRoundTrip;
+    quint32 m_nMovesSent;
+};
+
+#endif  // RACELINK_H_
@@ -0,0 +1,246 @@
+/**
+ * \file raceview.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Miniature of the opponent's board in a race.
+ */
+
+#include "./raceview.h"
+
+#include <QDebug>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QTransform>
+
+#include "./lattice.h"
+
+RaceView::RaceView(QWidget *pParent)
+  : QWidget(pParent),
+    m_pSolver(NULL) {
+  this->setMinimumSize(120, 90);
+  this->setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+RaceView::~RaceView() {
+  delete m_pSolver;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool RaceView::setBoard(const BoardDescriptor &descriptor) {
+  delete m_pSolver;
+  m_pSolver = NULL;
+  m_listPieceRows.clear();
+  m_listCellOwner.clear();
+  m_listPieceColors.clear();
+  if (descriptor.boardPoly.isEmpty() ||
+      !descriptor.sInvalidPolygon.isEmpty() || descriptor.nLayers > 1) {
+    this->renderBoard();
+    return false;
+  }
+
+  m_pSolver = new Solver(descriptor);
+  for (int i = 0; i < m_pSolver->getNumOfPieces(); i++) {
+    m_listPieceRows << -1;
+    m_listPieceColors << readColor(descriptor,
+                                   "Block" + QString::number(i + 1) + "/Color",
+                                   Qt::gray);
+  }
+  m_listCellOwner.fill(-1, m_pSolver->getCells().size());
+
+  m_rectPlane = QRectF();
+  foreach (const Voxel &v, m_pSolver->getCells()) {
+    m_rectPlane |= QPolygonF(
+          Lattice::cellPolygon(QPoint(v.x, v.y))).boundingRect();
+  }
+  m_bgColor = readColor(descriptor, "BGColor", Qt::white);
+  m_boardColor = readColor(descriptor, "Board/Color", Qt::lightGray);
+  m_gridColor = readColor(descriptor, "Board/GridColor", Qt::darkGray);
+
+  this->renderBoard();
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+
+QColor RaceView::readColor(const BoardDescriptor &descriptor,
+                           const QString &sKey, const QColor &fallback) {
+  // Board already warned about missing colors
+  const QColor color(descriptor.hashColors.value(sKey, ""));
+  return color.isValid() ? color : fallback;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// Placement row of a piece (-1 if not on the board), split into the
+// orientation and anchor cell of the row
+int RaceView::encodeMove(const int nPiece, const QList<QPoint> &listCells,
+                         int *pOrientation, int *pCell) const {
+  *pOrientation = 0;
+  *pCell = -1;
+  if (NULL == m_pSolver) {
+    return -1;
+  }
+
+  QVector<Voxel> listVoxels;
+  listVoxels.reserve(listCells.size());
+  foreach (const QPoint &cell, listCells) {
+    listVoxels << Voxel(cell.x(), cell.y(), 0);
+  }
+  const int nRow(m_pSolver->findPlacement(nPiece, listVoxels));
+  if (nRow < 0) {
+    return -1;
+  }
+  const Solver::Placement &placement(m_pSolver->getPlacements().at(nRow));
+  *pOrientation = placement.nOrientation;
+  *pCell = m_pSolver->getCellIndex(placement.listCells.first());
+  return nRow;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void RaceView::movePiece(const int nPiece, const int nOrientation,
+                         const int nCell) {
+  if (NULL == m_pSolver || nPiece < 0 || nPiece >= m_listPieceRows.size()) {
+    return;
+  }
+  int nRow(-1);
+  if (nCell >= 0) {
+    nRow = m_pSolver->findAnchorRow(nPiece, nOrientation, nCell);
+    if (nRow < 0) {
+      qWarning() << "Race: unknown placement of piece" << nPiece + 1;
+    }
+  }
+  const int nOldRow(m_listPieceRows.at(nPiece));
+  if (nRow == nOldRow) {
+    return;
+  }
+  m_listPieceRows[nPiece] = nRow;
+
+  QList<int> listChanged;
+  if (nOldRow >= 0) {
+    foreach (int nIndex, m_pSolver->getRowCells(nOldRow)) {
+      if (nPiece == m_listCellOwner.at(nIndex)) {
+        m_listCellOwner[nIndex] = -1;
+        listChanged << nIndex;
+      }
+    }
+  }
+  if (nRow >= 0) {
+    foreach (int nIndex, m_pSolver->getRowCells(nRow)) {
+      m_listCellOwner[nIndex] = nPiece;
+      listChanged << nIndex;
+    }
+  }
+
+  // Only the cells of this piece are painted into the cache
+  QRect rectChanged;
+  QPainter painter(&m_pixCache);
+  foreach (int nIndex, listChanged) {
+    rectChanged |= this->drawCell(&painter, nIndex);
+  }
+  painter.end();
+  this->update(rectChanged);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void RaceView::renderBoard() {
+  m_listCellPolys.clear();
+  m_pixBoard = QPixmap(this->size());
+  m_pixBoard.fill(NULL == m_pSolver ? this->palette().window().color() :
+                                      m_bgColor);
+  if (NULL == m_pSolver || m_rectPlane.isEmpty()) {
+    m_pixCache = m_pixBoard;
+    this->update();
+    return;
+  }
+
+  const qreal dMargin(4);
+  const qreal dScale(qMin((this->width() - 2 * dMargin) / m_rectPlane.width(),
+                          (this->height() - 2 * dMargin) /
+                          m_rectPlane.height()));
+  QTransform transform;
+  transform.translate(this->width() / 2.0, this->height() / 2.0);
+  transform.scale(dScale, dScale);
+  transform.translate(-m_rectPlane.center().x(), -m_rectPlane.center().y());
+  foreach (const Voxel &v, m_pSolver->getCells()) {
+    m_listCellPolys << transform.map(
+                         QPolygonF(Lattice::cellPolygon(QPoint(v.x, v.y))));
+  }
+
+  // Empty board first, then the pieces on a copy
+  QVector<int> listOwner(m_listCellOwner);
+  m_listCellOwner.fill(-1);
+  QPainter painter(&m_pixBoard);
+  for (int i = 0; i < m_listCellPolys.size(); i++) {
+    this->drawCell(&painter, i);
+  }
+  painter.end();
+  m_listCellOwner = listOwner;
+
+  m_pixCache = m_pixBoard.copy();
+  painter.begin(&m_pixCache);
+  for (int i = 0; i < m_listCellOwner.size(); i++) {
+    if (m_listCellOwner.at(i) >= 0) {
+      this->drawCell(&painter, i);
+    }
+  }
+  painter.end();
+  this->update();
+}
+
+// ---------------------------------------------------------------------------
+
+QRect RaceView::drawCell(QPainter *pPainter, const int nCell) const {
+  if (nCell >= m_listCellPolys.size()) {
+    return QRect();
+  }
+  const int nOwner(m_listCellOwner.at(nCell));
+  pPainter->setPen(m_gridColor);
+  pPainter->setBrush(nOwner < 0 ? m_boardColor :
+                                  m_listPieceColors.at(nOwner));
+  pPainter->drawPolygon(m_listCellPolys.at(nCell));
+  return m_listCellPolys.at(nCell).boundingRect().toAlignedRect().adjusted(
+        -1, -1, 1, 1);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void RaceView::paintEvent(QPaintEvent *pEvent) {
+  QPainter painter(this);
+  painter.drawPixmap(pEvent->rect(), m_pixCache, pEvent->rect());
+}
+
+void RaceView::resizeEvent(QResizeEvent *pEvent) {
+  QWidget::resizeEvent(pEvent);
+  this->renderBoard();
+}
+
+QSize RaceView::sizeHint() const {
+  return QSize(200, 150);
+}
@@ -0,0 +1,90 @@
+/**
+ * \file raceview.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the miniature of the opponent's board in a race.
+ */
+
+#ifndef RACEVIEW_H_
+#define RACEVIEW_H_
+
+#include <QColor>
+#include <QList>
+#include <QPixmap>
+#include <QPolygonF>
+#include <QVector>
+#include <QWidget>
+
+#include "./boarddescriptor.h"
+#include "./solver.h"
+
+class QPainter;
+
+/**
+ * \class RaceView
+ * \brief Live miniature of the opponent's board.
+ *
+ * Moves of both players are exchanged as placement rows of a solver for
+ * the race board (see RaceLink), encodeMove() turns the own pieces into
+ * such moves. The board is rendered once per size, pieces are drawn into
+ * a cached copy of it: a move only repaints the cells of one piece and
+ * paintEvent() just copies the changed area of the cache.
+ */
+class RaceView : public QWidget {
+  Q_OBJECT
+
+ public:
+    explicit RaceView(QWidget *pParent = 0);
+    ~RaceView();
+
+    bool setBoard(const BoardDescriptor &descriptor);
+    int encodeMove(const int nPiece, const QList<QPoint> &listCells,
+                   int *pOrientation, int *pCell) const;
+    QSize sizeHint() const;
+
+ public slots:
+    void movePiece(const int nPiece, const int nOrientation, const int nCell);
+
+ protected:
+    void paintEvent(QPaintEvent *pEvent);
+    void resizeEvent(QResizeEvent *pEvent);
+
+ private:
+    static QColor readColor(const BoardDescriptor &descriptor,
+                            const QString &sKey, const QColor &fallback);
+    void renderBoard();
+    QRect drawCell(QPainter *pPainter, const int nCell) const;
+
+    Solver *m_pSolver;
+    QList<int> m_listPieceRows;  // Current row of each piece, -1 = none
+    QVector<int> m_listCellOwner;  // Piece covering a cell, -1 = none
+    QVector<QPolygonF> m_listCellPolys;  // Widget coordinates
+    QRectF m_rectPlane;  // Board cells in plane coordinates
+    QColor m_bgColor;
+    QColor m_boardColor;
+    QColor m_gridColor;
+    QList<QColor> m_listPieceColors;
+    QPixmap m_pixBoard;  // Empty board
+    QPixmap m_pixCache;  // Board with pieces
+};
+
+#endif  // RACEVIEW_H_
@@ -0,0 +1,309 @@
+/**
+ * \file scriptboard.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Board object of scripts.
+ */
+
+#include "./scriptboard.h"
+
+#include <QDebug>
+#include <QFile>
+
+#include "./boarddescriptor.h"
+#include "./lattice.h"
+#include "./polycube.h"
+
+ScriptBoard::ScriptBoard(QObject *pParent)
+  : QObject(pParent),
+    m_pSolver(NULL),
+    m_nCalls(0) {
+}
+
+ScriptBoard::~ScriptBoard() {
+  delete m_pSolver;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool ScriptBoard::load(const QString &sBoardFile) {
+  m_nCalls++;
+  m_State = GameState();
+  delete m_pSolver;
+  m_pSolver = NULL;
+  m_listPieceRows.clear();
+  m_listRotate.clear();
+  m_listFlip.clear();
+  m_listOrientation.clear();
+
+  if (!QFile::exists(sBoardFile)) {
+    qWarning() << "Board file not found:" << sBoardFile;
+    return false;
+  }
+  const BoardDescriptor descriptor(BoardDescriptor::load(sBoardFile));
+  if (descriptor.boardPoly.isEmpty() ||
+      !descriptor.sInvalidPolygon.isEmpty()) {
+    qWarning() << "Invalid board:" << sBoardFile;
+    return false;
+  }
+  if (descriptor.sLattice != Lattice::name() || descriptor.nLayers > 1) {
+    qWarning() << "Board not supported by scripts:" << sBoardFile;
+    return false;
+  }
+
+  m_pSolver = new Solver(descriptor);
+  m_State = GameState(m_pSolver);
+  const int nPieces(m_pSolver->getNumOfPieces());
+  m_listPieceRows.resize(nPieces);
+  m_listOrientation.fill(0, nPieces);
+  const QList<Solver::Placement> &listPlacements(m_pSolver->getPlacements());
+  for (int nRow = 0; nRow < listPlacements.size(); nRow++) {
+    const Solver::Placement &placement(listPlacements.at(nRow));
+    m_listPieceRows[placement.nPiece] << nRow;
+  }
+
+  // Same orientations (and order) as the solver placements
+  for (int i = 0; i < nPieces; i++) {
+    const QList<QVector<Voxel> > listOrient(
+          Polycube::orientations(
+            Polycube::fromPolygon(descriptor.listBlocks.at(i).polygon),
+            Polycube::PlaneSymmetry));
+    QVector<int> listRotate;
+    QVector<int> listFlip;
+    const int nSyms[2] = {1, Lattice::ROTATIONS};  // Rotation, mirroring
+    foreach (const QVector<Voxel> &orient, listOrient) {
+      for (int k = 0; k < 2; k++) {
+        QList<QPoint> listCells;
+        foreach (const Voxel &v, orient) {
+          listCells << Lattice::transformCell(QPoint(v.x, v.y), nSyms[k]);
+        }
+        normalizeCells(&listCells);
+        QVector<Voxel> listTrans;
+        listTrans.reserve(listCells.size());
+        foreach (const QPoint &cell, listCells) {
+          listTrans << Voxel(cell.x(), cell.y(), 0);
+        }
+        (0 == k ? listRotate : listFlip) << listOrient.indexOf(listTrans);
+      }
+    }
+    m_listRotate << listRotate;
+    m_listFlip << listFlip;
+  }
+  return true;
+}
+
+void ScriptBoard::reset() {
+  m_nCalls++;
+  m_State = GameState(m_pSolver);
+  m_listOrientation.fill(0);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+int ScriptBoard::pieceCount() {
+  m_nCalls++;
+  return m_listOrientation.size();
+}
+
+int ScriptBoard::orientationCount(const int nPiece) {
+  m_nCalls++;
+  return this->isValidPiece(nPiece) ? m_listRotate.at(nPiece).size() : 0;
+}
+
+int ScriptBoard::orientation(const int nPiece) {
+  m_nCalls++;
+  return m_listOrientation.value(nPiece, -1);
+}
+
+int ScriptBoard::row(const int nPiece) {
+  m_nCalls++;
+  return m_State.getRow(nPiece);
+}
+
+// ---------------------------------------------------------------------------
+
+// Rows of all orientations, which fit onto the free cells
+QVariantList ScriptBoard::legalPlacements(const int nPiece) {
+  m_nCalls++;
+  QVariantList listRows;
+  if (!this->isValidPiece(nPiece)) {
+    return listRows;
+  }
+  foreach (int nRow, m_listPieceRows.at(nPiece)) {
+    if (m_State.canPlace(nPiece, nRow)) {
+      listRows << nRow;
+    }
+  }
+  return listRows;
+}
+
+// Board cells of a row as [[x, y], ...]
+QVariantList ScriptBoard::placementCells(const int nRow) {
+  m_nCalls++;
+  QVariantList listCells;
+  if (!this->isValidRow(nRow)) {
+    return listCells;
+  }
+  foreach (const Voxel &v, m_pSolver->getPlacements().at(nRow).listCells) {
+    listCells << QVariant(QVariantList() << v.x << v.y);
+  }
+  return listCells;
+}
+
+int ScriptBoard::placementPiece(const int nRow) {
+  m_nCalls++;
+  if (!this->isValidRow(nRow)) {
+    return -1;
+  }
+  return m_pSolver->getPlacements().at(nRow).nPiece;
+}
+
+int ScriptBoard::placementOrientation(const int nRow) {
+  m_nCalls++;
+  if (!this->isValidRow(nRow)) {
+    return -1;
+  }
+  return m_pSolver->getPlacements().at(nRow).nOrientation;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool ScriptBoard::move(const int nPiece, const int nX, const int nY) {
+  m_nCalls++;
+  if (!this->isValidPiece(nPiece)) {
+    return false;
+  }
+  const int nCell(m_pSolver->getCellIndex(Voxel(nX, nY, 0)));
+  const int nRow(m_pSolver->findAnchorRow(nPiece, m_listOrientation.at(nPiece),
+                                          nCell));
+  return nRow >= 0 &&
+      GameState::MoveSolved >= m_State.placeRow(nPiece, nRow);
+}
+
+bool ScriptBoard::place(const int nPiece, const int nRow) {
+  m_nCalls++;
+  if (!this->isValidPiece(nPiece) || !this->isValidRow(nRow) ||
+      GameState::MoveSolved < m_State.placeRow(nPiece, nRow)) {
+    return false;
+  }
+  m_listOrientation[nPiece] =
+      m_pSolver->getPlacements().at(nRow).nOrientation;
+  return true;
+}
+
+bool ScriptBoard::remove(const int nPiece) {
+  m_nCalls++;
+  return this->isValidPiece(nPiece) &&
+      GameState::MoveSolved >= m_State.placeRow(nPiece, -1);
+}
+
+// ---------------------------------------------------------------------------
+
+bool ScriptBoard::rotate(const int nPiece) {
+  m_nCalls++;
+  return this->turn(nPiece, m_listRotate);
+}
+
+bool ScriptBoard::flip(const int nPiece) {
+  m_nCalls++;
+  return this->turn(nPiece, m_listFlip);
+}
+
+bool ScriptBoard::turn(const int nPiece,
+                       const QVector<QVector<int> > &listTable) {
+  if (!this->isValidPiece(nPiece)) {
+    return false;
+  }
+  const int nOrientation(
+        listTable.at(nPiece).value(m_listOrientation.at(nPiece), -1));
+  if (nOrientation < 0) {
+    return false;
+  }
+
+  // A placed piece stays on its anchor cell, if the new orientation fits
+  const int nOldRow(m_State.getRow(nPiece));
+  if (nOldRow >= 0) {
+    const Solver::Placement &placement(
+          m_pSolver->getPlacements().at(nOldRow));
+    const int nCell(m_pSolver->getCellIndex(placement.listCells.first()));
+    const int nRow(m_pSolver->findAnchorRow(nPiece, nOrientation, nCell));
+    if (nRow < 0 ||
+        GameState::MoveSolved < m_State.placeRow(nPiece, nRow)) {
+      return false;
+    }
+  }
+  m_listOrientation[nPiece] = nOrientation;
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+
+bool ScriptBoard::isSolved() {
+  m_nCalls++;
+  return m_State.isSolved();
+}
+
+int ScriptBoard::moves() {
+  m_nCalls++;
+  return m_State.getMoves();
+}
+
+// Rows of a solution containing the placed pieces, empty if there is none
+QVariantList ScriptBoard::solution() {
+  m_nCalls++;
+  QVariantList listSolution;
+  if (NULL == m_pSolver) {
+    return listSolution;
+  }
+  QList<int> listFixedRows;
+  for (int i = 0; i < m_listOrientation.size(); i++) {
+    if (m_State.getRow(i) >= 0) {
+      listFixedRows << m_State.getRow(i);
+    }
+  }
+  QList<int> listRows;
+  if (m_pSolver->findSolutionRows(listFixedRows, &listRows)) {
+    foreach (int nRow, listRows) {
+      listSolution << nRow;
+    }
+  }
+  return listSolution;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+quint64 ScriptBoard::getCalls() const {
+  return m_nCalls;
+}
+
+bool ScriptBoard::isValidPiece(const int nPiece) const {
+  return nPiece >= 0 && nPiece < m_listOrientation.size();
+}
+
+bool ScriptBoard::isValidRow(const int nRow) const {
+  return NULL != m_pSolver && nRow >= 0 &&
+      nRow < m_pSolver->getPlacements().size();
+}
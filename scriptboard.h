@@ -0,0 +1,94 @@
+/**
+ * \file scriptboard.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the board object of scripts.
+ */
+
+#ifndef SCRIPTBOARD_H_
+#define SCRIPTBOARD_H_
+
+#include <QObject>
+#include <QVariantList>
+#include <QVector>
+
+#include "./gamestate.h"
+#include "./solver.h"
+
+/**
+ * \class ScriptBoard
+ * \brief Board queries and piece operations for scripts (--script).
+ *
+ * Exposed to QJSEngine as global "board". All calls work on a GameState
+ * and the placement rows of a Solver, nothing is drawn. Pieces are
+ * counted from 0, placements are solver rows. Each piece keeps an
+ * orientation while off the board: move() places it with its anchor (the
+ * first cell of the orientation) on a board cell, rotate() and flip() of a
+ * placed piece keep the anchor cell. Rotations and flips are looked up
+ * in tables built by load(), moves by Solver::findAnchorRow(), so a call
+ * costs a few hash lookups.
+ */
+class ScriptBoard : public QObject {
+  Q_OBJECT
+
+ public:
+    explicit ScriptBoard(QObject *pParent = 0);
+    ~ScriptBoard();
+
+    Q_INVOKABLE bool load(const QString &sBoardFile);
+    Q_INVOKABLE void reset();
+
+    Q_INVOKABLE int pieceCount();
+    Q_INVOKABLE int orientationCount(const int nPiece);
+    Q_INVOKABLE int orientation(const int nPiece);
+    Q_INVOKABLE int row(const int nPiece);
+    Q_INVOKABLE QVariantList legalPlacements(const int nPiece);
+    Q_INVOKABLE QVariantList placementCells(const int nRow);
+    Q_INVOKABLE int placementPiece(const int nRow);
+    Q_INVOKABLE int placementOrientation(const int nRow);
+
+    Q_INVOKABLE bool move(const int nPiece, const int nX, const int nY);
+    Q_INVOKABLE bool place(const int nPiece, const int nRow);
+    Q_INVOKABLE bool remove(const int nPiece);
+    Q_INVOKABLE bool rotate(const int nPiece);
+    Q_INVOKABLE bool flip(const int nPiece);
+    Q_INVOKABLE bool isSolved();
+    Q_INVOKABLE int moves();
+    Q_INVOKABLE QVariantList solution();
+
+    quint64 getCalls() const;
+
+ private:
+    bool isValidPiece(const int nPiece) const;
+    bool isValidRow(const int nRow) const;
+    bool turn(const int nPiece, const QVector<QVector<int> > &listTable);
+
+    Solver *m_pSolver;
+    GameState m_State;
+    QVector<QVector<int> > m_listPieceRows;  // All rows of a piece
+    QVector<QVector<int> > m_listRotate;  // Piece, orientation -> rotated
+    QVector<QVector<int> > m_listFlip;  // Piece, orientation -> mirrored
+    QVector<int> m_listOrientation;  // Current orientation of each piece
+    quint64 m_nCalls;
+};
+
+#endif  // SCRIPTBOARD_H_
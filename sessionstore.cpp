@@ -0,0 +1,170 @@
+/**
+ * \file sessionstore.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Game sessions of the puzzle server.
+ */
+
+#include "./sessionstore.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+
+#include "./lattice.h"
+
+SessionStore::SessionStore(const QString &sBoardsDir,
+                           const int nMaxSessions)
+  : m_sBoardsDir(QDir(sBoardsDir).canonicalPath()),
+    m_nMaxSessions(nMaxSessions),
+    m_nNextSession(1),
+    m_nSessions(0) {
+}
+
+SessionStore::~SessionStore() {
+  qDeleteAll(m_hashSolvers);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+SessionStore::Status SessionStore::createSession(const QString &sBoard,
+                                                 quint32 *pSession,
+                                                 int *pPieces, int *pCells) {
+  const Solver *pSolver = this->getSolver(sBoard);
+  if (NULL == pSolver) {
+    return StatusUnknownBoard;
+  }
+  if (m_nSessions.fetchAndAddOrdered(1) >= m_nMaxSessions) {
+    m_nSessions.fetchAndAddOrdered(-1);
+    return StatusFull;
+  }
+
+  // Id 0 is never used, so clients can take it as "no session"
+  quint32 nSession(m_nNextSession.fetchAndAddOrdered(1));
+  if (0 == nSession) {
+    nSession = m_nNextSession.fetchAndAddOrdered(1);
+  }
+  Shard &s = this->shard(nSession);
+  QMutexLocker locker(&s.mutex);
+  s.hashSessions.insert(nSession, GameState(pSolver));
+
+  *pSession = nSession;
+  *pPieces = pSolver->getNumOfPieces();
+  *pCells = pSolver->getCells().size();
+  return StatusOk;
+}
+
+SessionStore::Status SessionStore::closeSession(const quint32 nSession) {
+  Shard &s = this->shard(nSession);
+  QMutexLocker locker(&s.mutex);
+  if (0 == s.hashSessions.remove(nSession)) {
+    return StatusUnknownSession;
+  }
+  m_nSessions.fetchAndAddOrdered(-1);
+  return StatusOk;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+SessionStore::Status SessionStore::move(const quint32 nSession,
+                                        const int nPiece,
+                                        const QVector<Voxel> &listCells,
+                                        quint32 *pMoves) {
+  Shard &s = this->shard(nSession);
+  QMutexLocker locker(&s.mutex);
+  QHash<quint32, GameState>::iterator it = s.hashSessions.find(nSession);
+  if (s.hashSessions.end() == it) {
+    return StatusUnknownSession;
+  }
+
+  const GameState::MoveResult result(it->movePiece(nPiece, listCells));
+  *pMoves = it->getMoves();
+  switch (result) {
+    case GameState::MoveOk:
+      return StatusOk;
+    case GameState::MoveSolved:
+      return StatusSolved;
+    case GameState::MoveBlocked:
+      return StatusBlocked;
+    default:
+      return StatusInvalid;
+  }
+}
+
+SessionStore::Status SessionStore::state(
+    const quint32 nSession, QList<Solver::Placement> *pListPlaced,
+    quint32 *pMoves) {
+  Shard &s = this->shard(nSession);
+  QMutexLocker locker(&s.mutex);
+  QHash<quint32, GameState>::const_iterator it =
+      s.hashSessions.constFind(nSession);
+  if (s.hashSessions.constEnd() == it) {
+    return StatusUnknownSession;
+  }
+
+  *pListPlaced = it->getPlaced();
+  *pMoves = it->getMoves();
+  return it->isSolved() ? StatusSolved : StatusOk;
+}
+
+int SessionStore::size() const {
+  return m_nSessions.load();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+SessionStore::Shard &SessionStore::shard(const quint32 nSession) {
+  return m_Shards[nSession % NUM_SHARDS];
+}
+
+// ---------------------------------------------------------------------------
+
+const Solver *SessionStore::getSolver(const QString &sBoard) {
+  // Only boards of the boards folder can be played (no paths of clients)
+  const QString sFile(QFileInfo(m_sBoardsDir + "/" + sBoard)
+                      .canonicalFilePath());
+  if (sFile.isEmpty() || !sFile.startsWith(m_sBoardsDir + "/") ||
+      !sFile.endsWith(".conf")) {
+    return NULL;
+  }
+
+  QMutexLocker locker(&m_SolverMutex);
+  if (m_hashSolvers.contains(sFile)) {
+    return m_hashSolvers.value(sFile);
+  }
+
+  Solver *pSolver = NULL;
+  const BoardDescriptor descriptor(BoardDescriptor::load(sFile));
+  if (!descriptor.boardPoly.isEmpty() &&
+      descriptor.sInvalidPolygon.isEmpty() && !descriptor.bFreestyle &&
+      descriptor.sLattice == Lattice::name()) {
+    pSolver = new Solver(descriptor);
+  } else {
+    qWarning() << "Puzzle server: board can't be played:" << sBoard;
+  }
+  // Invalid boards are remembered as well (NULL)
+  m_hashSolvers.insert(sFile, pSolver);
+  return pSolver;
+}
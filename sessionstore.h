@@ -0,0 +1,93 @@
+/**
+ * \file sessionstore.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the game sessions of the puzzle server.
+ */
+
+#ifndef SESSIONSTORE_H_
+#define SESSIONSTORE_H_
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include "./gamestate.h"
+
+/**
+ * \class SessionStore
+ * \brief All game sessions of the puzzle server.
+ *
+ * Sessions are spread over shards by their id, each shard has its own
+ * lock. Moves of different sessions therefore rarely wait for each other,
+ * even if they are handled by several threads. The solver of a board is
+ * loaded on first use and shared by all its sessions.
+ */
+class SessionStore {
+ public:
+    enum Status {
+      StatusOk,
+      StatusSolved,
+      StatusInvalid,
+      StatusBlocked,
+      StatusUnknownSession,
+      StatusUnknownBoard,
+      StatusBadRequest,
+      StatusFull
+    };
+
+    SessionStore(const QString &sBoardsDir, const int nMaxSessions);
+    ~SessionStore();
+
+    Status createSession(const QString &sBoard, quint32 *pSession,
+                         int *pPieces, int *pCells);
+    Status move(const quint32 nSession, const int nPiece,
+                const QVector<Voxel> &listCells, quint32 *pMoves);
+    Status state(const quint32 nSession,
+                 QList<Solver::Placement> *pListPlaced, quint32 *pMoves);
+    Status closeSession(const quint32 nSession);
+    int size() const;
+
+ private:
+    Q_DISABLE_COPY(SessionStore)
+
+    struct Shard {
+      QMutex mutex;
+      QHash<quint32, GameState> hashSessions;
+    };
+
+    const Solver *getSolver(const QString &sBoard);
+    Shard &shard(const quint32 nSession);
+
+    static const int NUM_SHARDS = 64;
+
+    const QString m_sBoardsDir;
+    const int m_nMaxSessions;
+    Shard m_Shards[NUM_SHARDS];
+    QMutex m_SolverMutex;
+    QHash<QString, Solver *> m_hashSolvers;
+    QAtomicInt m_nNextSession;
+    QAtomicInt m_nSessions;
+};
+
+#endif  // SESSIONSTORE_H_
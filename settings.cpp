@@ -28,6 +28,7 @@
 
 #include <QDebug>
 #include <QDirIterator>
+#include <QKeySequence>
 #include <QMessageBox>
 
 #include "ui_settings.h"
@@ -116,12 +117,20 @@ void Settings::accept() {
     emit changeLang(this->getLanguage());
   }
 
+  const bool bOldTelemetry(m_bTelemetry);
+  m_bTelemetry = m_pUi->checkTelemetry->isChecked();
+  m_pSettings->setValue("Telemetry", m_bTelemetry);
+  if (bOldTelemetry != m_bTelemetry) {
+    emit changeTelemetry(m_bTelemetry);
+  }
+
   m_pSettings->beginGroup("MouseControls");
   m_pSettings->setValue("MoveBlock", m_listMouseControls[0]);
   m_pSettings->setValue("RotateBlock", m_listMouseControls[1]);
   m_pSettings->setValue("FlipBlock", m_listMouseControls[2]);
   m_pSettings->remove("Enabled");
   m_pSettings->endGroup();
+  this->updateControlTable();
 
   QDialog::accept();
 }
@@ -152,6 +161,11 @@ void Settings::readSettings() {
   if (0 == m_nEasy) m_nEasy = 200;
   m_nHard = m_pSettings->value("ThresholdHard", 10).toUInt();
   if (0 == m_nHard) m_nHard = 10;
+  // Recording is opt-in, day files older than TelemetryDays are deleted
+  m_bTelemetry = m_pSettings->value("Telemetry", false).toBool();
+  m_pUi->checkTelemetry->setChecked(m_bTelemetry);
+  m_nTelemetryDays = m_pSettings->value("TelemetryDays", 90).toInt();
+  if (m_nTelemetryDays <= 0) m_nTelemetryDays = 90;
 
   m_listMouseControls.clear();
   m_listMouseControls << 0 << 0 << 0;
@@ -170,6 +184,68 @@ void Settings::readSettings() {
   m_pUi->cbFlipBlockMouse->setCurrentIndex(
         m_listMouseButtons.indexOf(m_listMouseControls.at(2)));
   m_pSettings->endGroup();
+
+  m_hashKeyControls.clear();
+  m_pSettings->beginGroup("KeyboardControls");
+  m_hashKeyControls["MoveLeft"] = m_pSettings->value("MoveLeft",
+                                                     "Left").toString();
+  m_hashKeyControls["MoveRight"] = m_pSettings->value("MoveRight",
+                                                      "Right").toString();
+  m_hashKeyControls["MoveUp"] = m_pSettings->value("MoveUp",
+                                                   "Up").toString();
+  m_hashKeyControls["MoveDown"] = m_pSettings->value("MoveDown",
+                                                     "Down").toString();
+  m_hashKeyControls["RotateBlock"] = m_pSettings->value("RotateBlock",
+                                                        "R").toString();
+  m_hashKeyControls["FlipBlock"] = m_pSettings->value("FlipBlock",
+                                                      "F").toString();
+  m_hashKeyControls["DropBlock"] = m_pSettings->value("DropBlock",
+                                                      "Return").toString();
+  m_hashKeyControls["SelectNext"] = m_pSettings->value("SelectNext",
+                                                       "Tab").toString();
+  m_hashKeyControls["SelectPrevious"] = m_pSettings->value(
+                                          "SelectPrevious",
+                                          "Backtab").toString();
+  m_pSettings->endGroup();
+
+  this->updateControlTable();
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+void Settings::updateControlTable() {
+  // Lookup tables are used on every mouse/key event
+  for (int i = 0; i < 256; i++) {
+    m_nMouseControl[i] = ControlNone;
+  }
+  m_nMouseControl[m_listMouseControls.at(0)] = ControlMove;
+  m_nMouseControl[m_listMouseControls.at(1)] = ControlRotate;
+  m_nMouseControl[m_listMouseControls.at(2)] = ControlFlip;
+
+  QHash<QString, qint8> hashNames;
+  hashNames["MoveLeft"] = ControlLeft;
+  hashNames["MoveRight"] = ControlRight;
+  hashNames["MoveUp"] = ControlUp;
+  hashNames["MoveDown"] = ControlDown;
+  hashNames["RotateBlock"] = ControlRotate;
+  hashNames["FlipBlock"] = ControlFlip;
+  hashNames["DropBlock"] = ControlDrop;
+  hashNames["SelectNext"] = ControlSelectNext;
+  hashNames["SelectPrevious"] = ControlSelectPrevious;
+
+  m_hashKeyControl.clear();
+  m_hashKeyControl[Qt::Key_Enter] = ControlDrop;  // Keypad
+  QHashIterator<QString, QString> it(m_hashKeyControls);
+  while (it.hasNext()) {
+    it.next();
+    QKeySequence keySeq(it.value());
+    if (keySeq.isEmpty()) {
+      qWarning() << "Invalid key for keyboard control" << it.key();
+      continue;
+    }
+    m_hashKeyControl[keySeq[0]] = hashNames[it.key()];
+  }
 }
 
 // ----------------------------------------------------------------------------
@@ -179,8 +255,12 @@ quint8 Settings::getShift() const {
   return m_nSHIFT;
 }
 
-QList<quint8> Settings::getMouseControls() const {
-  return m_listMouseControls;
+qint8 Settings::getMouseControl(const quint8 nButton) const {
+  return m_nMouseControl[nButton];
+}
+
+qint8 Settings::getKeyControl(const int nKey) const {
+  return m_hashKeyControl.value(nKey, ControlNone);
 }
 
 quint16 Settings::getEasy() const {
@@ -191,6 +271,14 @@ quint16 Settings::getHard() const {
   return m_nHard;
 }
 
+bool Settings::getTelemetry() const {
+  return m_bTelemetry;
+}
+
+int Settings::getTelemetryDays() const {
+  return m_nTelemetryDays;
+}
+
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
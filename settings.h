@@ -28,6 +28,7 @@
 #define SETTINGS_H_
 
 #include <QDialog>
+#include <QHash>
 #include <QSettings>
 
 namespace Ui {
@@ -45,15 +46,26 @@ class Settings : public QDialog {
     explicit Settings(const QString &sSharePath, QWidget *pParent = 0);
     virtual ~Settings();
 
-    QList<quint8> getMouseControls() const;
+    enum Control {
+      ControlNone = -1,
+      ControlMove, ControlRotate, ControlFlip,  // Mouse and keyboard
+      ControlLeft, ControlRight, ControlUp, ControlDown,  // Keyboard only
+      ControlDrop, ControlSelectNext, ControlSelectPrevious
+    };
+
+    qint8 getMouseControl(const quint8 nButton) const;
+    qint8 getKeyControl(const int nKey) const;
     quint8 getShift() const;
     QString getLanguage();
 
     quint16 getEasy() const;
     quint16 getHard() const;
+    bool getTelemetry() const;
+    int getTelemetryDays() const;
 
  signals:
     void changeLang(const QString &sLang);
+    void changeTelemetry(const bool bEnabled);
 
  public slots:
     void accept();
@@ -62,6 +74,7 @@ class Settings : public QDialog {
 
  private:
     void readSettings();
+    void updateControlTable();
     QStringList searchTranslations();
 
     QWidget *m_pParent;
@@ -74,8 +87,13 @@ class Settings : public QDialog {
     QStringList m_sListMouseButtons;
     QList<quint8> m_listMouseButtons;
     QList<quint8> m_listMouseControls;
+    QHash<QString, QString> m_hashKeyControls;
+    qint8 m_nMouseControl[256];  // Button/wheel code -> control
+    QHash<int, qint8> m_hashKeyControl;  // Qt key -> control
     quint16 m_nEasy;
     quint16 m_nHard;
+    bool m_bTelemetry;
+    int m_nTelemetryDays;
 };
 
 #endif  // SETTINGS_H_
@@ -0,0 +1,137 @@
+/**
+ * \file shapeindex.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Canonical board shapes and lookup of shapes built in freestyle mode.
+ */
+
+#include "./shapeindex.h"
+
+#include <QDebug>
+#include <QDirIterator>
+#include <QSet>
+
+#include "./boarddescriptor.h"
+#include "./lattice.h"
+
+ShapeIndex::ShapeIndex() {
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+ShapeIndex ShapeIndex::build(const QString &sBoardsPath) {
+  ShapeIndex index;
+
+  QDirIterator it(sBoardsPath, QStringList() << "*.conf",
+                  QDir::NoDotAndDotDot | QDir::Files,
+                  QDirIterator::Subdirectories);
+  while (it.hasNext()) {
+    it.next();
+    if (it.filePath().contains("freestyle")) {
+      continue;
+    }
+
+    QList<QPoint> listCells(ShapeIndex::boardCells(it.filePath()));
+    if (listCells.isEmpty()) {
+      continue;
+    }
+    QByteArray key(ShapeIndex::canonicalKey(listCells));
+    if (!index.m_hashShapes.contains(key)) {
+      index.m_hashShapes[key] = it.fileName().remove(".conf");
+    }
+  }
+
+  qDebug() << "Shape index:" << index.m_hashShapes.size() << "shapes";
+  return index;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+QList<QPoint> ShapeIndex::boardCells(const QString &sBoardFile) {
+  BoardDescriptor desc(BoardDescriptor::load(sBoardFile));
+  if (desc.nLayers > 1 || desc.sLattice != Lattice::name()) {
+    return QList<QPoint>();  // 3D box or other grid can't be built
+  }
+  QList<QPoint> listCells(latticeCells(desc.boardPoly));
+
+  // Cells covered by barriers are not part of the shape
+  QSet<quint32> setBarriers;
+  foreach (const BoardDescriptor::Piece &barrier, desc.listBarriers) {
+    const QPoint offset(Lattice::keyOffset(barrier.startPos.toPoint()));
+    foreach (const QPoint &cell, latticeCells(barrier.polygon)) {
+      QPoint pos(cell + offset);
+      setBarriers << ((quint32(quint16(pos.x())) << 16) | quint16(pos.y()));
+    }
+  }
+  if (!setBarriers.isEmpty()) {
+    for (int i = listCells.size() - 1; i >= 0; i--) {
+      const QPoint &pos(listCells.at(i));
+      if (setBarriers.contains((quint32(quint16(pos.x())) << 16) |
+                               quint16(pos.y()))) {
+        listCells.removeAt(i);
+      }
+    }
+  }
+  return listCells;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+QByteArray ShapeIndex::canonicalKey(const QList<QPoint> &listCells) {
+  QByteArray minKey;
+
+  for (int nSym = 0; nSym < 2 * Lattice::ROTATIONS; nSym++) {
+    QList<QPoint> listTrans;
+    listTrans.reserve(listCells.size());
+    foreach (const QPoint &cell, listCells) {
+      listTrans << Lattice::transformCell(cell, nSym);
+    }
+    // Sort row by row and move to origin
+    normalizeCells(&listTrans);
+
+    QByteArray key;
+    key.reserve(listTrans.size() * 4);
+    foreach (const QPoint &cell, listTrans) {
+      key.append(char(cell.y() >> 8)).append(char(cell.y()))
+          .append(char(cell.x() >> 8)).append(char(cell.x()));
+    }
+    if (minKey.isEmpty() || key < minKey) {
+      minKey = key;
+    }
+  }
+
+  return minKey;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+QString ShapeIndex::findBoard(const QList<QPoint> &listCells) const {
+  return m_hashShapes.value(ShapeIndex::canonicalKey(listCells), "");
+}
+
+int ShapeIndex::size() const {
+  return m_hashShapes.size();
+}
@@ -0,0 +1,59 @@
+/**
+ * \file shapeindex.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the board shape index.
+ */
+
+#ifndef SHAPEINDEX_H_
+#define SHAPEINDEX_H_
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QPoint>
+#include <QString>
+
+/**
+ * \class ShapeIndex
+ * \brief Index of all board shapes, independent of position and rotation.
+ *
+ * A shape is reduced to a canonical key (smallest serialization of all
+ * rotations/reflections of the lattice, moved to origin), so that a shape
+ * built in freestyle mode can be looked up with a single hash access.
+ */
+class ShapeIndex {
+ public:
+    ShapeIndex();
+
+    static ShapeIndex build(const QString &sBoardsPath);
+    static QByteArray canonicalKey(const QList<QPoint> &listCells);
+    static QList<QPoint> boardCells(const QString &sBoardFile);
+
+    QString findBoard(const QList<QPoint> &listCells) const;
+    int size() const;
+
+ private:
+    QHash<QByteArray, QString> m_hashShapes;
+};
+
+#endif  // SHAPEINDEX_H_
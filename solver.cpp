@@ -0,0 +1,320 @@
+/**
+ * \file solver.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Board solver for 2D boards and 3D boxes.
+ */
+
+#include "./solver.h"
+
+#include <QDebug>
+#include <QSet>
+#include <QtAlgorithms>
+
+#include "./lattice.h"
+
+Solver::Solver(const BoardDescriptor &descriptor)
+  : m_b3D(descriptor.nLayers > 1),
+    m_bAllPiecesNeeded(!descriptor.bNotAllPiecesNeeded),
+    m_nPieces(descriptor.listBlocks.size()) {
+  if (m_b3D) {
+    m_Symmetry = descriptor.bMirroring ? Polycube::SpaceSymmetry :
+                                         Polycube::SpaceRotations;
+  } else {
+    m_Symmetry = Polycube::PlaneSymmetry;
+  }
+
+  foreach (const Voxel &v, Solver::boardCells(descriptor)) {
+    m_hashCellColumn[v] = m_listCells.size();
+    m_listCells << v;
+  }
+
+  for (int i = 0; i < m_nPieces; i++) {
+    this->addPlacements(
+          i, Polycube::fromPolygon(descriptor.listBlocks[i].polygon));
+  }
+
+  const int nCells(m_listCells.size());
+  if (m_bAllPiecesNeeded) {
+    m_Matrix = ExactCover(nCells + m_nPieces);
+  } else {
+    m_Matrix = ExactCover(nCells, m_nPieces);
+  }
+  foreach (const Placement &placement, m_listPlacements) {
+    QVector<int> listColumns;
+    listColumns.reserve(placement.listCells.size() + 1);
+    foreach (const Voxel &v, placement.listCells) {
+      listColumns << m_hashCellColumn[v];
+    }
+    m_listRowCells << listColumns;
+    listColumns << nCells + placement.nPiece;
+    m_Matrix.addRow(listColumns);
+  }
+
+  // Checkerboard and stripes (+1/-1 per cell) for parity pruning
+  QList<QVector<int> > listColourings;
+  const int nColourings(m_b3D ? 4 : 3);
+  for (int k = 0; k < nColourings; k++) {
+    QVector<int> listWeights(nCells + m_nPieces, 0);
+    for (int i = 0; i < nCells; i++) {
+      const Voxel &v = m_listCells.at(i);
+      int nColour(0);
+      switch (k) {
+        case 0:
+          nColour = v.x + v.y + v.z;
+          break;
+        case 1:
+          nColour = v.x;
+          break;
+        case 2:
+          nColour = v.y;
+          break;
+        default:
+          nColour = v.z;
+          break;
+      }
+      listWeights[i] = (nColour & 1) ? 1 : -1;
+    }
+    listColourings << listWeights;
+  }
+  m_Matrix.setColourings(listColourings, nCells);
+
+  qDebug() << "Solver:" << nCells << "cells," << m_nPieces << "pieces,"
+           << m_listPlacements.size() << "placements";
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+QVector<Voxel> Solver::boardCells(const BoardDescriptor &descriptor) {
+  // Board cells of all layers without barriers
+  QSet<Voxel> setBarriers;
+  foreach (const BoardDescriptor::Piece &barrier, descriptor.listBarriers) {
+    const QPoint key(Lattice::keyOffset(barrier.startPos.toPoint()));
+    const Voxel offset(key.x(), key.y(), 0);
+    foreach (const Voxel &v, Polycube::fromPolygon(barrier.polygon)) {
+      setBarriers << v + offset;
+    }
+  }
+  QVector<Voxel> listCells;
+  for (int z = 0; z < descriptor.listLayerPolys.size(); z++) {
+    foreach (const Voxel &v,
+             Polycube::fromPolygon(descriptor.listLayerPolys[z], z)) {
+      if (!setBarriers.contains(v)) {
+        listCells << v;
+      }
+    }
+  }
+  return listCells;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void Solver::addPlacements(const int nPiece,
+                           const QVector<Voxel> &listPiece) {
+  if (listPiece.isEmpty()) {
+    return;
+  }
+
+  QList<QVector<Voxel> > listOrient(Polycube::orientations(listPiece,
+                                                           m_Symmetry));
+  for (int o = 0; o < listOrient.size(); o++) {
+    const QVector<Voxel> &orient = listOrient.at(o);
+    // First voxel of the piece on each board cell
+    foreach (const Voxel &anchor, m_listCells) {
+      const Voxel offset(anchor - orient.first());
+      if (!m_b3D && !Lattice::isTranslation(QPoint(offset.x, offset.y))) {
+        continue;
+      }
+      Placement placement;
+      placement.nPiece = nPiece;
+      placement.nOrientation = o;
+      placement.listCells.reserve(orient.size());
+      foreach (const Voxel &v, orient) {
+        const Voxel cell(v + offset);
+        if (!m_hashCellColumn.contains(cell)) {
+          break;
+        }
+        placement.listCells << cell;
+      }
+      if (placement.listCells.size() == orient.size()) {
+        m_hashAnchorRows.insert(placement.listCells.first(),
+                                m_listPlacements.size());
+        m_hashMoveRows.insert(
+              Solver::anchorKey(nPiece, o,
+                                m_hashCellColumn.value(anchor)),
+              m_listPlacements.size());
+        m_listPlacements << placement;
+      }
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+quint64 Solver::countSolutions(const int nThreads,
+                               const QList<int> &listFixedRows) {
+  return m_Matrix.countSolutions(nThreads, listFixedRows);
+}
+
+bool Solver::findSolution(QList<Placement> *pListSolution) {
+  QList<int> listRows;
+  pListSolution->clear();
+  if (!m_Matrix.findSolution(&listRows)) {
+    return false;
+  }
+  foreach (int nRow, listRows) {
+    pListSolution->append(m_listPlacements.at(nRow));
+  }
+  return true;
+}
+
+bool Solver::findSolutionRows(const QList<int> &listFixedRows,
+                              QList<int> *pListRows) {
+  return m_Matrix.findSolution(pListRows, listFixedRows);
+}
+
+quint64 Solver::collectSolutions(QVector<int> *pListRows,
+                                 const quint64 nLimit) {
+  return m_Matrix.collectSolutions(pListRows, nLimit);
+}
+
+void Solver::setTableSize(const int nMegabytes) {
+  m_Matrix.setTableSize(nMegabytes);
+}
+
+void Solver::setTable(const QSharedPointer<TranspositionTable> &pTable) {
+  m_Matrix.setTable(pTable);
+}
+
+void Solver::setParityPruning(const bool bEnabled) {
+  m_Matrix.setParityPruning(bEnabled);
+}
+
+bool Solver::buildZdd(Zdd *pZdd, const int nMaxNodes) {
+  // Variables of the diagram are the placement rows. Cells are taken
+  // column by column along the longest side, which keeps the number of
+  // distinct subproblems small (see ProfileCounter).
+  if (m_listCells.isEmpty()) {
+    return m_Matrix.buildZdd(pZdd, QList<int>(), nMaxNodes);
+  }
+  Voxel min(m_listCells.first());
+  Voxel max(min);
+  foreach (const Voxel &v, m_listCells) {
+    min = Voxel(qMin(min.x, v.x), qMin(min.y, v.y), qMin(min.z, v.z));
+    max = Voxel(qMax(max.x, v.x), qMax(max.y, v.y), qMax(max.z, v.z));
+  }
+  const Voxel size(max - min + Voxel(1, 1, 1));
+
+  QList<QPair<qint64, int> > listSorted;
+  for (int i = 0; i < m_listCells.size(); i++) {
+    const Voxel v(m_listCells.at(i) - min);
+    qint64 nKey(0);
+    if (size.x >= size.y) {  // Longer side most significant, layers least
+      nKey = (qint64(v.x) * size.y + v.y) * size.z + v.z;
+    } else {
+      nKey = (qint64(v.y) * size.x + v.x) * size.z + v.z;
+    }
+    listSorted << qMakePair(nKey, i);
+  }
+  qSort(listSorted);
+
+  QList<int> listColumns;
+  for (int i = 0; i < listSorted.size(); i++) {
+    listColumns << listSorted.at(i).second;
+  }
+  return m_Matrix.buildZdd(pZdd, listColumns, nMaxNodes);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+int Solver::findPlacement(const int nPiece, QVector<Voxel> listCells) const {
+  // Cells of a placement are sorted, the smallest one is the anchor
+  if (listCells.isEmpty()) {
+    return -1;
+  }
+  qSort(listCells);
+  foreach (int nRow, m_hashAnchorRows.values(listCells.first())) {
+    const Placement &placement = m_listPlacements.at(nRow);
+    if (placement.nPiece == nPiece && placement.listCells == listCells) {
+      return nRow;
+    }
+  }
+  return -1;
+}
+
+// Row of a piece orientation with its first cell on a board cell (index),
+// -1 if it doesn't fit
+int Solver::findAnchorRow(const int nPiece, const int nOrientation,
+                          const int nCell) const {
+  if (nPiece < 0 || nPiece >= m_nPieces || nOrientation < 0 ||
+      nOrientation > 0xFF || nCell < 0 || nCell >= m_listCells.size()) {
+    return -1;
+  }
+  return m_hashMoveRows.value(
+        Solver::anchorKey(nPiece, nOrientation, nCell), -1);
+}
+
+// Distinct for all pieces (< 2^24), orientations (<= 48) and cells
+quint64 Solver::anchorKey(const int nPiece, const int nOrientation,
+                          const int nCell) {
+  return (quint64(nPiece) << 40) | (quint64(nOrientation) << 32) |
+      quint64(quint32(nCell));
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+quint64 Solver::getNodes() const {
+  return m_Matrix.getNodes();
+}
+
+const QVector<Voxel> &Solver::getCells() const {
+  return m_listCells;
+}
+
+int Solver::getCellIndex(const Voxel &cell) const {
+  return m_hashCellColumn.value(cell, -1);
+}
+
+const QVector<int> &Solver::getRowCells(const int nRow) const {
+  return m_listRowCells.at(nRow);
+}
+
+const QList<Solver::Placement> &Solver::getPlacements() const {
+  return m_listPlacements;
+}
+
+int Solver::getNumOfPieces() const {
+  return m_nPieces;
+}
+
+bool Solver::is3D() const {
+  return m_b3D;
+}
+
+bool Solver::isAllPiecesNeeded() const {
+  return m_bAllPiecesNeeded;
+}
@@ -0,0 +1,101 @@
+/**
+ * \file solver.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the board solver.
+ */
+
+#ifndef SOLVER_H_
+#define SOLVER_H_
+
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+#include "./boarddescriptor.h"
+#include "./exactcover.h"
+#include "./polycube.h"
+#include "./zdd.h"
+
+/**
+ * \class Solver
+ * \brief Solves 2D boards and 3D boxes as exact cover problem.
+ *
+ * Columns are the board cells followed by one column per piece, rows are
+ * all possible placements of a piece. If not all pieces are needed, the
+ * piece columns are secondary. Checkerboard and stripe colourings of
+ * the cells can prune the search by parity (setParityPruning(), see
+ * ExactCover).
+ */
+class Solver {
+ public:
+    struct Placement {
+      int nPiece;
+      int nOrientation;
+      QVector<Voxel> listCells;  // Absolute board cells
+    };
+
+    explicit Solver(const BoardDescriptor &descriptor);
+
+    quint64 countSolutions(const int nThreads = 0,
+                           const QList<int> &listFixedRows = QList<int>());
+    bool findSolution(QList<Placement> *pListSolution);
+    bool findSolutionRows(const QList<int> &listFixedRows,
+                          QList<int> *pListRows);
+    quint64 collectSolutions(QVector<int> *pListRows, const quint64 nLimit);
+    bool buildZdd(Zdd *pZdd, const int nMaxNodes = 1 << 22);
+    void setTableSize(const int nMegabytes);
+    void setTable(const QSharedPointer<TranspositionTable> &pTable);
+    void setParityPruning(const bool bEnabled);
+    int findPlacement(const int nPiece, QVector<Voxel> listCells) const;
+    int findAnchorRow(const int nPiece, const int nOrientation,
+                      const int nCell) const;
+    quint64 getNodes() const;
+    const QVector<Voxel> &getCells() const;
+    int getCellIndex(const Voxel &cell) const;
+    const QVector<int> &getRowCells(const int nRow) const;
+    const QList<Placement> &getPlacements() const;
+    int getNumOfPieces() const;
+    bool is3D() const;
+    bool isAllPiecesNeeded() const;
+
+    static QVector<Voxel> boardCells(const BoardDescriptor &descriptor);
+
+ private:
+    void addPlacements(const int nPiece, const QVector<Voxel> &listPiece);
+    static quint64 anchorKey(const int nPiece, const int nOrientation,
+                             const int nCell);
+
+    const bool m_b3D;
+    const bool m_bAllPiecesNeeded;
+    QVector<Voxel> m_listCells;
+    QHash<Voxel, int> m_hashCellColumn;
+    QMultiHash<Voxel, int> m_hashAnchorRows;  // Smallest cell -> rows
+    QHash<quint64, int> m_hashMoveRows;  // Piece, orientation, anchor -> row
+    int m_nPieces;
+    QList<Placement> m_listPlacements;  // Index = exact cover row
+    QVector<QVector<int> > m_listRowCells;  // Cell indices of each row
+    Polycube::Symmetry m_Symmetry;
+    ExactCover m_Matrix;
+};
+
+#endif  // SOLVER_H_
@@ -0,0 +1,562 @@
+/**
+ * \file solvercache.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Solutions of a board, enumerated once and memory mapped from a file.
+ */
+
+#include "./solvercache.h"
+
+#include <string.h>
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+
+#include "./lattice.h"
+
+static const quint32 CACHE_VERSION = 3;
+static const quint64 MAX_CACHED_SOLUTIONS = 250000;
+static const int MAX_ZDD_NODES = 1 << 20;
+static const quint32 TOO_MANY_SOLUTIONS = 0xFFFFFFFF;
+static const quint16 NO_ROW = 0xFFFF;  // Piece not used in solution
+
+// One transposition table for the direct search of all boards
+static QMutex searchTableMutex;
+static QSharedPointer<TranspositionTable> sharedSearchTable;
+static int nSearchTableSize(64);  // MB
+
+SolverCache::SolverCache(const QString &sBoardFile,
+                         const QString &sCacheDir)
+  : m_pSolver(NULL),
+    m_pSolutions(NULL),
+    m_pRowFreq(NULL),
+    m_pCellFreq(NULL),
+    m_nSolutions(TOO_MANY_SOLUTIONS),
+    m_nPieces(0),
+    m_nCells(0) {
+  BoardDescriptor descriptor(BoardDescriptor::load(sBoardFile));
+  if (descriptor.boardPoly.isEmpty() ||
+      !descriptor.sInvalidPolygon.isEmpty() || descriptor.bFreestyle ||
+      descriptor.sLattice != Lattice::name()) {
+    qWarning() << "Board can't be solved:" << sBoardFile;
+    return;
+  }
+
+  m_pSolver = new Solver(descriptor);
+  m_nPieces = m_pSolver->getNumOfPieces();
+  m_nCells = m_pSolver->getCells().size();
+
+  const QString sCacheFile(sCacheDir + "/" +
+                           SolverCache::cacheFileName(sBoardFile));
+  if (!this->loadCache(sCacheFile)) {
+    if (this->writeCache(sCacheFile)) {
+      this->loadCache(sCacheFile);
+    }
+  }
+  if (TOO_MANY_SOLUTIONS == m_nSolutions && m_CacheFile.isOpen()) {
+    this->loadZdd(SolverCache::zddFileName(sCacheFile));
+  }
+  if (NULL == m_pSolutions && m_listZddFreq.isEmpty()) {
+    // Direct search: counts of subproblems are reused by the next queries,
+    // which differ by one piece only
+    m_pSolver->setTable(SolverCache::searchTable());
+  }
+}
+
+SolverCache::~SolverCache() {
+  if (NULL != m_pSolver) {
+    delete m_pSolver;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void SolverCache::setSearchTableSize(const int nMegabytes) {
+  // Used by caches created afterwards, 0 = no table
+  QMutexLocker locker(&searchTableMutex);
+  nSearchTableSize = nMegabytes;
+  sharedSearchTable.clear();
+}
+
+QSharedPointer<TranspositionTable> SolverCache::searchTable() {
+  QMutexLocker locker(&searchTableMutex);
+  if (sharedSearchTable.isNull() && nSearchTableSize > 0) {
+    sharedSearchTable = QSharedPointer<TranspositionTable>(
+                          new TranspositionTable(nSearchTableSize));
+  }
+  return sharedSearchTable;
+}
+
+// ---------------------------------------------------------------------------
+
+QString SolverCache::defaultCacheDir() {
+  const QString sDir(QStandardPaths::writableLocation(
+                       QStandardPaths::CacheLocation) + "/solutions");
+  QDir().mkpath(sDir);
+  return sDir;
+}
+
+QString SolverCache::cacheFileName(const QString &sBoardFile) {
+  // Changed board files get a new cache file
+  QCryptographicHash hash(QCryptographicHash::Md5);
+  QFile file(sBoardFile);
+  if (file.open(QIODevice::ReadOnly)) {
+    hash.addData(file.readAll());
+  }
+  hash.addData(QByteArray(Lattice::name()));
+  return QFileInfo(sBoardFile).baseName() + "_" +
+      QString(hash.result().toHex().left(16)) + ".sol";
+}
+
+QString SolverCache::zddFileName(const QString &sCacheFile) {
+  const QFileInfo fi(sCacheFile);
+  return fi.path() + "/" + fi.completeBaseName() + ".zdd";
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+qint64 SolverCache::rowFreqOffset(const Header &header) {
+  // Solutions, then frequencies aligned to 4 bytes
+  const qint64 nEnd(sizeof(Header) + qint64(header.nSolutions) *
+                    header.nPieces * sizeof(quint16));
+  return (nEnd + 3) & ~qint64(3);
+}
+
+// ---------------------------------------------------------------------------
+
+bool SolverCache::loadCache(const QString &sCacheFile) {
+  m_CacheFile.setFileName(sCacheFile);
+  if (!m_CacheFile.open(QIODevice::ReadOnly) ||
+      m_CacheFile.size() < qint64(sizeof(Header))) {
+    m_CacheFile.close();
+    return false;
+  }
+
+  const uchar *pData = m_CacheFile.map(0, m_CacheFile.size());
+  if (NULL == pData) {
+    qWarning() << "Couldn't map solution cache:" << sCacheFile;
+    m_CacheFile.close();
+    return false;
+  }
+  const Header *pHeader = reinterpret_cast<const Header *>(pData);
+  qint64 nExpected(sizeof(Header));
+  if (TOO_MANY_SOLUTIONS != pHeader->nSolutions) {
+    nExpected = SolverCache::rowFreqOffset(*pHeader) +
+                (qint64(pHeader->nRows) +
+                 qint64(pHeader->nCells) * pHeader->nPieces) *
+                sizeof(quint32);
+  }
+  if (0 != qstrncmp(pHeader->cMagic, "IQSC", 4) ||
+      CACHE_VERSION != pHeader->nVersion ||
+      quint32(m_nPieces) != pHeader->nPieces ||
+      quint32(m_pSolver->getPlacements().size()) != pHeader->nRows ||
+      quint32(m_nCells) != pHeader->nCells ||
+      m_CacheFile.size() != nExpected) {
+    qWarning() << "Outdated solution cache:" << sCacheFile;
+    m_CacheFile.close();  // Unmaps as well
+    return false;
+  }
+
+  m_nSolutions = pHeader->nSolutions;
+  if (TOO_MANY_SOLUTIONS != m_nSolutions) {
+    m_pSolutions = reinterpret_cast<const quint16 *>(pData + sizeof(Header));
+    m_pRowFreq = reinterpret_cast<const quint32 *>(
+                   pData + SolverCache::rowFreqOffset(*pHeader));
+    m_pCellFreq = m_pRowFreq + pHeader->nRows;
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool SolverCache::writeCache(const QString &sCacheFile) {
+  const QList<Solver::Placement> &listPlacements =
+      m_pSolver->getPlacements();
+  if (listPlacements.size() >= NO_ROW) {
+    return false;  // Row indices don't fit, search directly
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+  QVector<int> listRows;
+  const quint64 nFound(m_pSolver->collectSolutions(&listRows,
+                                                   MAX_CACHED_SOLUTIONS));
+
+  Header header;
+  memcpy(header.cMagic, "IQSC", 4);
+  header.nVersion = CACHE_VERSION;
+  header.nPieces = m_nPieces;
+  header.nRows = listPlacements.size();
+  header.nCells = m_nCells;
+  header.nSolutions = (nFound > MAX_CACHED_SOLUTIONS) ? TOO_MANY_SOLUTIONS :
+                                                         quint32(nFound);
+  if (TOO_MANY_SOLUTIONS == header.nSolutions) {
+    this->writeZdd(SolverCache::zddFileName(sCacheFile));
+  }
+
+  QVector<quint16> listData;
+  QVector<quint32> listRowFreq;
+  QVector<quint32> listCellFreq;
+  if (TOO_MANY_SOLUTIONS != header.nSolutions) {
+    listData.fill(NO_ROW, int(nFound) * m_nPieces);
+    listRowFreq.fill(0, listPlacements.size());
+    listCellFreq.fill(0, m_nCells * m_nPieces);
+    int nSolution(0);
+    foreach (int nRow, listRows) {
+      if (nRow < 0) {
+        nSolution++;
+        continue;
+      }
+      const Solver::Placement &placement = listPlacements.at(nRow);
+      listData[nSolution * m_nPieces + placement.nPiece] = quint16(nRow);
+      listRowFreq[nRow]++;
+      foreach (const Voxel &v, placement.listCells) {
+        listCellFreq[m_pSolver->getCellIndex(v) * m_nPieces +
+            placement.nPiece]++;
+      }
+    }
+  }
+
+  // Written atomically, other instances might read the cache meanwhile
+  QSaveFile file(sCacheFile);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qWarning() << "Couldn't write solution cache:" << sCacheFile;
+    return false;
+  }
+  file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+  if (TOO_MANY_SOLUTIONS != header.nSolutions) {
+    file.write(reinterpret_cast<const char *>(listData.constData()),
+               listData.size() * sizeof(quint16));
+    file.write(QByteArray(SolverCache::rowFreqOffset(header) - file.pos(),
+                          '\0'));
+    file.write(reinterpret_cast<const char *>(listRowFreq.constData()),
+               listRowFreq.size() * sizeof(quint32));
+    file.write(reinterpret_cast<const char *>(listCellFreq.constData()),
+               listCellFreq.size() * sizeof(quint32));
+  }
+  if (!file.commit()) {
+    qWarning() << "Couldn't write solution cache:" << sCacheFile;
+    return false;
+  }
+
+  qDebug() << "Solution cache:" << sCacheFile << nFound << "solutions,"
+           << timer.elapsed() << "ms";
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool SolverCache::writeZdd(const QString &sZddFile) {
+  QElapsedTimer timer;
+  timer.start();
+  Zdd zdd;
+  if (!m_pSolver->buildZdd(&zdd, MAX_ZDD_NODES)) {
+    qDebug() << "Solution diagram too large, solving directly";
+    QFile::remove(sZddFile);
+    return false;
+  }
+
+  QSaveFile file(sZddFile);
+  if (!file.open(QIODevice::WriteOnly) ||
+      -1 == file.write(zdd.serialize()) || !file.commit()) {
+    qWarning() << "Couldn't write solution diagram:" << sZddFile;
+    return false;
+  }
+  qDebug() << "Solution diagram:" << sZddFile << zdd.count() << "solutions,"
+           << zdd.getNumOfNodes() << "nodes," << timer.elapsed() << "ms";
+  return true;
+}
+
+bool SolverCache::loadZdd(const QString &sZddFile) {
+  QFile file(sZddFile);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+  Zdd zdd;
+  if (!zdd.deserialize(file.readAll())) {
+    qWarning() << "Invalid solution diagram:" << sZddFile;
+    return false;
+  }
+  // Variables are the placement rows of the solver
+  const QVector<quint64> listFreq(zdd.frequencies());
+  if (listFreq.size() != m_pSolver->getPlacements().size()) {
+    qWarning() << "Outdated solution diagram:" << sZddFile;
+    return false;
+  }
+  m_Zdd = zdd;
+  m_listZddFreq = listFreq;
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool SolverCache::placedRows(const QList<Solver::Placement> &listPlaced,
+                             QList<int> *pListRows) const {
+  // Pieces which are not completely on the board are ignored
+  QSet<int> setPieces;
+  pListRows->clear();
+  foreach (const Solver::Placement &placement, listPlaced) {
+    if (placement.nPiece < 0 || placement.nPiece >= m_nPieces ||
+        setPieces.contains(placement.nPiece)) {
+      return false;
+    }
+    setPieces << placement.nPiece;
+    const int nRow(m_pSolver->findPlacement(placement.nPiece,
+                                            placement.listCells));
+    if (nRow >= 0) {
+      pListRows->append(nRow);
+    }
+  }
+  return true;
+}
+
+bool SolverCache::matches(const quint16 *pSolution,
+                          const QList<int> &listRows) const {
+  const QList<Solver::Placement> &listPlacements =
+      m_pSolver->getPlacements();
+  foreach (int nRow, listRows) {
+    if (pSolution[listPlacements.at(nRow).nPiece] != nRow) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+SolverCache::Result SolverCache::hint(
+    const QList<Solver::Placement> &listPlaced, Solver::Placement *pHint) {
+  pHint->nPiece = -1;  // Nothing left to place
+  pHint->listCells.clear();
+  if (!this->isValid()) {
+    return InvalidBoard;
+  }
+  QList<int> listRows;
+  if (!this->placedRows(listPlaced, &listRows)) {
+    return InvalidState;
+  }
+
+  const QList<Solver::Placement> &listPlacements =
+      m_pSolver->getPlacements();
+  QList<int> listSolution;
+  if (NULL != m_pSolutions) {
+    for (quint32 s = 0; s < m_nSolutions; s++) {
+      const quint16 *pSolution = m_pSolutions + s * m_nPieces;
+      if (this->matches(pSolution, listRows)) {
+        for (int p = 0; p < m_nPieces; p++) {
+          if (NO_ROW != pSolution[p]) {
+            listSolution << pSolution[p];
+          }
+        }
+        break;
+      }
+    }
+  } else if (!m_listZddFreq.isEmpty()) {
+    m_Zdd.findWith(listRows, &listSolution);
+  } else if (!m_pSolver->findSolutionRows(listRows, &listSolution)) {
+    listSolution.clear();
+  }
+  if (listSolution.isEmpty()) {
+    return NoSolution;
+  }
+
+  // Placement which occurs in most of all solutions is the safest move
+  int nHintRow(-1);
+  foreach (int nRow, listSolution) {
+    if (!listRows.contains(nRow) &&
+        (nHintRow < 0 ||
+         this->rowFrequency(nRow) > this->rowFrequency(nHintRow))) {
+      nHintRow = nRow;
+    }
+  }
+  if (nHintRow >= 0) {
+    *pHint = listPlacements.at(nHintRow);
+  }
+  return Found;
+}
+
+// ---------------------------------------------------------------------------
+
+SolverCache::Result SolverCache::cellHint(
+    const QList<Solver::Placement> &listPlaced, Voxel *pCell, int *pPiece,
+    quint32 *pFrequency, quint32 *pSolutions) const {
+  *pPiece = -1;  // All cells covered
+  *pFrequency = 0;
+  *pSolutions = 0;
+  if (!this->isValid()) {
+    return InvalidBoard;
+  }
+  if (NULL == m_pCellFreq) {
+    return NotCached;
+  }
+  QList<int> listRows;
+  if (!this->placedRows(listPlaced, &listRows)) {
+    return InvalidState;
+  }
+
+  // listPlaced contains all pieces: only the ones matching a placement are
+  // placed, cells are covered by any piece lying on them
+  QVector<bool> bCovered(m_nCells, false);
+  QVector<bool> bPlaced(m_nPieces, false);
+  foreach (int nRow, listRows) {
+    bPlaced[m_pSolver->getPlacements().at(nRow).nPiece] = true;
+  }
+  foreach (const Solver::Placement &placement, listPlaced) {
+    foreach (const Voxel &v, placement.listCells) {
+      const int nCell(m_pSolver->getCellIndex(v));
+      if (nCell >= 0) {
+        bCovered[nCell] = true;
+      }
+    }
+  }
+
+  // Stored map counts all solutions, with placed pieces only the ones
+  // containing them are counted
+  QVector<quint32> listFreq;
+  if (listRows.isEmpty()) {
+    *pSolutions = m_nSolutions;
+  } else {
+    listFreq.fill(0, m_nCells * m_nPieces);
+    for (quint32 s = 0; s < m_nSolutions; s++) {
+      const quint16 *pSolution = m_pSolutions + s * m_nPieces;
+      if (!this->matches(pSolution, listRows)) {
+        continue;
+      }
+      (*pSolutions)++;
+      for (int p = 0; p < m_nPieces; p++) {
+        if (NO_ROW != pSolution[p] && !bPlaced.at(p)) {
+          foreach (int nCell, m_pSolver->getRowCells(pSolution[p])) {
+            listFreq[nCell * m_nPieces + p]++;
+          }
+        }
+      }
+    }
+  }
+  if (0 == *pSolutions) {
+    return NoSolution;
+  }
+
+  // Free cell, which is covered by the same piece in most solutions
+  for (int c = 0; c < m_nCells; c++) {
+    if (bCovered.at(c)) {
+      continue;
+    }
+    for (int p = 0; p < m_nPieces; p++) {
+      if (bPlaced.at(p)) {
+        continue;
+      }
+      const quint32 nFrequency(listFreq.isEmpty() ?
+                                 this->cellFrequency(c, p) :
+                                 listFreq.at(c * m_nPieces + p));
+      if (nFrequency > *pFrequency) {
+        *pFrequency = nFrequency;
+        *pPiece = p;
+        *pCell = m_pSolver->getCells().at(c);
+      }
+    }
+  }
+  return Found;
+}
+
+quint32 SolverCache::cellFrequency(const int nCell, const int nPiece) const {
+  return m_pCellFreq[nCell * m_nPieces + nPiece];
+}
+
+quint64 SolverCache::rowFrequency(const int nRow) const {
+  if (NULL != m_pRowFreq) {
+    return m_pRowFreq[nRow];
+  }
+  return m_listZddFreq.isEmpty() ? 0 : m_listZddFreq.at(nRow);
+}
+
+// ---------------------------------------------------------------------------
+
+qreal SolverCache::constraint() const {
+  // Average share of the most frequent piece per cell: 1 = unique solution
+  if (NULL == m_pCellFreq || 0 == m_nSolutions || 0 == m_nCells) {
+    return -1;
+  }
+  quint64 nSum(0);
+  for (int c = 0; c < m_nCells; c++) {
+    quint32 nMax(0);
+    for (int p = 0; p < m_nPieces; p++) {
+      nMax = qMax(nMax, this->cellFrequency(c, p));
+    }
+    nSum += nMax;
+  }
+  return qreal(nSum) / m_nCells / m_nSolutions;
+}
+
+// ---------------------------------------------------------------------------
+
+SolverCache::Result SolverCache::count(
+    const QList<Solver::Placement> &listPlaced, quint64 *pCount) {
+  *pCount = 0;
+  if (!this->isValid()) {
+    return InvalidBoard;
+  }
+  QList<int> listRows;
+  if (!this->placedRows(listPlaced, &listRows)) {
+    return InvalidState;
+  }
+
+  if (NULL != m_pSolutions) {
+    for (quint32 s = 0; s < m_nSolutions; s++) {
+      if (this->matches(m_pSolutions + s * m_nPieces, listRows)) {
+        (*pCount)++;
+      }
+    }
+  } else if (!m_listZddFreq.isEmpty()) {
+    *pCount = m_Zdd.countWith(listRows);
+  } else {
+    *pCount = m_pSolver->countSolutions(0, listRows);
+  }
+  return (*pCount > 0) ? Found : NoSolution;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool SolverCache::isValid() const {
+  return NULL != m_pSolver;
+}
+
+bool SolverCache::isCached() const {
+  return NULL != m_pSolutions;
+}
+
+quint32 SolverCache::getNumOfSolutions() const {
+  return m_nSolutions;
+}
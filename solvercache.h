@@ -0,0 +1,127 @@
+/**
+ * \file solvercache.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the cached solutions of a board.
+ */
+
+#ifndef SOLVERCACHE_H_
+#define SOLVERCACHE_H_
+
+#include <QFile>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+#include "./solver.h"
+#include "./zdd.h"
+
+/**
+ * \class SolverCache
+ * \brief Solver of one board with all its solutions in a cache file.
+ *
+ * On first use all solutions are enumerated and written to the cache
+ * directory (one row index per piece and solution). The file is memory
+ * mapped afterwards, so several processes share the same pages and a
+ * query only scans the solutions. Boards with too many solutions are
+ * searched directly with the placed pieces as fixed rows.
+ *
+ * The file contains as well how often each placement (piece, orientation
+ * and position) and each piece on each cell occurs in all solutions.
+ * These frequency maps give graded hints by a single lookup; once pieces
+ * are placed, cell hints count the solutions containing them instead.
+ *
+ * For boards with too many solutions a ZDD (see Zdd) of all solutions is
+ * stored next to the cache file instead, if it isn't too large. Hints and
+ * counts query the diagram without any search. Otherwise the board is
+ * searched directly; the transposition table of all these boards is
+ * shared and its size set by setSearchTableSize().
+ */
+class SolverCache {
+ public:
+    enum Result {
+      Found,
+      NoSolution,
+      InvalidState,
+      InvalidBoard,
+      NotCached
+    };
+
+    SolverCache(const QString &sBoardFile, const QString &sCacheDir);
+    ~SolverCache();
+
+    bool isValid() const;
+    Result hint(const QList<Solver::Placement> &listPlaced,
+                Solver::Placement *pHint);
+    Result count(const QList<Solver::Placement> &listPlaced,
+                 quint64 *pCount);
+    Result cellHint(const QList<Solver::Placement> &listPlaced,
+                    Voxel *pCell, int *pPiece, quint32 *pFrequency,
+                    quint32 *pSolutions) const;
+    bool isCached() const;
+    quint32 getNumOfSolutions() const;
+    qreal constraint() const;
+
+    static void setSearchTableSize(const int nMegabytes);
+    static QString defaultCacheDir();
+    static QString cacheFileName(const QString &sBoardFile);
+
+ private:
+    Q_DISABLE_COPY(SolverCache)
+
+    struct Header {
+      char cMagic[4];
+      quint32 nVersion;
+      quint32 nPieces;
+      quint32 nRows;
+      quint32 nCells;
+      quint32 nSolutions;
+    };
+
+    bool loadCache(const QString &sCacheFile);
+    bool writeCache(const QString &sCacheFile);
+    bool loadZdd(const QString &sZddFile);
+    bool writeZdd(const QString &sZddFile);
+    bool placedRows(const QList<Solver::Placement> &listPlaced,
+                    QList<int> *pListRows) const;
+    bool matches(const quint16 *pSolution,
+                 const QList<int> &listRows) const;
+    quint32 cellFrequency(const int nCell, const int nPiece) const;
+    quint64 rowFrequency(const int nRow) const;
+    static QSharedPointer<TranspositionTable> searchTable();
+    static qint64 rowFreqOffset(const Header &header);
+    static QString zddFileName(const QString &sCacheFile);
+
+    Solver *m_pSolver;
+    QFile m_CacheFile;
+    const quint16 *m_pSolutions;  // Mapped, nPieces entries per solution
+    const quint32 *m_pRowFreq;  // Mapped, per placement row
+    const quint32 *m_pCellFreq;  // Mapped, nPieces entries per cell
+    Zdd m_Zdd;  // Only if too many solutions
+    QVector<quint64> m_listZddFreq;  // Per placement row
+    quint32 m_nSolutions;
+    int m_nPieces;
+    int m_nCells;
+};
+
+#endif  // SOLVERCACHE_H_
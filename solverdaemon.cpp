@@ -0,0 +1,383 @@
+/**
+ * \file solverdaemon.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Local solver service and its client side.
+ */
+
+#include "./solverdaemon.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFileInfo>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QMutex>
+#include <QScopedPointer>
+#include <QtConcurrentRun>
+
+#include "./protocol.h"
+
+const char *SolverDaemon::SERVER_NAME = "iqpuzzle-solver";
+const quint8 SolverDaemon::PROTOCOL_VERSION = 1;
+
+SolverDaemon::Reply::Reply()
+  : result(SolverCache::InvalidState),
+    nCount(0),
+    nSolutions(0),
+    bFromDaemon(false) {
+  hint.nPiece = -1;
+  hint.nOrientation = 0;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+SolverDaemon::SolverDaemon(const QString &sCacheDir, const int nMaxBoards,
+                           QObject *pParent)
+  : QObject(pParent),
+    m_pServer(new QLocalServer(this)),
+    m_sCacheDir(sCacheDir),
+    m_nMaxBoards(qMax(nMaxBoards, 1)) {
+  connect(m_pServer, SIGNAL(newConnection()),
+          this, SLOT(newConnection()));
+}
+
+SolverDaemon::~SolverDaemon() {
+  m_Pool.waitForDone();
+}
+
+SolverDaemon::CacheEntry::CacheEntry()
+  : pCache(NULL) {
+}
+
+SolverDaemon::CacheEntry::~CacheEntry() {
+  delete pCache;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool SolverDaemon::listen() {
+  // Game instances of the same user share the daemon, other users can't
+  // make it read their files
+  m_pServer->setSocketOptions(QLocalServer::UserAccessOption);
+  if (!m_pServer->listen(SolverDaemon::serverName())) {
+    QLocalSocket probe;
+    probe.connectToServer(SolverDaemon::serverName());
+    if (probe.waitForConnected(100)) {
+      qWarning() << "Solver daemon is already running.";
+      return false;
+    }
+    // Socket file left by a crashed daemon
+    QLocalServer::removeServer(SolverDaemon::serverName());
+    if (!m_pServer->listen(SolverDaemon::serverName())) {
+      qWarning() << "Couldn't start solver daemon:"
+                 << m_pServer->errorString();
+      return false;
+    }
+  }
+
+  qDebug() << "Solver daemon listening on" << m_pServer->fullServerName()
+           << "- cache:" << m_sCacheDir;
+  return true;
+}
+
+QString SolverDaemon::serverName() {
+  QString sUser(QString::fromLocal8Bit(qgetenv("USER")));
+  if (sUser.isEmpty()) {
+    sUser = QString::fromLocal8Bit(qgetenv("USERNAME"));
+  }
+  return QString(SERVER_NAME) + "-" + sUser;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void SolverDaemon::newConnection() {
+  while (m_pServer->hasPendingConnections()) {
+    QLocalSocket *pSocket = m_pServer->nextPendingConnection();
+    m_hashBuffers[pSocket] = QByteArray();
+    connect(pSocket, SIGNAL(readyRead()),
+            this, SLOT(readRequest()));
+    connect(pSocket, SIGNAL(disconnected()),
+            this, SLOT(removeConnection()));
+  }
+}
+
+void SolverDaemon::removeConnection() {
+  QLocalSocket *pSocket = qobject_cast<QLocalSocket *>(this->sender());
+  if (NULL != pSocket) {
+    // A running request finishes, its reply is dropped
+    m_hashBuffers.remove(pSocket);
+    m_setBusy.remove(pSocket);
+    pSocket->deleteLater();
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void SolverDaemon::readRequest() {
+  QLocalSocket *pSocket = qobject_cast<QLocalSocket *>(this->sender());
+  if (NULL == pSocket) {
+    return;
+  }
+
+  QByteArray &buffer = m_hashBuffers[pSocket];
+  buffer += pSocket->readAll();
+  if (nextMessageSize(buffer) > MAX_MESSAGE_SIZE) {
+    qWarning() << "Solver daemon: invalid request size.";
+    buffer.clear();
+    pSocket->disconnectFromServer();
+    return;
+  }
+
+  this->startNextRequest(pSocket);
+}
+
+// ---------------------------------------------------------------------------
+
+void SolverDaemon::startNextRequest(QLocalSocket *pSocket) {
+  // One request per client at a time, replies keep the order
+  QByteArray request;
+  if (m_setBusy.contains(pSocket) ||
+      !takeMessage(&m_hashBuffers[pSocket], &request)) {
+    return;
+  }
+  m_setBusy << pSocket;
+  QFutureWatcher<QByteArray> *pWatcher = new QFutureWatcher<QByteArray>(this);
+  m_hashJobs[pWatcher] = pSocket;
+  connect(pWatcher, SIGNAL(finished()),
+          this, SLOT(sendReply()));
+  pWatcher->setFuture(QtConcurrent::run(&m_Pool, this,
+                                        &SolverDaemon::processRequest,
+                                        request));
+}
+
+void SolverDaemon::sendReply() {
+  QFutureWatcher<QByteArray> *pWatcher =
+      static_cast<QFutureWatcher<QByteArray> *>(this->sender());
+  QPointer<QLocalSocket> pSocket(m_hashJobs.take(pWatcher));
+  pWatcher->deleteLater();
+  if (pSocket.isNull() || !m_hashBuffers.contains(pSocket.data())) {
+    return;  // Client is gone
+  }
+  pSocket->write(frameMessage(pWatcher->result()));
+  m_setBusy.remove(pSocket.data());
+  this->startNextRequest(pSocket.data());
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// Runs on the thread pool
+QByteArray SolverDaemon::processRequest(const QByteArray &request) {
+  QDataStream in(request);
+  quint8 nVersion(0);
+  quint8 nCommand(0);
+  QByteArray baBoardFile;
+  quint8 nPlaced(0);
+  in >> nVersion >> nCommand >> baBoardFile >> nPlaced;
+
+  QList<Solver::Placement> listPlaced;
+  Solver::Placement placement;
+  for (int i = 0; i < nPlaced && QDataStream::Ok == in.status(); i++) {
+    if (readPlacement(&in, &placement)) {
+      listPlaced << placement;
+    }
+  }
+
+  Reply reply;
+  if (PROTOCOL_VERSION == nVersion && QDataStream::Ok == in.status()) {
+    QSharedPointer<CacheEntry> pEntry(
+          this->getCache(QString::fromUtf8(baBoardFile)));
+    if (pEntry.isNull()) {
+      reply.result = SolverCache::InvalidBoard;
+    } else {
+      QMutexLocker locker(&pEntry->mutex);
+      if (NULL == pEntry->pCache) {
+        pEntry->pCache = new SolverCache(pEntry->sBoardFile, m_sCacheDir);
+      }
+      reply = SolverDaemon::solve(pEntry->pCache, nCommand, listPlaced);
+    }
+  }
+
+  QByteArray message;
+  QDataStream out(&message, QIODevice::WriteOnly);
+  out << quint8(reply.result);
+  if ((CommandHint == nCommand || CommandCellHint == nCommand) &&
+      SolverCache::Found == reply.result) {
+    writePlacement(&out, reply.hint);
+  }
+  if (CommandCount == nCommand) {
+    out << reply.nCount;
+  } else if (CommandCellHint == nCommand &&
+             SolverCache::Found == reply.result) {
+    out << quint32(reply.nCount) << reply.nSolutions;
+  }
+  return message;
+}
+
+// ---------------------------------------------------------------------------
+
+QSharedPointer<SolverDaemon::CacheEntry> SolverDaemon::getCache(
+    const QString &sBoardFile) {
+  // Links and ".." are resolved, so each board has one entry
+  const QFileInfo fi(sBoardFile);
+  if (!fi.isAbsolute() || !fi.isFile() || "conf" != fi.suffix()) {
+    return QSharedPointer<CacheEntry>();
+  }
+  const QString sCanonical(fi.canonicalFilePath());
+
+  // Least recently used board is dropped, a running query keeps it alive
+  QMutexLocker locker(&m_CacheMutex);
+  QSharedPointer<CacheEntry> pEntry(m_hashCaches.value(sCanonical));
+  if (pEntry.isNull()) {
+    pEntry = QSharedPointer<CacheEntry>(new CacheEntry);
+    pEntry->sBoardFile = sCanonical;
+    m_hashCaches[sCanonical] = pEntry;
+    while (m_hashCaches.size() > m_nMaxBoards) {
+      m_hashCaches.remove(m_listRecent.takeFirst());
+    }
+  } else {
+    m_listRecent.removeOne(sCanonical);
+  }
+  m_listRecent << sCanonical;
+  return pEntry;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+SolverDaemon::Reply SolverDaemon::solve(
+    SolverCache *pCache, const int nCommand,
+    const QList<Solver::Placement> &listPlaced) {
+  Reply reply;
+  if (NULL == pCache || !pCache->isValid()) {
+    reply.result = SolverCache::InvalidBoard;
+    return reply;
+  }
+
+  switch (nCommand) {
+    case CommandHint:
+    case CommandSolvable:
+      reply.result = pCache->hint(listPlaced, &reply.hint);
+      break;
+    case CommandCount:
+      reply.result = pCache->count(listPlaced, &reply.nCount);
+      break;
+    case CommandCellHint: {
+      Voxel cell;
+      quint32 nFrequency(0);
+      reply.result = pCache->cellHint(listPlaced, &cell, &reply.hint.nPiece,
+                                      &nFrequency, &reply.nSolutions);
+      if (reply.hint.nPiece >= 0) {
+        reply.hint.listCells << cell;
+      }
+      reply.nCount = nFrequency;
+      break;
+    }
+    default:
+      reply.result = SolverCache::InvalidState;
+      break;
+  }
+  return reply;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+SolverDaemon::Reply SolverDaemon::query(
+    const int nCommand, const QString &sBoardFile,
+    const QList<Solver::Placement> &listPlaced) {
+  const QString sAbsFile(QFileInfo(sBoardFile).canonicalFilePath());
+  QByteArray request;
+  QDataStream out(&request, QIODevice::WriteOnly);
+  out << PROTOCOL_VERSION << quint8(nCommand) << sAbsFile.toUtf8()
+      << quint8(listPlaced.size());
+  foreach (const Solver::Placement &placement, listPlaced) {
+    writePlacement(&out, placement);
+  }
+
+  Reply reply;
+  if (SolverDaemon::queryDaemon(nCommand, request, &reply)) {
+    return reply;
+  }
+
+  // No daemon running: solver of the current board in own process
+  static QMutex mutex;
+  static QScopedPointer<SolverCache> pCache;
+  static QString sCachedFile;
+  QMutexLocker locker(&mutex);
+  if (pCache.isNull() || sCachedFile != sAbsFile) {
+    pCache.reset(new SolverCache(sAbsFile, SolverCache::defaultCacheDir()));
+    sCachedFile = sAbsFile;
+  }
+  return SolverDaemon::solve(pCache.data(), nCommand, listPlaced);
+}
+
+// ---------------------------------------------------------------------------
+
+bool SolverDaemon::queryDaemon(const int nCommand, const QByteArray &request,
+                               Reply *pReply) {
+  QLocalSocket socket;
+  socket.connectToServer(SolverDaemon::serverName());
+  if (!socket.waitForConnected(100)) {
+    return false;
+  }
+  socket.write(frameMessage(request));
+  if (!socket.waitForBytesWritten(1000)) {
+    qWarning() << "Solver daemon:" << socket.errorString();
+    return false;
+  }
+
+  QByteArray buffer;
+  QByteArray message;
+  while (!takeMessage(&buffer, &message)) {
+    // First query of a board has to enumerate its solutions
+    if (!socket.waitForReadyRead(30000)) {
+      qWarning() << "Solver daemon:" << socket.errorString();
+      return false;
+    }
+    buffer += socket.readAll();
+  }
+
+  QDataStream in(message);
+  quint8 nResult(SolverCache::InvalidState);
+  in >> nResult;
+  pReply->result = SolverCache::Result(nResult);
+  if ((CommandHint == nCommand || CommandCellHint == nCommand) &&
+      SolverCache::Found == pReply->result) {
+    readPlacement(&in, &pReply->hint);
+  }
+  if (CommandCount == nCommand) {
+    in >> pReply->nCount;
+  } else if (CommandCellHint == nCommand &&
+             SolverCache::Found == pReply->result) {
+    quint32 nFrequency(0);
+    in >> nFrequency >> pReply->nSolutions;
+    pReply->nCount = nFrequency;
+  }
+  pReply->bFromDaemon = true;
+  return QDataStream::Ok == in.status();
+}
@@ -0,0 +1,137 @@
+/**
+ * \file solverdaemon.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the local solver service.
+ */
+
+#ifndef SOLVERDAEMON_H_
+#define SOLVERDAEMON_H_
+
+#include <QByteArray>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+
+#include "./solvercache.h"
+
+class QLocalServer;
+class QLocalSocket;
+
+/**
+ * \class SolverDaemon
+ * \brief Solver service shared by all game instances of a machine.
+ *
+ * Started with --daemon, it keeps the solver and the mapped solution cache
+ * of the last nMaxBoards requested boards (least recently used ones are
+ * dropped) and answers queries over a local socket, which
+ * only the own user can access. Requests are answered on a thread pool,
+ * so building the cache of a new board doesn't block other clients;
+ * queries of the same board wait for each other. Replies to one client
+ * are sent in the order of its requests.
+ * query() is the client side: it asks the daemon and falls back to a
+ * solver in the own process, if no daemon is running.
+ *
+ * Messages are framed as in protocol.h, the payload uses QDataStream.
+ * Request: quint8 version, quint8 command, QByteArray board file (UTF-8),
+ * quint8 number of placed pieces, per piece quint8 index, quint8 number
+ * of cells and the cells as qint16 x, y, z.
+ * Reply: quint8 result, for hints the piece in the same format (index
+ * 0xFF if nothing is left), for counts a quint64. Cell hints return the
+ * piece with one cell, its frequency and the number of solutions with the
+ * placed pieces (quint32).
+ */
+class SolverDaemon : public QObject {
+  Q_OBJECT
+
+ public:
+    enum Command {
+      CommandHint = 1,
+      CommandSolvable = 2,
+      CommandCount = 3,
+      CommandCellHint = 4
+    };
+
+    struct Reply {
+      Reply();
+      SolverCache::Result result;
+      Solver::Placement hint;
+      quint64 nCount;  // Solutions, or frequency of a cell hint
+      quint32 nSolutions;
+      bool bFromDaemon;
+    };
+
+    SolverDaemon(const QString &sCacheDir, const int nMaxBoards,
+                 QObject *pParent = 0);
+    ~SolverDaemon();
+
+    bool listen();
+    static Reply query(const int nCommand, const QString &sBoardFile,
+                       const QList<Solver::Placement> &listPlaced);
+
+ private slots:
+    void newConnection();
+    void readRequest();
+    void removeConnection();
+    void sendReply();
+
+ private:
+    struct CacheEntry {
+      CacheEntry();
+      ~CacheEntry();
+      QString sBoardFile;  // Canonical path
+      QMutex mutex;  // SolverCache isn't thread safe
+      SolverCache *pCache;  // Built by the first request
+    };
+
+    void startNextRequest(QLocalSocket *pSocket);
+    QByteArray processRequest(const QByteArray &request);
+    QSharedPointer<CacheEntry> getCache(const QString &sBoardFile);
+    static QString serverName();
+    static Reply solve(SolverCache *pCache, const int nCommand,
+                       const QList<Solver::Placement> &listPlaced);
+    static bool queryDaemon(const int nCommand, const QByteArray &request,
+                            Reply *pReply);
+
+    static const char *SERVER_NAME;
+    static const quint8 PROTOCOL_VERSION;
+
+    QLocalServer *m_pServer;
+    const QString m_sCacheDir;
+    QThreadPool m_Pool;
+    const int m_nMaxBoards;
+    QMutex m_CacheMutex;  // Guards m_hashCaches and m_listRecent
+    QHash<QString, QSharedPointer<CacheEntry> > m_hashCaches;
+    QStringList m_listRecent;  // Least recently used board first
+    QHash<QLocalSocket *, QByteArray> m_hashBuffers;
+    QSet<QLocalSocket *> m_setBusy;  // Request of the client is running
+    QHash<QFutureWatcher<QByteArray> *, QPointer<QLocalSocket> > m_hashJobs;
+};
+
+#endif  // SOLVERDAEMON_H_
@@ -0,0 +1,425 @@
+/**
+ * \file telemetry.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Recording of gameplay telemetry.
+ */
+
+#include "./telemetry.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLockFile>
+#include <QThread>
+#include <QTimer>
+#include <QtAlgorithms>
+
+const char Telemetry::MAGIC[4] = {'I', 'Q', 'T', 'L'};
+const quint8 Telemetry::VERSION = 2;
+const quint8 Telemetry::CHUNK_EVENTS = 2;
+const int Telemetry::FLUSH_INTERVAL = 5000;
+
+Telemetry::Telemetry(const QString &sDir, const int nKeepDays,
+                     QObject *pParent)
+  : QObject(pParent) {
+  QDir().mkpath(sDir);
+  m_pThread = new QThread(this);
+  m_pWriter = new TelemetryWriter(sDir, nKeepDays);
+  m_pWriter->moveToThread(m_pThread);
+  connect(m_pThread, SIGNAL(started()), m_pWriter, SLOT(start()));
+  connect(m_pThread, SIGNAL(finished()), m_pWriter, SLOT(deleteLater()));
+  m_pThread->start(QThread::LowPriority);
+}
+
+Telemetry::~Telemetry() {
+  // Records of the last seconds
+  QMetaObject::invokeMethod(m_pWriter, "flush",
+                            Qt::BlockingQueuedConnection);
+  m_pThread->quit();
+  m_pThread->wait();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void Telemetry::record(const QString &sBoard, const Event event,
+                       const int nPiece, const QPoint &cell,
+                       const quint32 nGameSeconds) {
+  TelemetryWriter::Pending pending;
+  pending.nMsecs = QDateTime::currentMSecsSinceEpoch();
+  pending.nGameSeconds = nGameSeconds;
+  pending.nBoard = 0;
+  pending.nX = qint16(cell.x());
+  pending.nY = qint16(cell.y());
+  pending.nEvent = quint8(event);
+  pending.nPiece = quint8(nPiece);
+  m_pWriter->append(sBoard, pending);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// Compressed and plain file of a day (late records), sorted by time
+bool Telemetry::readDay(const QString &sDir, const QDate &day,
+                        QStringList *pListBoards,
+                        QVector<Record> *pListRecords) {
+  const QString sFile(sDir + "/" + day.toString("yyyy-MM-dd") + ".iqtl");
+  // Not while a writer merges the plain file into the compressed one
+  QLockFile lock(sFile + ".lock");
+  if (!lock.tryLock(FLUSH_INTERVAL)) {
+    qWarning() << "Telemetry: could not lock" << sFile;
+    return false;
+  }
+  bool bFound(false);
+  const int nOffset(pListRecords->size());
+  foreach (const QString &sName, QStringList() << sFile + ".z" << sFile) {
+    if (QFile::exists(sName)) {
+      bFound |= Telemetry::readFile(sName, pListBoards, pListRecords);
+    }
+  }
+  qStableSort(pListRecords->begin() + nOffset, pListRecords->end(),
+              Telemetry::earlierThan);
+  return bFound;
+}
+
+// ---------------------------------------------------------------------------
+
+// Appends the records of a file, board names are added to pListBoards
+// unless already contained (one list for several files of a day)
+bool Telemetry::readFile(const QString &sFile, QStringList *pListBoards,
+                         QVector<Record> *pListRecords) {
+  QFile file(sFile);
+  if (!file.open(QIODevice::ReadOnly)) {
+    qWarning() << "Telemetry: could not open" << sFile;
+    return false;
+  }
+  QByteArray data(file.readAll());
+  file.close();
+  if (sFile.endsWith(".z")) {
+    data = qUncompress(data);
+  }
+  if (data.size() < 5 || !data.startsWith(QByteArray(MAGIC, 4)) ||
+      VERSION != quint8(data.at(4))) {
+    qWarning() << "Telemetry: invalid file" << sFile;
+    return false;
+  }
+
+  QDataStream in(data);
+  in.skipRawData(5);
+  while (!in.atEnd()) {
+    quint8 nType(0);
+    quint32 nSize(0);
+    in >> nType >> nSize;
+    const qint64 nPos(in.device()->pos());
+    if (QDataStream::Ok != in.status() || nSize > data.size() - nPos) {
+      // Last write was cut off, e.g. by a crash
+      qWarning() << "Telemetry: truncated file" << sFile;
+      break;
+    }
+    QDataStream chunk(data.mid(nPos, nSize));
+    in.skipRawData(nSize);
+
+    if (CHUNK_EVENTS == nType) {
+      quint16 nNames(0);
+      chunk >> nNames;
+      QVector<quint16> listBoards;  // Chunk board -> index in pListBoards
+      for (quint16 i = 0; i < nNames && QDataStream::Ok == chunk.status();
+           i++) {
+        QByteArray baName;
+        chunk >> baName;
+        const QString sBoard(QString::fromUtf8(baName));
+        int nIndex(NULL != pListBoards ? pListBoards->indexOf(sBoard) : i);
+        if (nIndex < 0) {
+          nIndex = pListBoards->size();
+          pListBoards->append(sBoard);
+        }
+        listBoards << quint16(nIndex);
+      }
+      quint32 nCount(0);
+      chunk >> nCount;
+      if (QDataStream::Ok != chunk.status() ||
+          nCount > nSize / sizeof(Record)) {  // Same size as in the file
+        qWarning() << "Telemetry: invalid chunk in" << sFile;
+        break;
+      }
+      if (NULL == pListRecords) {
+        continue;
+      }
+      const int nOffset(pListRecords->size());
+      pListRecords->resize(nOffset + nCount);
+      Record *pRecords = pListRecords->data() + nOffset;
+      for (quint32 i = 0; i < nCount; i++) chunk >> pRecords[i].nTime;
+      for (quint32 i = 0; i < nCount; i++) chunk >> pRecords[i].nGameSeconds;
+      for (quint32 i = 0; i < nCount; i++) chunk >> pRecords[i].nBoard;
+      for (quint32 i = 0; i < nCount; i++) chunk >> pRecords[i].nX;
+      for (quint32 i = 0; i < nCount; i++) chunk >> pRecords[i].nY;
+      for (quint32 i = 0; i < nCount; i++) chunk >> pRecords[i].nEvent;
+      for (quint32 i = 0; i < nCount; i++) chunk >> pRecords[i].nPiece;
+      for (quint32 i = 0; i < nCount; i++) {
+        pRecords[i].nBoard = listBoards.value(pRecords[i].nBoard, 0);
+      }
+    }
+    // Unknown chunks of later versions are skipped
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+
+bool Telemetry::earlierThan(const Record &r1, const Record &r2) {
+  return r1.nTime < r2.nTime;
+}
+
+// ---------------------------------------------------------------------------
+
+QString Telemetry::eventName(const int nEvent) {
+  switch (nEvent) {
+    case EventStart:
+      return "start";
+    case EventMove:
+      return "move";
+    case EventRejected:
+      return "rejected";
+    case EventRotate:
+      return "rotate";
+    case EventFlip:
+      return "flip";
+    case EventHint:
+      return "hint";
+    case EventPause:
+      return "pause";
+    case EventResume:
+      return "resume";
+    case EventSolved:
+      return "solved";
+    default:
+      return "unknown";
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+TelemetryWriter::TelemetryWriter(const QString &sDir, const int nKeepDays,
+                                 QObject *pParent)
+  : QObject(pParent),
+    m_sDir(sDir),
+    m_nKeepDays(nKeepDays),
+    m_pTimer(NULL) {
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void TelemetryWriter::append(const QString &sBoard, const Pending &pending) {
+  QMutexLocker locker(&m_mutex);
+  int nBoard(m_hashBoards.value(sBoard, -1));
+  if (nBoard < 0) {
+    nBoard = m_sListBoards.size();
+    m_sListBoards << sBoard;
+    m_hashBoards[sBoard] = nBoard;
+  }
+  m_listPending << pending;
+  m_listPending.last().nBoard = nBoard;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void TelemetryWriter::start() {
+  m_pTimer = new QTimer(this);
+  connect(m_pTimer, SIGNAL(timeout()), this, SLOT(flush()));
+  m_pTimer->start(Telemetry::FLUSH_INTERVAL);
+  this->openDay(QDate::currentDate());
+}
+
+// ---------------------------------------------------------------------------
+
+void TelemetryWriter::flush() {
+  QVector<Pending> listPending;
+  QStringList sListBoards;
+  {
+    QMutexLocker locker(&m_mutex);
+    listPending = m_listPending;
+    m_listPending.clear();
+    sListBoards = m_sListBoards;
+  }
+  if (listPending.isEmpty() && QDate::currentDate() != m_currentDay) {
+    this->openDay(QDate::currentDate());  // Compresses yesterday
+  }
+
+  // Records are in time order, one chunk per day
+  int nStart(0);
+  while (nStart < listPending.size()) {
+    const QDate day(QDateTime::fromMSecsSinceEpoch(
+                      listPending.at(nStart).nMsecs).date());
+    if (day != m_currentDay) {
+      this->openDay(day);
+    }
+
+    // Board names are written with each chunk
+    QVector<Telemetry::Record> listRecords;
+    QStringList sListChunkBoards;
+    QHash<int, quint16> hashChunkBoards;  // m_sListBoards -> chunk index
+    for (int i = nStart; i < listPending.size(); i++) {
+      const Pending &pending(listPending.at(i));
+      const QDateTime time(QDateTime::fromMSecsSinceEpoch(pending.nMsecs));
+      if (time.date() != day) {
+        break;
+      }
+      if (!hashChunkBoards.contains(pending.nBoard)) {
+        hashChunkBoards[pending.nBoard] = sListChunkBoards.size();
+        sListChunkBoards << sListBoards.at(pending.nBoard);
+      }
+
+      Telemetry::Record record;
+      record.nTime = time.time().msecsSinceStartOfDay();
+      record.nGameSeconds = pending.nGameSeconds;
+      record.nBoard = hashChunkBoards.value(pending.nBoard);
+      record.nX = pending.nX;
+      record.nY = pending.nY;
+      record.nEvent = pending.nEvent;
+      record.nPiece = pending.nPiece;
+      listRecords << record;
+    }
+
+    QByteArray payload;
+    QDataStream chunk(&payload, QIODevice::WriteOnly);
+    chunk << quint16(sListChunkBoards.size());
+    foreach (const QString &sBoard, sListChunkBoards) {
+      chunk << sBoard.toUtf8();
+    }
+    chunk << quint32(listRecords.size());
+    foreach (const Telemetry::Record &r, listRecords) chunk << r.nTime;
+    foreach (const Telemetry::Record &r, listRecords) chunk << r.nGameSeconds;
+    foreach (const Telemetry::Record &r, listRecords) chunk << r.nBoard;
+    foreach (const Telemetry::Record &r, listRecords) chunk << r.nX;
+    foreach (const Telemetry::Record &r, listRecords) chunk << r.nY;
+    foreach (const Telemetry::Record &r, listRecords) chunk << r.nEvent;
+    foreach (const Telemetry::Record &r, listRecords) chunk << r.nPiece;
+
+    // Another instance may write or compress the same day file
+    QLockFile lock(m_sFile + ".lock");
+    if (!lock.tryLock(Telemetry::FLUSH_INTERVAL)) {
+      qWarning() << "Telemetry: could not lock" << m_sFile;
+      QMutexLocker locker(&m_mutex);
+      m_listPending = listPending.mid(nStart) + m_listPending;
+      return;  // Next flush
+    }
+    nStart += listRecords.size();
+
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    if (!QFile::exists(m_sFile)) {
+      out.writeRawData(Telemetry::MAGIC, 4);
+      out << Telemetry::VERSION;
+    }
+    out << Telemetry::CHUNK_EVENTS << quint32(payload.size());
+    out.writeRawData(payload.constData(), payload.size());
+
+    QFile file(m_sFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append) ||
+        data.size() != file.write(data)) {
+      qWarning() << "Telemetry: could not write" << m_sFile;
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void TelemetryWriter::openDay(const QDate &day) {
+  m_currentDay = day;
+  m_sFile = m_sDir + "/" + day.toString("yyyy-MM-dd") + ".iqtl";
+  this->compressOldFiles();
+  this->removeExpiredFiles();
+}
+
+// ---------------------------------------------------------------------------
+
+void TelemetryWriter::compressOldFiles() const {
+  QDir dir(m_sDir);
+  foreach (const QFileInfo &fi,
+           dir.entryInfoList(QStringList() << "*.iqtl", QDir::Files)) {
+    const QDate day(QDate::fromString(fi.completeBaseName(), "yyyy-MM-dd"));
+    if (!day.isValid() || day >= QDate::currentDate() ||
+        day == m_currentDay) {
+      continue;
+    }
+    QLockFile lock(fi.filePath() + ".lock");
+    if (!lock.tryLock(0)) {
+      continue;  // Written or compressed by another instance
+    }
+
+    QFile file(fi.filePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+      continue;
+    }
+    QByteArray data(file.readAll());
+    file.close();
+
+    QFile compressed(fi.filePath() + ".z");
+    if (compressed.exists()) {
+      // Chunks are self-contained, late ones are appended without header
+      if (!compressed.open(QIODevice::ReadOnly)) {
+        continue;
+      }
+      data = qUncompress(compressed.readAll()) + data.mid(5);
+      compressed.close();
+    }
+    const QString sTemp(compressed.fileName() + ".tmp");
+    QFile temp(sTemp);
+    const QByteArray zipped(qCompress(data, 9));
+    if (!temp.open(QIODevice::WriteOnly) ||
+        zipped.size() != temp.write(zipped)) {
+      qWarning() << "Telemetry: could not compress" << fi.filePath();
+      temp.remove();
+      continue;
+    }
+    temp.close();
+    QFile::remove(compressed.fileName());
+    if (QFile::rename(sTemp, compressed.fileName())) {
+      file.remove();
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+void TelemetryWriter::removeExpiredFiles() const {
+  const QDate firstDay(QDate::currentDate().addDays(-m_nKeepDays));
+  QDir dir(m_sDir);
+  foreach (const QFileInfo &fi,
+           dir.entryInfoList(QStringList() << "*.iqtl.z", QDir::Files)) {
+    const QDate day(QDate::fromString(fi.fileName().left(10), "yyyy-MM-dd"));
+    if (day.isValid() && day < firstDay) {
+      QLockFile lock(m_sDir + "/" + fi.fileName().left(10) + ".iqtl.lock");
+      if (lock.tryLock(0) && !QFile::remove(fi.filePath())) {
+        qWarning() << "Telemetry: could not remove" << fi.filePath();
+      }
+    }
+  }
+}
@@ -0,0 +1,167 @@
+/**
+ * \file telemetry.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for recording gameplay telemetry.
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <QDate>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QPoint>
+#include <QStringList>
+#include <QVector>
+
+class QThread;
+class QTimer;
+
+/**
+ * \class TelemetryWriter
+ * \brief Stores the records collected by Telemetry on its own thread.
+ */
+class TelemetryWriter : public QObject {
+  Q_OBJECT
+
+ public:
+    struct Pending {
+      qint64 nMsecs;  // Since epoch
+      quint32 nGameSeconds;
+      int nBoard;  // Index in m_sListBoards
+      qint16 nX;
+      qint16 nY;
+      quint8 nEvent;
+      quint8 nPiece;
+    };
+
+    TelemetryWriter(const QString &sDir, const int nKeepDays,
+                    QObject *pParent = 0);
+
+    void append(const QString &sBoard, const Pending &pending);
+
+ public slots:
+    void start();
+    void flush();
+
+ private:
+    void openDay(const QDate &day);
+    void compressOldFiles() const;
+    void removeExpiredFiles() const;
+
+    const QString m_sDir;
+    const int m_nKeepDays;
+    QTimer *m_pTimer;
+
+    // Shared with the recording thread
+    QMutex m_mutex;
+    QVector<Pending> m_listPending;
+    QStringList m_sListBoards;
+    QHash<QString, int> m_hashBoards;
+
+    // Writer thread only
+    QDate m_currentDay;
+    QString m_sFile;
+};
+
+// ---------------------------------------------------------------------------
+
+/**
+ * \class Telemetry
+ * \brief Records moves, rejections, rotations, hints and pauses per board.
+ *
+ * Meant for finding where players get stuck. record() only appends a
+ * fixed-width record to a buffer under a mutex. A TelemetryWriter on a
+ * background thread stores the buffer every FLUSH_INTERVAL msecs, so a
+ * move never waits for the disk.
+ *
+ * There is one file per day (yyyy-MM-dd.iqtl): "IQTL", quint8 version and
+ * chunks of quint8 type, quint32 size and payload.
+ * Events: quint16 board count m, m x QByteArray board name (UTF-8),
+ * quint32 count n, then one column after the other: n x quint32 time of
+ * day (msecs), n x quint32 game time (seconds), n x quint16 board (index
+ * in the names of the chunk), n x qint16 cell x, n x qint16 cell y,
+ * n x quint8 event and n x quint8 piece (1-based, 0 = none).
+ * Each chunk carries its board names, so chunks of several running
+ * instances can share a day file and be moved between files. Writing and
+ * compressing a day file hold a QLockFile (file name + ".lock").
+ * Files of past days are compressed (qCompress, suffix ".z") when the
+ * writer starts or the day changes, records arriving later go to the
+ * plain file again and are merged on the next start. Day files older
+ * than the given number of days are deleted. readDay() reads
+ * both files of a day in time order; the analysis tool is --telemetry.
+ */
+class Telemetry : public QObject {
+  Q_OBJECT
+
+ public:
+    enum Event {
+      EventStart = 1,
+      EventMove = 2,
+      EventRejected = 3,  // Dropped onto another piece, moved back
+      EventRotate = 4,
+      EventFlip = 5,
+      EventHint = 6,
+      EventPause = 7,
+      EventResume = 8,
+      EventSolved = 9
+    };
+
+    struct Record {
+      quint32 nTime;  // Msecs since midnight
+      quint32 nGameSeconds;
+      quint16 nBoard;  // Index in the board list of readDay()
+      qint16 nX;
+      qint16 nY;
+      quint8 nEvent;
+      quint8 nPiece;
+    };
+
+    Telemetry(const QString &sDir, const int nKeepDays,
+              QObject *pParent = 0);
+    ~Telemetry();
+
+    void record(const QString &sBoard, const Event event, const int nPiece,
+                const QPoint &cell, const quint32 nGameSeconds);
+
+    static bool readDay(const QString &sDir, const QDate &day,
+                        QStringList *pListBoards,
+                        QVector<Record> *pListRecords);
+    static bool readFile(const QString &sFile, QStringList *pListBoards,
+                         QVector<Record> *pListRecords);
+    static QString eventName(const int nEvent);
+
+    static const char MAGIC[4];
+    static const quint8 VERSION;
+    static const quint8 CHUNK_EVENTS;
+    static const int FLUSH_INTERVAL;
+
+ private:
+    static bool earlierThan(const Record &r1, const Record &r2);
+
+    QThread *m_pThread;
+    TelemetryWriter *m_pWriter;
+};
+
+#endif  // TELEMETRY_H_
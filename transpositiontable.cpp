@@ -0,0 +1,90 @@
+/**
+ * \file transpositiontable.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Transposition table of the solver.
+ */
+
+#include "./transpositiontable.h"
+
+TranspositionTable::TranspositionTable(const int nMegabytes)
+  : m_pSlots(NULL),
+    m_nMask(0) {
+  // Largest power of two number of entries (16 bytes) within the limit
+  const quint64 nMaxEntries((quint64(qMax(nMegabytes, 1)) << 20) / 16);
+  quint64 nEntries(1);
+  while (nEntries * 2 <= nMaxEntries) {
+    nEntries *= 2;
+  }
+  m_nMask = nEntries - 1;
+  m_pSlots = new QAtomicInteger<quint64>[nEntries * 2];
+}
+
+TranspositionTable::~TranspositionTable() {
+  delete [] m_pSlots;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool TranspositionTable::lookup(const quint64 nKey, quint64 *pCount) const {
+  if (0 == nKey) {
+    return false;  // Empty slots decode to key 0
+  }
+  const quint64 nSlot((nKey & m_nMask) * 2);
+  const quint64 nCount(m_pSlots[nSlot + 1].loadAcquire());
+  if ((m_pSlots[nSlot].loadAcquire() ^ nCount) != nKey) {
+    return false;
+  }
+  *pCount = nCount;
+  return true;
+}
+
+void TranspositionTable::store(const quint64 nKey, const quint64 nCount) {
+  const quint64 nSlot((nKey & m_nMask) * 2);
+  m_pSlots[nSlot + 1].storeRelease(nCount);
+  m_pSlots[nSlot].storeRelease(nKey ^ nCount);
+}
+
+int TranspositionTable::getSize() const {
+  return int(((m_nMask + 1) * 16) >> 20);
+}
+
+// ---------------------------------------------------------------------------
+
+quint64 TranspositionTable::columnKey(const int nColumn) {
+  // Fixed pseudo random number per column (splitmix64)
+  quint64 z(quint64(nColumn + 1) * Q_UINT64_C(0x9E3779B97F4A7C15));
+  z = (z ^ (z >> 30)) * Q_UINT64_C(0xBF58476D1CE4E5B9);
+  z = (z ^ (z >> 27)) * Q_UINT64_C(0x94D049BB133111EB);
+  return z ^ (z >> 31);
+}
+
+quint64 TranspositionTable::matrixKey() {
+  // Different pseudo random number for each matrix of the process
+  static QAtomicInteger<quint64> nMatrices(0);
+  quint64 z((nMatrices.fetchAndAddRelaxed(1) + 1) *
+            Q_UINT64_C(0xD1B54A32D192ED03));
+  z = (z ^ (z >> 30)) * Q_UINT64_C(0xBF58476D1CE4E5B9);
+  z = (z ^ (z >> 27)) * Q_UINT64_C(0x94D049BB133111EB);
+  return z ^ (z >> 31);
+}
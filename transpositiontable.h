@@ -0,0 +1,63 @@
+/**
+ * \file transpositiontable.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the transposition table of the solver.
+ */
+
+#ifndef TRANSPOSITIONTABLE_H_
+#define TRANSPOSITIONTABLE_H_
+
+#include <QAtomicInteger>
+
+/**
+ * \class TranspositionTable
+ * \brief Bounded, lock-free cache of solution counts per subproblem.
+ *
+ * A subproblem is identified by a 64 bit key (Zobrist hash of the
+ * covered columns, i.e. free cells and remaining pieces). Each slot holds
+ * the key XOR the count and the count in two atomic words. A slot torn by
+ * concurrent writers doesn't decode to its key and is a miss, so all
+ * threads share the table without locks. Newer entries replace older.
+ * Keys of each matrix start at matrixKey(), so matrices of different
+ * boards can share one table as well.
+ */
+class TranspositionTable {
+ public:
+    explicit TranspositionTable(const int nMegabytes);
+    ~TranspositionTable();
+
+    bool lookup(const quint64 nKey, quint64 *pCount) const;
+    void store(const quint64 nKey, const quint64 nCount);
+    int getSize() const;
+
+    static quint64 columnKey(const int nColumn);
+    static quint64 matrixKey();
+
+ private:
+    Q_DISABLE_COPY(TranspositionTable)
+
+    QAtomicInteger<quint64> *m_pSlots;  // Two words per entry
+    quint64 m_nMask;  // Entries - 1
+};
+
+#endif  // TRANSPOSITIONTABLE_H_
@@ -0,0 +1,291 @@
+/**
+ * \file zdd.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Zero-suppressed decision diagram.
+ */
+
+#include "./zdd.h"
+
+#include <QDataStream>
+#include <QMap>
+
+static const quint32 ZDD_MAGIC = 0x49515A44;  // "IQZD"
+static const quint32 ZDD_VERSION = 1;
+
+Zdd::Zdd(const QVector<int> &listLevels)
+  : m_listLevels(listLevels),
+    m_nRoot(EMPTY) {
+  for (int i = EMPTY; i <= BASE; i++) {
+    Node node;
+    node.nVar = -1;
+    node.nLo = i;
+    node.nHi = i;
+    m_Nodes << node;
+    m_nCount << quint64(i);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+int Zdd::addNode(const int nVar, const int nLo, const int nHi) {
+  if (EMPTY == nHi) {  // Zero suppression: variable never in a set
+    return nLo;
+  }
+  const QPair<int, quint64> key(nVar,
+                                (quint64(nLo) << 32) | quint32(nHi));
+  const int nExisting(m_hashUnique.value(key, -1));
+  if (nExisting >= 0) {
+    return nExisting;
+  }
+
+  Node node;
+  node.nVar = nVar;
+  node.nLo = nLo;
+  node.nHi = nHi;
+  m_Nodes << node;
+  m_nCount << m_nCount.at(nLo) + m_nCount.at(nHi);
+  m_hashUnique.insert(key, m_Nodes.size() - 1);
+  return m_Nodes.size() - 1;
+}
+
+void Zdd::setRoot(const int nNode) {
+  m_nRoot = (nNode >= 0 && nNode < m_Nodes.size()) ? nNode : int(EMPTY);
+}
+
+int Zdd::getNumOfNodes() const {
+  return m_Nodes.size();
+}
+
+int Zdd::level(const int nVar) const {
+  return m_listLevels.isEmpty() ? nVar : m_listLevels.at(nVar);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+quint64 Zdd::count() const {
+  return m_nCount.at(m_nRoot);
+}
+
+quint64 Zdd::countWith(const QList<int> &listVars) const {
+  QList<int> listSorted;
+  if (!this->sortVars(listVars, &listSorted)) {
+    return 0;
+  }
+  CountMemo memo;
+  return this->countFrom(m_nRoot, 0, listSorted, &memo);
+}
+
+bool Zdd::sortVars(const QList<int> &listVars,
+                   QList<int> *pListSorted) const {
+  // Required variables in the order they appear along a path
+  pListSorted->clear();
+  QMap<int, int> mapLevels;
+  foreach (int nVar, listVars) {
+    if (nVar < 0 || (!m_listLevels.isEmpty() &&
+                     nVar >= m_listLevels.size())) {
+      return false;
+    }
+    mapLevels.insert(this->level(nVar), nVar);
+  }
+  *pListSorted = mapLevels.values();
+  return true;
+}
+
+quint64 Zdd::countFrom(const int nNode, const int nNext,
+                       const QList<int> &listSorted,
+                       CountMemo *pMemo) const {
+  if (nNext >= listSorted.size()) {
+    return m_nCount.at(nNode);
+  }
+  if (nNode <= BASE) {
+    return 0;  // Required variable missing
+  }
+  const Node &node = m_Nodes.at(nNode);
+  const int nWanted(listSorted.at(nNext));
+  if (this->level(node.nVar) > this->level(nWanted)) {
+    return 0;  // Below the level of the required variable
+  }
+
+  const QPair<int, int> key(nNode, nNext);
+  CountMemo::const_iterator it = pMemo->constFind(key);
+  if (it != pMemo->constEnd()) {
+    return it.value();
+  }
+  quint64 nCount(0);
+  if (node.nVar == nWanted) {
+    nCount = this->countFrom(node.nHi, nNext + 1, listSorted, pMemo);
+  } else {
+    nCount = this->countFrom(node.nLo, nNext, listSorted, pMemo) +
+             this->countFrom(node.nHi, nNext, listSorted, pMemo);
+  }
+  pMemo->insert(key, nCount);
+  return nCount;
+}
+
+// ---------------------------------------------------------------------------
+
+bool Zdd::findWith(const QList<int> &listVars, QList<int> *pListSet) const {
+  pListSet->clear();
+  QList<int> listSorted;
+  CountMemo memo;
+  if (!this->sortVars(listVars, &listSorted) ||
+      0 == this->countFrom(m_nRoot, 0, listSorted, &memo)) {
+    return false;
+  }
+
+  // Each step keeps at least one matching set below the current node
+  int nNode(m_nRoot);
+  int nNext(0);
+  while (nNode > BASE) {
+    const Node &node = m_Nodes.at(nNode);
+    if (nNext < listSorted.size() && node.nVar == listSorted.at(nNext)) {
+      nNext++;
+      pListSet->append(node.nVar);
+      nNode = node.nHi;
+    } else if (this->countFrom(node.nHi, nNext, listSorted, &memo) > 0) {
+      pListSet->append(node.nVar);
+      nNode = node.nHi;
+    } else {
+      nNode = node.nLo;
+    }
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+
+QList<int> Zdd::getSet(quint64 nIndex) const {
+  // Sets of the lo child come first
+  QList<int> listSet;
+  if (nIndex >= this->count()) {
+    return listSet;
+  }
+  int nNode(m_nRoot);
+  while (nNode > BASE) {
+    const Node &node = m_Nodes.at(nNode);
+    if (nIndex < m_nCount.at(node.nLo)) {
+      nNode = node.nLo;
+    } else {
+      nIndex -= m_nCount.at(node.nLo);
+      listSet << node.nVar;
+      nNode = node.nHi;
+    }
+  }
+  return listSet;
+}
+
+QList<int> Zdd::sample() const {
+  // Uniform: random index below count() by rejection, qrand() has 15 bits
+  const quint64 nCount(this->count());
+  if (0 == nCount) {
+    return QList<int>();
+  }
+  quint64 nMask(0);
+  while (nMask < nCount - 1) {
+    nMask = (nMask << 1) | 1;
+  }
+  quint64 nIndex(0);
+  do {
+    nIndex = 0;
+    for (int nBits = 0; nBits < 64; nBits += 15) {
+      nIndex = (nIndex << 15) ^ quint64(qrand() & 0x7FFF);
+    }
+    nIndex &= nMask;
+  } while (nIndex >= nCount);
+  return this->getSet(nIndex);
+}
+
+// ---------------------------------------------------------------------------
+
+QVector<quint64> Zdd::frequencies() const {
+  // Number of sets containing each variable: paths from root times sets below
+  int nVars(m_listLevels.size());
+  for (int n = BASE + 1; n <= m_nRoot; n++) {
+    nVars = qMax(nVars, m_Nodes.at(n).nVar + 1);
+  }
+  QVector<quint64> listFreq(nVars, 0);
+  QVector<quint64> listPaths(m_nRoot + 1, 0);
+  listPaths[m_nRoot] = 1;
+  for (int n = m_nRoot; n > BASE; n--) {
+    const Node &node = m_Nodes.at(n);
+    listPaths[node.nLo] += listPaths.at(n);
+    listPaths[node.nHi] += listPaths.at(n);
+    listFreq[node.nVar] += listPaths.at(n) * m_nCount.at(node.nHi);
+  }
+  return listFreq;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+QByteArray Zdd::serialize() const {
+  // Nodes up to the root only, terminals are implicit
+  QByteArray data;
+  QDataStream out(&data, QIODevice::WriteOnly);
+  out << ZDD_MAGIC << ZDD_VERSION << m_listLevels << qint32(m_nRoot);
+  for (int n = BASE + 1; n <= m_nRoot; n++) {
+    const Node &node = m_Nodes.at(n);
+    out << qint32(node.nVar) << qint32(node.nLo) << qint32(node.nHi);
+  }
+  return data;
+}
+
+bool Zdd::deserialize(const QByteArray &data) {
+  QDataStream in(data);
+  quint32 nMagic(0);
+  quint32 nVersion(0);
+  QVector<int> listLevels;
+  qint32 nRoot(0);
+  in >> nMagic >> nVersion >> listLevels >> nRoot;
+  if (QDataStream::Ok != in.status() || ZDD_MAGIC != nMagic ||
+      ZDD_VERSION != nVersion || nRoot < EMPTY) {
+    return false;
+  }
+
+  Zdd zdd(listLevels);
+  for (int n = BASE + 1; n <= nRoot; n++) {
+    qint32 nVar(0), nLo(0), nHi(0);
+    in >> nVar >> nLo >> nHi;
+    // Children first and no duplicates, so indices stay the same
+    if (QDataStream::Ok != in.status() || nVar < 0 ||
+        (!listLevels.isEmpty() && nVar >= listLevels.size()) ||
+        nLo < EMPTY || nLo >= n || nHi <= EMPTY || nHi >= n ||
+        zdd.addNode(nVar, nLo, nHi) != n) {
+      return false;
+    }
+    // Queries rely on ascending levels along each path
+    const int nLevel(zdd.level(nVar));
+    if ((nLo > BASE && zdd.level(zdd.m_Nodes.at(nLo).nVar) <= nLevel) ||
+        (nHi > BASE && zdd.level(zdd.m_Nodes.at(nHi).nVar) <= nLevel)) {
+      return false;
+    }
+  }
+  if (!in.atEnd()) {
+    return false;
+  }
+  zdd.setRoot(nRoot);
+  *this = zdd;
+  return true;
+}
@@ -0,0 +1,88 @@
+/**
+ * \file zdd.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2012-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of iQPuzzle.
+ *
+ * iQPuzzle is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * iQPuzzle is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with iQPuzzle.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for a zero-suppressed decision diagram.
+ */
+
+#ifndef ZDD_H_
+#define ZDD_H_
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QVector>
+
+/**
+ * \class Zdd
+ * \brief Family of sets (e.g. all solutions) as zero-suppressed diagram.
+ *
+ * Node n stands for the sets of its lo child plus the sets of its hi
+ * child, each extended by the variable of n. Equal nodes are shared and
+ * nodes with an empty hi child are never created. Children always have a
+ * smaller index than their parent, so counting works in a single pass.
+ * Along each path variables appear in ascending level (given per
+ * variable), which allows queries for sets containing given variables.
+ */
+class Zdd {
+ public:
+    static const int EMPTY = 0;  // Terminal: no set at all
+    static const int BASE = 1;  // Terminal: only the empty set
+
+    explicit Zdd(const QVector<int> &listLevels = QVector<int>());
+
+    int addNode(const int nVar, const int nLo, const int nHi);
+    void setRoot(const int nNode);
+    int getNumOfNodes() const;
+
+    quint64 count() const;
+    quint64 countWith(const QList<int> &listVars) const;
+    bool findWith(const QList<int> &listVars, QList<int> *pListSet) const;
+    QList<int> getSet(quint64 nIndex) const;
+    QList<int> sample() const;
+    QVector<quint64> frequencies() const;
+
+    QByteArray serialize() const;
+    bool deserialize(const QByteArray &data);
+
+ private:
+    struct Node {
+      int nVar;
+      int nLo;
+      int nHi;
+    };
+    typedef QHash<QPair<int, int>, quint64> CountMemo;  // Node, next var
+
+    int level(const int nVar) const;
+    bool sortVars(const QList<int> &listVars, QList<int> *pListSorted) const;
+    quint64 countFrom(const int nNode, const int nNext,
+                      const QList<int> &listSorted, CountMemo *pMemo) const;
+
+    QVector<int> m_listLevels;  // Per variable, identity if empty
+    QVector<Node> m_Nodes;
+    QVector<quint64> m_nCount;  // Sets per node
+    QHash<QPair<int, quint64>, int> m_hashUnique;  // (var, lo|hi) -> node
+    int m_nRoot;
+};
+
+#endif  // ZDD_H_